@@ -1,24 +1,26 @@
 #ifndef ADAPTER_ETHEREUM_H
 #define ADAPTER_ETHEREUM_H
 
-#include <curl/curl.h>
-
 #include <boost/log/trivial.hpp>
 #include <cstdint>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "adapter_interface/adapter_interface.h"
+#include "adapter_utils/http_transport.h"
 #include "config_ethereum.h"
+#include "head_monitor.h"
+#include "nonce_allocator.h"
+#include "receipt_poller.h"
 #include "storage/blockchainDB/adapter/utils/src/json.hpp"
 
-// interval in ms to check if block is mined
-#define MINING_CHECK_INTERVAL 200
 // define waiting time in seconds in config file
 #define WAITING_TIME_IN_SEC 1000
 // keys and values of smart contrat are 32 byte and represented as hex
@@ -26,6 +28,17 @@
 #define VALUE_SIZE 64
 
 #define ENCODED_BYTE_SIZE 16
+// maximal number of transactions that are sent at once before waiting for
+// them to be mined
+#define MAX_TRANSACTIONS_IN_FLIGHT 64
+// estimated gas of a chunk of putBatch must stay below this value, leaving a
+// margin to the gas limit of a transaction
+#define BATCH_GAS_LIMIT 6000000
+// estimated gas per row of putBatch: storage of the block number, the value
+// length and the key list entry, plus the calldata
+#define BATCH_GAS_PER_ROW 75000
+// estimated gas per 32 byte word of a value of putBatch
+#define BATCH_GAS_PER_VALUE_WORD 22000
 // size for buffer to get return after executing node command
 #define BUFFER_SIZE_EXEC 128
 
@@ -155,11 +168,117 @@ class EthereumAdapter : public BcAdapter {
    * @return Status code (0 on success, 1 on failure batch contains remaining
    * key-value pairs)
    */
-  auto put(std::map<const BYTES, const BYTES> &batch) -> int override;
-  auto put_batch(std::map<const BYTES, const BYTES> &batch) -> int;
+  auto put(std::map<const BYTES, const BYTES> &batch,
+           WRITE_CONTEXT *context = nullptr) -> int override;
+  /**
+   * @brief Put a batch of key-value pairs with calls of putBatch of the
+   * contract. The batch is split into chunks whose estimated gas fits into the
+   * gas limit of a transaction. Up to MAX_TRANSACTIONS_IN_FLIGHT chunks are
+   * sent at once before waiting for them to be mined.
+   *
+   * @param batch Batch including multiple key-value pairs; Succesfully inserted
+   * key-value pairs are removed from the batch
+   *
+   * @return Status code (0 on success, 1 on failure batch contains remaining
+   * key-value pairs)
+   */
+  auto put_batch(std::map<const BYTES, const BYTES> &batch,
+                 WRITE_CONTEXT *context = nullptr) -> int override;
+  /**
+   * @brief Put a batch of key-value pairs with calls of putIfAbsent of the
+   * contract. The batch is split into chunks like by put_batch. The contract
+   * emits a KeyExists event for every key that is already stored, the events
+   * are read from the receipts of all chunks, so the transactions are always
+   * waited for.
+   *
+   * @param batch Batch including multiple key-value pairs; pairs of chunks
+   * that were mined successfully are removed from the batch
+   * @param existing_keys Reference to store the keys that were already stored
+   *
+   * @return Status code (0 on success, 1 on failure batch contains remaining
+   * key-value pairs)
+   */
+  auto put_if_absent(std::map<const BYTES, const BYTES> &batch,
+                     std::vector<BYTES> &existing_keys) -> int override;
   auto get(const BYTES &key, BYTES &result) -> int override;
+  /**
+   * @brief Get the values of multiple keys with a single eth_call of getBatch
+   * of the contract
+   *
+   * @param keys Keys of the pairs
+   * @param results Reference to store the read pairs; keys that do not exist
+   * are not added
+   *
+   * @return Status code (0 on success, 1 on failure)
+   */
+  auto get_batch(const std::vector<BYTES> &keys,
+                 std::map<const BYTES, BYTES> &results) -> int override;
   auto get_all(std::map<const BYTES, BYTES> &results) -> int override;
-  auto remove(const BYTES &key) -> int override;
+  auto remove(const BYTES &key, WRITE_CONTEXT *context = nullptr)
+      -> int override;
+  /**
+   * @brief Remove multiple keys with calls of removeBatch of the contract,
+   * split into chunks like put_batch
+   *
+   * @param keys Keys of the pairs
+   *
+   * @return Status code (0 on success, 1 on failure)
+   */
+  auto remove_batch(const std::vector<BYTES> &keys,
+                    WRITE_CONTEXT *context = nullptr) -> int override;
+  /**
+   * @brief Apply puts and removes with calls of applyBatch of the contract,
+   * split into chunks like put_batch. The chunks keep the order of the
+   * operations.
+   *
+   * @param operations The operations
+   *
+   * @return Status code (0 on success, 1 on failure)
+   */
+  auto apply_batch(const std::vector<BATCH_OPERATION> &operations,
+                   WRITE_CONTEXT *context = nullptr) -> int override;
+  auto get_block_number(uint64_t &block_number) -> int override;
+  /**
+   * @brief Get the head of the head monitor of the node, if it is subscribed
+   * to new blocks
+   *
+   * @param block_number Reference to store the block number
+   *
+   * @return True if the monitor is subscribed and saw a block
+   */
+  auto get_live_block_number(uint64_t &block_number) -> bool override;
+  /**
+   * @brief Get the state of a transaction from its receipt
+   *
+   * @param transaction_id ID of the transaction
+   *
+   * @return Status code (0 if mined successfully, 1 if failed, 2 if there is
+   * no receipt yet)
+   */
+  auto get_transaction_status(const std::string &transaction_id)
+      -> int override;
+  /**
+   * @brief Get the states of transactions from their receipts, which are read
+   * with JSON-RPC batches
+   *
+   * @param transaction_ids IDs of the transactions
+   *
+   * @return Status code of every transaction, like get_transaction_status
+   */
+  auto get_transaction_statuses(const std::vector<std::string> &transaction_ids)
+      -> std::vector<int> override;
+  /**
+   * @brief Watch transactions with the receipt poller of the node
+   *
+   * @param transaction_ids IDs of the transactions
+   * @param timeout Time after which a transaction that is not mined is
+   * reported
+   * @param finished Called by the poller thread for every transaction
+   */
+  void watch_transactions(
+      const std::vector<std::string> &transaction_ids,
+      std::chrono::milliseconds timeout,
+      const std::function<void(const std::string &, int)> &finished) override;
 
   auto create_table(const std::string &name, std::string &tableAddress)
       -> int override;
@@ -171,11 +290,21 @@ class EthereumAdapter : public BcAdapter {
   std::string tableName_;
   std::string accountAddress_;
   std::string storedContractAddress_;
+  // the contract of the table was deployed before getBatch, removeBatch,
+  // applyBatch and putIfAbsent were added, their calls are replaced by the
+  // functions of the old contract
+  bool legacy_contract_ = false;
   EthereumConfig config_;
 
-  CURL *curl_;
+  // connections to the node, shared with the other adapters of the node
+  std::shared_ptr<HttpTransport> transport_;
+  // tracks the head of the chain for all adapters of the node
+  std::shared_ptr<HeadMonitor> monitor_;
+  // waits for the receipts of the transactions of all adapters of the node
+  std::shared_ptr<ReceiptPoller> poller_;
+  // nonces of the account, shared with the other adapters of the account
+  std::shared_ptr<NonceAllocator> nonces_;
   size_t max_waiting_time_;
-  std::atomic_uint64_t nonce_;
 
   /**
    * @brief Verify configuration path
@@ -192,11 +321,55 @@ class EthereumAdapter : public BcAdapter {
   static auto verify_connection_string(const std::string &connection_string) -> bool;
 
   /**
-   * @brief Update nonce for reading operations
+   * @brief Helper-Method to take consecutive nonces of the account
    *
-   * @return true if successfull otherwise false
+   * @param count Number of nonces
+   *
+   * @return The first nonce, 0 to let the node choose if no account is set
    */
-  auto update_nonce() -> bool;
+  auto reserve_nonces(uint64_t count) -> uint64_t;
+
+  /**
+   * @brief Helper-Method to read the nonces of the account from the node
+   * again after a transaction was rejected
+   */
+  void resync_nonces();
+
+  /**
+   * @brief Helper-Method to check whether the contract of the table has the
+   * batch functions, by calling getBatch without keys. A contract without
+   * them reverts the call.
+   *
+   * @return True if the contract was deployed before the batch functions were
+   * added; false if it has them or the node did not answer
+   */
+  auto probe_legacy_contract() -> bool;
+
+  /**
+   * @brief Helper-Method to read multiple keys from a legacy contract, with
+   * one get call per key. Its get reverts for a missing key, a key whose
+   * call fails is therefore not found either.
+   *
+   * @param keys Keys of the pairs
+   * @param results Reference to store the read pairs
+   *
+   * @return Status code (0 on success, 1 on failure)
+   */
+  auto legacy_get_batch(const std::vector<BYTES> &keys,
+                        std::map<const BYTES, BYTES> &results) -> int;
+
+  /**
+   * @brief Helper-Method to remove multiple keys from a legacy contract. Its
+   * remove reverts for a missing key, so only the stored keys are removed,
+   * with one transaction per key.
+   *
+   * @param keys Keys of the pairs
+   * @param context How to wait for the transactions
+   *
+   * @return Status code (0 on success, 1 on failure)
+   */
+  auto legacy_remove_batch(const std::vector<BYTES> &keys,
+                           WRITE_CONTEXT *context) -> int;
 
   /**
    * @brief Initialize adapter after config is set
@@ -229,29 +402,127 @@ class EthereumAdapter : public BcAdapter {
   auto call(std::string &params, std::string &method) -> std::string;
 
   /**
-   * @brief Helper-Method to periodically poll the blockchain to check if a
-   * transaction was mined. The poll interval is defined by
-   * MINING_CHECK_INTERVAL constant. It aborts if max-waiting-time is reached.
+   * @brief Helper-Method to post a RPC request to the blockchain without any
+   * further processing of the response
+   *
+   * @param params Json-formatted string containing parameters of the call
+   *
+   * @param method RPC-Method that is call on the blockchain
+   *
+   * @return Raw response of the blockchain
+   */
+  auto post(const std::string &params, const std::string &method)
+      -> std::string;
+
+  /**
+   * @brief Helper-Method to post RPC requests of the same method to the
+   * blockchain concurrently and to wait for all responses
    *
-   * @param transaction_ID The ID of the transaction that is being checked to
-   * see if it was mined
+   * @param params Json-formatted parameters of every request
    *
-   * @return Transaction response of the blockchain. If the transaction was
-   * mined it contains the block number and hash, otherwise block number and
-   * hash are null;
+   * @param method RPC-Method that is called on the blockchain
+   *
+   * @return Raw responses of the blockchain in the order of the requests,
+   * empty for requests that failed
+   */
+  auto post_all(const std::vector<std::string> &params,
+                const std::string &method) -> std::vector<std::string>;
+
+  /**
+   * @brief Helper-Method to send a transaction to the blockchain and to wait
+   * until it is mined
+   *
+   * @param params RpcParams struct containing parameters of the transaction
+   *
+   * @param[out] receipt Receipt of the mined transaction
+   *
+   * @return True if the transaction was successful, otherwise false
    */
-  auto check_mining_result(std::string &transaction_ID) -> std::string;
+  auto send_transaction(RpcParams params, nlohmann::json &receipt) -> bool;
 
   /**
-   * @brief Helper-Method to check the transation state after mining the
-   * transaction
+   * @brief Helper-Method to send a transaction to the blockchain without
+   * waiting until it is mined
    *
-   * @param transcation_ID The ID of the transaction whose state is to be
-   * checked
+   * @param params RpcParams struct containing parameters of the transaction,
+   * the nonce of the transaction is set
    *
-   * @return True if transaction was successful, otherwise false
-   *    */
-  auto check_transaction_receipt(std::string &transaction_ID) -> bool;
+   * @return The ID of the transaction, empty if it was not accepted
+   */
+  auto submit_transaction(RpcParams &params) -> std::string;
+
+  /**
+   * @brief Helper-Method to send transactions to the blockchain concurrently
+   * without waiting until they are mined. A transaction that is not accepted
+   * is sent once more; if it is still not accepted, its nonce is used by an
+   * empty transaction, so that the later transactions are not stuck.
+   *
+   * @param params RpcParams structs containing parameters of the
+   * transactions, their nonces are set in order
+   *
+   * @return The IDs of the transactions, empty if it was not accepted
+   */
+  auto submit_transactions(std::vector<RpcParams> &params)
+      -> std::vector<std::string>;
+
+  /**
+   * @brief Helper-Method to send transactions that call the contract. Up to
+   * MAX_TRANSACTIONS_IN_FLIGHT transactions are sent at once before waiting
+   * for them to be mined; without waiting for mining all are sent at once.
+   *
+   * @param calldata Call data of the transactions, in the order of their nonces
+   * @param context How to wait for the transactions of the calling write
+   * method, nullptr to wait until they are mined
+   * @param[out] receipts Receipts of the transactions in the order of the call
+   * data, null if a transaction was not mined. If set, the transactions are
+   * waited for in any case.
+   *
+   * @return For every transaction whether it was mined successfully, or
+   * accepted if not waiting for mining
+   */
+  auto send_transactions(const std::vector<std::string> &calldata,
+                         WRITE_CONTEXT *context,
+                         std::vector<nlohmann::json> *receipts = nullptr)
+      -> std::vector<bool>;
+
+  /**
+   * @brief Helper-Method to wait until a transaction is mined and to read its
+   * receipt. The receipt is read by the poller of the node, at most until
+   * max-waiting-time is reached.
+   *
+   * @param transaction_ID The ID of the transaction
+   *
+   * @param[out] receipt Receipt of the mined transaction
+   *
+   * @return True if the transaction was successful, otherwise false
+   */
+  auto wait_for_transaction(std::string &transaction_ID,
+                            nlohmann::json &receipt) -> bool;
+
+  /**
+   * @brief Helper-Method to wait until transactions are mined. The receipts
+   * are read by the poller of the node together with the ones of the other
+   * sessions, at most until max-waiting-time is reached.
+   *
+   * @param transaction_IDs The IDs of the transactions, empty IDs are skipped
+   * @param[out] mined_receipts Receipts of the transactions, null if a
+   * transaction was not mined
+   *
+   * @return For every transaction whether it was mined successfully
+   */
+  auto wait_for_transactions(const std::vector<std::string> &transaction_IDs,
+                             std::vector<nlohmann::json> *mined_receipts =
+                                 nullptr) -> std::vector<bool>;
+
+  /**
+   * @brief Helper-Method to check whether a write method waits until its
+   * transactions are mined
+   *
+   * @param context The context of the write method, may be nullptr
+   *
+   * @return True if the write method waits
+   */
+  static auto waits_for_mining(const WRITE_CONTEXT *context) -> bool;
 
   /**
    * @brief Helper-Method to parse a RpcParam struct to json
@@ -283,6 +554,42 @@ class EthereumAdapter : public BcAdapter {
    */
   static auto convert_to_32byte(const std::string &data) -> std::string;
 
+  /**
+   * @brief Helper-Method to split a batch into chunks whose estimated gas
+   * fits into the gas limit of a transaction
+   *
+   * @param batch Batch including multiple key-value pairs
+   *
+   * @return The chunks, at least one
+   */
+  static auto split_batch(const std::map<const BYTES, const BYTES> &batch)
+      -> std::vector<std::map<const BYTES, const BYTES>>;
+
+  /**
+   * @brief Helper-Method to ABI-encode a batch as the two arguments
+   * (bytes32[] keys, string[] values) of a contract method. Values are padded
+   * to a multiple of 32 bytes, so values of any length can be encoded.
+   *
+   * @param batch Batch including multiple key-value pairs
+   *
+   * @return Hex-encoded arguments without method hash
+   */
+  static auto encode_batch(const std::map<const BYTES, const BYTES> &batch)
+      -> std::string;
+
+  /**
+   * @brief Helper-Method to ABI-encode operations as the three arguments
+   * (bytes32[] keys, string[] values, bool[] removes) of applyBatch
+   *
+   * @param first Iterator to the first operation
+   * @param last Iterator behind the last operation
+   *
+   * @return Hex-encoded arguments without method hash
+   */
+  static auto encode_operations(
+      std::vector<BATCH_OPERATION>::const_iterator first,
+      std::vector<BATCH_OPERATION>::const_iterator last) -> std::string;
+
   /**
    * @brief Helper-Method to split and parse concatenated hex-encoded response
    * from blockchain contract when doing a table scan. It extracts a key list
@@ -299,12 +606,6 @@ class EthereumAdapter : public BcAdapter {
   static auto split(const std::string &response, int split_length = VALUE_SIZE)
       -> std::map<const BYTES, BYTES>;
 
-  /**
-   * @brief Callback function for curl
-   */
-  static auto write_callback(char *contents, size_t size, size_t nmemb,
-                             void *userp) -> size_t;
-
   /**
    * @brief Helper-Method to do a RPC call to the blockchain for batch
    * processing
@@ -334,10 +635,13 @@ class EthereumAdapter : public BcAdapter {
    * parameters of the call and the original key that is associated with these
    * parameters
    *
+   * @param context How to wait for the transactions, nullptr to wait until
+   * they are mined
+   *
    * @return Vector that contains the keys where processing failed
    */
   auto sendRpcBatch(std::map<std::string, std::string> batch,
-                    std::map<std::string, std::string> key_map)
-      -> std::vector<std::string>;
+                    std::map<std::string, std::string> key_map,
+                    WRITE_CONTEXT *context) -> std::vector<std::string>;
 };
 #endif  // ADAPTER_ETHEREUM_H
@@ -6,6 +6,7 @@
 #include <boost/property_tree/json_parser.hpp>
 
 #include "adapter_interface/adapter_config.h"
+#include "adapter_utils/http_transport.h"
 //src/storage/blockchain/blockchain-adapter/interface/include/adapter_interface/adapter_interface.h
 #include "storage/blockchainDB/adapter/utils/src/json.hpp"
 #include "storage/blockchainDB/adapter/utils/include/general_helpers.h"
@@ -16,6 +17,9 @@
  */
 class EthereumConfig : public AdapterConfig {
  public:
+  // default maximum size of a JSON-RPC batch request in bytes
+  static constexpr size_t kDefaultRpcBatchSize = 1024 * 1024;
+
   /**
    * @brief Initialize the config bean by parsing the config file
    *
@@ -86,6 +90,44 @@ class EthereumConfig : public AdapterConfig {
     std::string connection_url = "http://" + join_ip + ":" + rpc_port;
     // set connection_url in adapter config
     config_.put("Adapter-Ethereum.connection-url", connection_url);
+
+    // get rpc-batch-size, optional
+    size_t rpc_batch_size = kDefaultRpcBatchSize;
+    if (connection_string_json.contains("rpc-batch-size")) {
+      const auto& value = connection_string_json["rpc-batch-size"];
+      rpc_batch_size = value.is_string() ? std::stoul(value.get<std::string>())
+                                         : value.get<size_t>();
+    }
+    BOOST_LOG_TRIVIAL(debug) << "set_network_config, rpc-batch-size = "
+                             << rpc_batch_size;
+    config_.put("Adapter-Ethereum.rpc-batch-size", rpc_batch_size);
+
+    // get rpc-connect-timeout and rpc-timeout in seconds, optional
+    HTTP_TIMEOUTS timeouts;
+    auto get_seconds = [&](const char* name, long& seconds) {
+      if (connection_string_json.contains(name)) {
+        const auto& value = connection_string_json[name];
+        seconds = value.is_string() ? std::stol(value.get<std::string>())
+                                    : value.get<long>();
+      }
+      BOOST_LOG_TRIVIAL(debug) << "set_network_config, " << name << " = "
+                               << seconds;
+      config_.put(std::string("Adapter-Ethereum.") + name, seconds);
+    };
+    get_seconds("rpc-connect-timeout", timeouts.connect);
+    get_seconds("rpc-timeout", timeouts.request);
+
+    // get ws-port, optional. Nodes like ganache serve WebSocket on the
+    // rpc-port, geth on a port of its own
+    std::string ws_port = rpc_port;
+    if (connection_string_json.contains("ws-port")) {
+      const auto& value = connection_string_json["ws-port"];
+      ws_port = value.is_string() ? value.get<std::string>()
+                                  : std::to_string(value.get<int>());
+    }
+    std::string ws_url = "ws://" + join_ip + ":" + ws_port;
+    BOOST_LOG_TRIVIAL(debug) << "set_network_config, ws-url = " << ws_url;
+    config_.put("Adapter-Ethereum.ws-url", ws_url);
     return true;
   }
 
@@ -107,6 +149,15 @@ class EthereumConfig : public AdapterConfig {
     return config_.get<std::string>("Adapter-Ethereum.connection-url");
   }
 
+  /**
+   * @brief The WebSocket URL of the node, used to subscribe to new blocks
+   *
+   * @return std::string, empty if it is not configured
+   */
+  auto ws_url() -> std::string {
+    return config_.get<std::string>("Adapter-Ethereum.ws-url", "");
+  }
+
   /**
    * @brief The address of (table) contract that the adapter will use for
    * reads/writes
@@ -137,6 +188,32 @@ class EthereumConfig : public AdapterConfig {
     return config_.get<int>("Adapter-Ethereum.max_waiting_time");
   }
 
+  /**
+   * @brief The maximum size in bytes of a JSON-RPC batch request, larger
+   * batches are split. 0 sends every call as a request of its own.
+   *
+   * @return size_t
+   */
+  auto rpc_batch_size() -> size_t {
+    return config_.get<size_t>("Adapter-Ethereum.rpc-batch-size",
+                               kDefaultRpcBatchSize);
+  }
+
+  /**
+   * @brief The timeouts of the requests to the node, a request that takes
+   * longer fails
+   *
+   * @return HTTP_TIMEOUTS
+   */
+  auto rpc_timeouts() -> HTTP_TIMEOUTS {
+    HTTP_TIMEOUTS timeouts;
+    timeouts.connect = config_.get<long>("Adapter-Ethereum.rpc-connect-timeout",
+                                         HTTP_TIMEOUTS::kDefaultConnect);
+    timeouts.request = config_.get<long>("Adapter-Ethereum.rpc-timeout",
+                                         HTTP_TIMEOUTS::kDefaultRequest);
+    return timeouts;
+  }
+
   /**
    * @brief Path to the folder containing the scripts to deploy contracts etc.
    *
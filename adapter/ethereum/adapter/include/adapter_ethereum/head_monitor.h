@@ -0,0 +1,179 @@
+#ifndef HEAD_MONITOR_H
+#define HEAD_MONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "adapter_utils/http_transport.h"
+#include "storage/blockchainDB/adapter/utils/src/json.hpp"
+
+/**
+ * @brief Struct that stores the head of the chain as seen by a HeadMonitor.
+ *
+ * @param number Number of the head block, 0 while it is unknown
+ * @param timestamp Timestamp of the head block in seconds since the epoch
+ * @param observed Time the block was seen
+ * @param live True if the head is pushed by a subscription, otherwise it is
+ * polled and may be a block behind
+ */
+struct CHAIN_HEAD {
+  uint64_t number = 0;
+  uint64_t timestamp = 0;
+  std::chrono::steady_clock::time_point observed;
+  bool live = false;
+};
+
+/**
+ * @brief Tracks the head of the chain of a node for all adapters connected to
+ * it. The monitor subscribes to newHeads over WebSocket, so new blocks are
+ * seen within milliseconds. If the node does not offer subscriptions, it polls
+ * the latest block at the time the next block is expected, estimated from the
+ * intervals of the blocks observed so far, and tries to subscribe again from
+ * time to time.
+ *
+ * The head is published without locks, readers never wait for the monitor.
+ * Listeners are called by the monitor thread for every new head.
+ *
+ */
+class HeadMonitor {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Listener = std::function<void(const CHAIN_HEAD &)>;
+
+  /**
+   * @brief Gets the monitor of the node of a transport, it is created if no
+   * adapter uses the node yet
+   *
+   * @param transport Transport to the node, used for polling
+   * @param ws_url WebSocket URL of the node, empty to always poll. The
+   * monitor keeps the URL of the adapter that created it
+   * @return The monitor
+   */
+  static auto get(const std::shared_ptr<HttpTransport> &transport,
+                  const std::string &ws_url) -> std::shared_ptr<HeadMonitor>;
+
+  HeadMonitor(std::shared_ptr<HttpTransport> transport, std::string ws_url);
+  ~HeadMonitor();
+
+  HeadMonitor(const HeadMonitor &) = delete;
+  auto operator=(const HeadMonitor &) -> HeadMonitor & = delete;
+
+  /**
+   * @brief Gets the current head, lock-free
+   *
+   * @return The head, its number is 0 while no block was seen
+   */
+  auto head() const -> CHAIN_HEAD;
+
+  /**
+   * @brief Registers a listener that is called by the monitor thread for
+   * every new head. It must not block.
+   *
+   * @param listener The listener
+   * @return Id of the listener
+   */
+  auto add_listener(Listener listener) -> size_t;
+
+  /**
+   * @brief Removes a listener, it is not called anymore when this returns
+   *
+   * @param id Id returned by add_listener
+   */
+  void remove_listener(size_t id);
+
+ private:
+  // Interval of blocks assumed until two blocks were polled
+  static constexpr std::chrono::milliseconds kInitialBlockInterval{200};
+  // Bounds of the estimated interval of blocks
+  static constexpr std::chrono::milliseconds kMinBlockInterval{50};
+  static constexpr std::chrono::milliseconds kMaxBlockInterval{15000};
+  // Bounds of the time between two polls
+  static constexpr std::chrono::milliseconds kMinPollInterval{100};
+  static constexpr std::chrono::milliseconds kMaxPollInterval{1000};
+  // Time between two attempts to subscribe while polling
+  static constexpr std::chrono::milliseconds kResubscribeInterval{30000};
+  // Time a WebSocket connection may take to be established
+  static constexpr long kConnectTimeoutMs = 5000;
+
+  /**
+   * @brief Loop of the monitor thread
+   */
+  void run();
+
+  /**
+   * @brief Subscribes to newHeads and publishes the heads until the
+   * subscription ends
+   *
+   * @return False if the node does not accept the subscription
+   */
+  auto subscribe() -> bool;
+
+  /**
+   * @brief Polls the latest block until it is time to subscribe again
+   */
+  void poll();
+
+  /**
+   * @brief Reads the latest block with the transport
+   *
+   * @return Header of the block, null if the request failed
+   */
+  auto latest_block() -> nlohmann::json;
+
+  /**
+   * @brief Publishes a block if it is a new head, or if it is the head and
+   * live changed
+   *
+   * @param block Block header, as pushed by newHeads or returned by
+   * eth_getBlockByNumber
+   * @param live Whether the head is pushed
+   * @return True if the block is a new head
+   */
+  auto publish(const nlohmann::json &block, bool live) -> bool;
+
+  /**
+   * @brief Publishes a head with the sequence lock
+   */
+  void store(const CHAIN_HEAD &head);
+
+  /**
+   * @brief Waits until a socket is readable or the monitor stops
+   *
+   * @param timeout Maximum time to wait
+   * @param socket The socket, -1 to only wait
+   * @return False if the monitor stops
+   */
+  auto wait(std::chrono::milliseconds timeout, int socket = -1) -> bool;
+
+  std::shared_ptr<HttpTransport> transport_;
+  std::string ws_url_;
+
+  // the head, written under a sequence lock by the monitor thread. The
+  // sequence is odd while the head is written.
+  std::atomic_uint64_t sequence_{0};
+  std::atomic_uint64_t number_{0};
+  std::atomic_uint64_t timestamp_{0};
+  std::atomic<Clock::rep> observed_{0};
+  std::atomic_bool live_{false};
+
+  std::mutex listener_mutex_;
+  std::map<size_t, Listener> listeners_;
+  size_t next_listener_ = 0;
+
+  // estimated interval of blocks, only used by the monitor thread
+  std::chrono::milliseconds block_interval_{kInitialBlockInterval};
+
+  // written to wake the monitor thread when it stops
+  int wakeup_pipe_[2] = {-1, -1};
+  std::atomic_bool stopping_{false};
+  std::thread thread_;
+};
+
+#endif  // HEAD_MONITOR_H
@@ -0,0 +1,36 @@
+#ifndef JSON_RPC_H
+#define JSON_RPC_H
+
+#include <string>
+#include <vector>
+
+#include "adapter_utils/http_transport.h"
+
+/**
+ * @brief Struct that stores a call of a JSON-RPC batch.
+ *
+ * @param method Name of the RPC method
+ * @param params Parameters of the call, without the enclosing brackets
+ */
+struct JSON_RPC_CALL {
+  std::string method;
+  std::string params;
+};
+
+/**
+ * @brief Sends calls to a node as JSON-RPC 2.0 batches of at most batch_size
+ * bytes, a single call is sent as plain request. The id of a call is its
+ * index, the responses are demultiplexed by their ids. The batches are sent
+ * concurrently.
+ *
+ * @param transport Transport to the node
+ * @param calls The calls
+ * @param batch_size Maximum size of a batch in bytes, 0 sends every call on
+ * its own
+ * @return For every call its response, empty if it failed
+ */
+auto post_json_rpc_batch(HttpTransport &transport,
+                         const std::vector<JSON_RPC_CALL> &calls,
+                         size_t batch_size) -> std::vector<std::string>;
+
+#endif  // JSON_RPC_H
@@ -0,0 +1,77 @@
+#ifndef NONCE_ALLOCATOR_H
+#define NONCE_ALLOCATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "adapter_utils/http_transport.h"
+
+/**
+ * @brief Hands out the nonces of an account to all adapters connected to a
+ * node. The adapters of the tables of a server send with the same account,
+ * concurrently as well, so every nonce must be taken from one counter.
+ *
+ * The counter starts at the number of transactions of the account including
+ * the pending ones, and is only read from the node again after the node
+ * rejected a transaction, e.g. because another client used the account.
+ *
+ */
+class NonceAllocator {
+ public:
+  /**
+   * @brief Gets the allocator of an account of the node of a transport, it is
+   * created if no adapter uses the account yet
+   *
+   * @param transport Transport to the node
+   * @param account Address of the account
+   * @return The allocator
+   */
+  static auto get(const std::shared_ptr<HttpTransport> &transport,
+                  const std::string &account)
+      -> std::shared_ptr<NonceAllocator>;
+
+  NonceAllocator(std::shared_ptr<HttpTransport> transport,
+                 std::string account);
+
+  NonceAllocator(const NonceAllocator &) = delete;
+  auto operator=(const NonceAllocator &) -> NonceAllocator & = delete;
+
+  /**
+   * @brief Takes consecutive nonces
+   *
+   * @param count Number of nonces
+   * @return The first nonce
+   */
+  auto reserve(uint64_t count) -> uint64_t;
+
+  /**
+   * @brief Reads the transaction count of the account again after the node
+   * rejected a transaction. The counter never moves back, since the nonces
+   * below it may belong to transactions that are still being sent.
+   */
+  void resync();
+
+ private:
+  /**
+   * @brief Reads the number of transactions of the account, including the
+   * pending ones
+   *
+   * @param[out] count The number of transactions
+   * @return True if the node returned the number
+   */
+  auto read_pending_count(uint64_t &count) -> bool;
+
+  std::shared_ptr<HttpTransport> transport_;
+  std::string account_;
+
+  // protects all members below
+  std::mutex mutex_;
+  // the counter was read from the node
+  bool synced_ = false;
+  // the next nonce that is handed out
+  uint64_t next_ = 0;
+};
+
+#endif  // NONCE_ALLOCATOR_H
@@ -0,0 +1,160 @@
+#ifndef RECEIPT_POLLER_H
+#define RECEIPT_POLLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "adapter_ethereum/head_monitor.h"
+#include "adapter_utils/http_transport.h"
+#include "storage/blockchainDB/adapter/utils/src/json.hpp"
+
+/**
+ * @brief Background poller that waits for the receipts of the transactions of
+ * all adapters connected to a node. Sessions register the hashes of their
+ * transactions and sleep until the poller found the receipts.
+ *
+ * Transactions that no session waits for can be watched instead, the poller
+ * calls a function when they are mined.
+ *
+ * Receipts only appear with new blocks, so the poller reads the receipts of
+ * all pending transactions in one JSON-RPC batch when the head monitor of the
+ * node sees a new block, and the receipts of new transactions right away.
+ * While no transaction is pending the poller sleeps.
+ *
+ */
+class ReceiptPoller {
+ public:
+  using Clock = std::chrono::steady_clock;
+  // called with the hash of a watched transaction and its receipt
+  using Watcher =
+      std::function<void(const std::string &, const nlohmann::json &)>;
+
+  /**
+   * @brief Gets the poller of the node of a transport, it is created if no
+   * adapter uses the node yet
+   *
+   * @param transport Transport to the node
+   * @param monitor Head monitor of the node
+   * @param batch_size Maximum size of a batch request in bytes, the poller
+   * keeps the size of the adapter that created it
+   * @return The poller
+   */
+  static auto get(const std::shared_ptr<HttpTransport> &transport,
+                  const std::shared_ptr<HeadMonitor> &monitor,
+                  size_t batch_size) -> std::shared_ptr<ReceiptPoller>;
+
+  ReceiptPoller(std::shared_ptr<HttpTransport> transport,
+                std::shared_ptr<HeadMonitor> monitor, size_t batch_size);
+  ~ReceiptPoller();
+
+  ReceiptPoller(const ReceiptPoller &) = delete;
+  auto operator=(const ReceiptPoller &) -> ReceiptPoller & = delete;
+
+  /**
+   * @brief Waits until transactions are mined
+   *
+   * @param transaction_IDs Hashes of the transactions, empty ones are skipped
+   * @param timeout Maximum time to wait
+   * @return For every transaction its receipt, null if it was not mined in
+   * time
+   */
+  auto wait(const std::vector<std::string> &transaction_IDs,
+            std::chrono::milliseconds timeout) -> std::vector<nlohmann::json>;
+
+  /**
+   * @brief Watches transactions without waiting for them
+   *
+   * @param transaction_IDs Hashes of the transactions, empty ones are skipped
+   * @param timeout Maximum time to watch them
+   * @param finished Called by the poller thread once per transaction with its
+   * receipt, null if it was not mined in time or the poller was stopped
+   */
+  void watch(const std::vector<std::string> &transaction_IDs,
+             std::chrono::milliseconds timeout, const Watcher &finished);
+
+ private:
+  // Minimum time between two ticks
+  static constexpr std::chrono::milliseconds kMinTick{50};
+  // Time after which the receipts are read again without a new block, in
+  // case the monitor missed one
+  static constexpr std::chrono::milliseconds kRecheckInterval{2000};
+  // Time after which the receipts are read again when the node failed
+  static constexpr std::chrono::milliseconds kRetryInterval{1000};
+
+  /**
+   * @brief Struct that stores a transaction that sessions wait for.
+   *
+   * @param receipt The receipt, null while the transaction is not mined
+   * @param waiters Number of sessions that wait for the transaction
+   * @param checked Whether the receipt was read since the last new head
+   * @param watchers Functions to call when the transaction is mined, with
+   * the time until which they watch it
+   */
+  struct ENTRY {
+    nlohmann::json receipt;
+    size_t waiters = 0;
+    bool checked = false;
+    std::vector<std::pair<Clock::time_point, Watcher>> watchers;
+  };
+
+  // a watcher to call with the hash and receipt of its transaction
+  using WatcherCall =
+      std::pair<Watcher, std::pair<std::string, nlohmann::json>>;
+
+  /**
+   * @brief Loop of the poller thread
+   */
+  void run();
+
+  /**
+   * @brief Takes the watchers of mined transactions and the watchers whose
+   * time is up, entries that nobody waits for anymore are removed. Requires
+   * the lock.
+   *
+   * @param now Current time
+   * @param[out] next_deadline Earliest time until which a remaining watcher
+   * watches its transaction, unchanged if there is none
+   * @return The watchers to call
+   */
+  auto take_watchers(Clock::time_point now, Clock::time_point &next_deadline)
+      -> std::vector<WatcherCall>;
+
+  /**
+   * @brief Reads the receipts of transactions
+   *
+   * @param transaction_IDs The transactions
+   * @param[out] receipts Receipts of the transactions, null if not mined and
+   * discarded if the request failed
+   * @return True if any receipt could be read
+   */
+  auto poll(const std::vector<std::string> &transaction_IDs,
+            std::vector<nlohmann::json> &receipts) -> bool;
+
+  std::shared_ptr<HttpTransport> transport_;
+  std::shared_ptr<HeadMonitor> monitor_;
+  size_t batch_size_;
+  // id of the listener that is called by the monitor for new heads
+  size_t listener_;
+
+  // protects all members below
+  std::mutex mutex_;
+  // signaled when transactions are registered, a new head is seen or the
+  // poller stops
+  std::condition_variable work_;
+  // signaled when receipts were read
+  std::condition_variable mined_;
+  std::unordered_map<std::string, ENTRY> pending_;
+  bool new_head_ = false;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+#endif  // RECEIPT_POLLER_H
@@ -3,6 +3,8 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include "adapter_ethereum/json_rpc.h"
+#include "adapter_ethereum/nonce_allocator.h"
 #include "adapter_utils/encoding_helpers.h"
 #include "adapter_utils/shell_helpers.h"
 
@@ -18,8 +20,22 @@ constexpr static auto kEthereumMethodHashGet = "0x8eaa6ac0";
 constexpr static auto kEthereumMethodHashGetall = "0xb3055e26";
 // The hash of the remove method signature of BlockchainDB ethereum contract
 constexpr static auto kEthereumMethodHashRemove = "0x95bc2673";
+// The hash of the removeBatch method signature of BlockchainDB ethereum
+// contract
+constexpr static auto kEthereumMethodHashRemoveBatch = "0x2d9bb756";
+// The hash of the applyBatch method signature of BlockchainDB ethereum
+// contract
+constexpr static auto kEthereumMethodHashApplyBatch = "0xcab9adae";
 // The hash of the putBatch method signature of BlockchainDB ethereum contract
 constexpr static auto kEthereumMethodHashPutBatch = "0x410f08ab";
+// The hash of the putIfAbsent method signature of BlockchainDB ethereum
+// contract
+constexpr static auto kEthereumMethodHashPutIfAbsent = "0x9d87c98d";
+// The hash of the getBatch method signature of BlockchainDB ethereum contract
+constexpr static auto kEthereumMethodHashGetBatch = "0x50a5fd68";
+// The hash of the KeyExists event signature of BlockchainDB ethereum contract
+constexpr static auto kEthereumEventHashKeyExists =
+    "0xd042aa2fccdd29cbe811ddf17cd1f6b4edc42c9ebc3fa825ff81a64428dbff7d";
 // The default gas value of 7000000 for transaction in hex
 constexpr static auto kEthereumGas = "0x6ACFC0";
 
@@ -27,7 +43,7 @@ constexpr static auto kEthereumGas = "0x6ACFC0";
 EthereumAdapter::EthereumAdapter() = default;
 
 // Destructur
-EthereumAdapter::~EthereumAdapter() = default;
+EthereumAdapter::~EthereumAdapter() { shutdown(); }
 
 auto EthereumAdapter::init(const std::string &config_path) -> bool {
   // init Ethereum config
@@ -82,86 +98,173 @@ auto EthereumAdapter::init(const std::string &mysql_data_dir,
 auto EthereumAdapter::check_connection() -> bool {
   // get connection-url
   std::string connection_url = config_.connection_url();
-  // connection_url = "http://" + join-ip:rpc-port
-  boost::replace_all(connection_url, "http://", "");
   BOOST_LOG_TRIVIAL(debug)
       << "EthereumAdapter: check_connection | connection-url = "
       << connection_url;
 
-  // check bc-network availability
-  std::string cmd_to_execute = "curl --data '{\"method\":\"eth_blockNumber\","
-      "\"params\":[],\"id\":1,\"jsonrpc\":\"2.0\"}'"
-      " -H \"Content-Type: application/json\" -X POST ";
-  cmd_to_execute.append(connection_url);
-  BOOST_LOG_TRIVIAL(debug)
-      << "EthereumAdapter: check_connection | cmd_to_execute = "
-      << cmd_to_execute;
-
-  bool check_connection_successful;
-  std::string exec_output = exec(cmd_to_execute.c_str(),
-                                 &check_connection_successful);
-
-  if (!check_connection_successful) {
+  // check bc-network availability, with a pooled connection of the node
+  std::shared_ptr<HttpTransport> transport = std::atomic_load(&transport_);
+  if (transport == nullptr || transport->url() != connection_url ||
+      !(transport->timeouts() == config_.rpc_timeouts())) {
+    transport = HttpTransport::get(connection_url, config_.rpc_timeouts());
+  }
+  std::string response;
+  if (!transport->post(R"({"method":"eth_blockNumber","params":[],"id":1,)"
+                       R"("jsonrpc":"2.0"})",
+                       response)) {
     BOOST_LOG_TRIVIAL(debug)
         << "EthereumAdapter: check_connection | bc-network in NOT available";
     return false;
   }
 
   BOOST_LOG_TRIVIAL(debug)
-      << "EthereumAdapter: check_connection | exec_output = "
-      << exec_output;
+      << "EthereumAdapter: check_connection | response = " << response;
   return true;
 }
 
 auto EthereumAdapter::shutdown() -> bool {
-  curl_easy_cleanup(curl_);
+  std::atomic_store(&nonces_, std::shared_ptr<NonceAllocator>());
+  std::atomic_store(&poller_, std::shared_ptr<ReceiptPoller>());
+  std::atomic_store(&monitor_, std::shared_ptr<HeadMonitor>());
+  std::atomic_store(&transport_, std::shared_ptr<HttpTransport>());
   return true;
 }
 
-auto EthereumAdapter::put_batch(std::map<const BYTES, const BYTES> &batch) -> int {
-  // Init of variables
-  std::map<const BYTES, const BYTES>::iterator it;
-  int batch_id = 0;
-  std::string key_string;
-  std::string value_offset;
-  int value_offset_counter = 0;
-  std::string value_string;
+auto EthereumAdapter::put_batch(std::map<const BYTES, const BYTES> &batch,
+                                WRITE_CONTEXT *context) -> int {
+  if (batch.empty()) {
+    return 0;
+  }
 
-  // iterate over all pairs in the batch
-  for (it = batch.begin(); it != batch.end(); it++) {
+  // split the batch into chunks that fit into one transaction
+  std::vector<std::map<const BYTES, const BYTES>> chunks = split_batch(batch);
 
-    // construct the string that holds all keys
-    std::string padded_key = convert_to_32byte(byte_array_to_hex(it->first.value, it->first.size));
-    key_string.append(padded_key);
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Put_Batch, " << batch.size()
+                           << " pair(s) in " << chunks.size()
+                           << " transaction(s)";
 
-    // construct value offset string
-    std::string curr_offset = convert_to_32byte(int_to_hex(batch.size()*32+64*value_offset_counter));
-    value_offset.append(curr_offset);
-    value_offset_counter++;
+  // a chunk whose transaction fails stays in the batch
+  std::vector<std::string> calldata;
+  for (const auto &chunk : chunks) {
+    calldata.push_back(kEthereumMethodHashPutBatch + encode_batch(chunk));
+  }
+  std::vector<bool> results = send_transactions(calldata, context);
+  bool failed = false;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    if (!results[i]) {
+      failed = true;
+      continue;
+    }
+    for (const auto &it : chunks[i]) {
+      batch.erase(it.first);
+    }
+  }
 
-    // construct value string consisting of value length and the respective value
-    std::string val_len = int_to_hex(it->second.size);
-    value_string.append(convert_to_32byte(val_len));
-    value_string.append(convert_to_32byte(byte_array_to_hex(it->second.value, it->second.size)));
+  if (failed) {
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Put_Batch, Failed! "
+                             << batch.size() << " pair(s) remaining";
+    return 1;
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Put_Batch, Successful!";
+  return 0;
+}
+
+auto EthereumAdapter::put_if_absent(std::map<const BYTES, const BYTES> &batch,
+                                    std::vector<BYTES> &existing_keys) -> int {
+  if (batch.empty()) {
+    return 0;
+  }
+  if (legacy_contract_) {
+    // the keys are read before the absent ones are written, so a key that
+    // another writer inserts in between is overwritten
+    std::vector<BYTES> keys;
+    for (const auto &it : batch) {
+      keys.push_back(it.first);
+    }
+    std::map<const BYTES, BYTES> found;
+    if (legacy_get_batch(keys, found) != 0) {
+      return 1;
+    }
+    for (const auto &it : found) {
+      existing_keys.push_back(it.first);
+      batch.erase(it.first);
+    }
+    return put_batch(batch);
   }
-  update_nonce();
-  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Put, Nonce is " + std::to_string(nonce_.load());
-  RpcParams params;
-  params.method = "eth_sendTransaction";
-  params.transaction_ID = std::to_string(batch_id++);
 
-  std::string data = int_to_hex(VALUE_SIZE) + int_to_hex(batch.size()*32+96) + int_to_hex(batch.size()) + key_string +
-                     int_to_hex(batch.size()) + value_offset + value_string;
+  // split the batch into chunks that fit into one transaction, the existing
+  // keys are read from the receipts of all chunks
+  std::vector<std::map<const BYTES, const BYTES>> chunks = split_batch(batch);
 
-  params.data = kEthereumMethodHashPutBatch + data;
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Put_If_Absent, "
+                           << batch.size() << " pair(s) in " << chunks.size()
+                           << " transaction(s)";
 
-  // Make call to the blockchain to write all elements from the batch as one transaction
-  call(params, true);
+  std::vector<std::string> calldata;
+  for (const auto &chunk : chunks) {
+    calldata.push_back(kEthereumMethodHashPutIfAbsent + encode_batch(chunk));
+  }
+  std::vector<nlohmann::json> receipts;
+  std::vector<bool> results = send_transactions(calldata, nullptr, &receipts);
+
+  // keys are logged as padded bytes32, map them back to the keys of the batch
+  std::map<std::string, const BYTES *> padded_keys;
+  for (const auto &it : batch) {
+    padded_keys.emplace(
+        convert_to_32byte(byte_array_to_hex(it.first.value, it.first.size)),
+        &it.first);
+  }
+
+  // a chunk whose transaction fails stays in the batch
+  bool failed = false;
+  std::vector<BYTES> chunk_keys;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    if (!results[i]) {
+      failed = true;
+      continue;
+    }
+    try {
+      for (const auto &log : receipts[i].at("logs")) {
+        if (log.at("topics").empty() ||
+            log.at("topics")[0].get<std::string>() !=
+                kEthereumEventHashKeyExists) {
+          continue;
+        }
+        auto padded_key =
+            log.at("data").get<std::string>().substr(2, VALUE_SIZE);
+        auto key_it = padded_keys.find(padded_key);
+        if (key_it != padded_keys.end()) {
+          existing_keys.push_back(*key_it->second);
+        }
+      }
+    } catch (nlohmann::detail::exception &) {
+      BOOST_LOG_TRIVIAL(debug)
+          << "Ethereum Adapter: Put_If_Absent, Can not parse logs of "
+             "transaction receipt!";
+      failed = true;
+      continue;
+    }
+    for (const auto &it : chunks[i]) {
+      chunk_keys.push_back(it.first);
+    }
+  }
+  // the keys of the batch are referenced until all logs are read
+  for (const auto &key : chunk_keys) {
+    batch.erase(key);
+  }
 
+  if (failed) {
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Put_If_Absent, Failed! "
+                             << batch.size() << " pair(s) remaining";
+    return 1;
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Put_If_Absent, Successful! "
+                           << existing_keys.size() << " key(s) existed";
   return 0;
 }
 
-auto EthereumAdapter::put(std::map<const BYTES, const BYTES> &batch) -> int {
+auto EthereumAdapter::put(std::map<const BYTES, const BYTES> &batch,
+                          WRITE_CONTEXT *context) -> int {
   // check bc-network availability
   if (!check_connection()) {
     BOOST_LOG_TRIVIAL(debug)
@@ -177,11 +280,6 @@ auto EthereumAdapter::put(std::map<const BYTES, const BYTES> &batch) -> int {
 
   // iterate over all pairs in the map
   for (auto &it : batch) {
-    // update nonce
-    update_nonce();
-    BOOST_LOG_TRIVIAL(debug)
-        << "Ethereum Adapter: Put, Nonce is " + std::to_string(nonce_.load());
-
     std::string padded_key =
         convert_to_32byte(byte_array_to_hex(it.first.value, it.first.size));
     std::string offset = int_to_hex(VALUE_SIZE);
@@ -209,7 +307,7 @@ auto EthereumAdapter::put(std::map<const BYTES, const BYTES> &batch) -> int {
   const auto rpc_batch = createRpcBatch(batch_transform, key_map);
 
   const std::vector<std::string> response =
-      sendRpcBatch(rpc_batch.first, rpc_batch.second);
+      sendRpcBatch(rpc_batch.first, rpc_batch.second, context);
 
   // response contains the keys where the insertion failed
   // using this information, successfully inserted key-value pairs are removed
@@ -273,12 +371,83 @@ auto EthereumAdapter::get(const BYTES &key, BYTES &result) -> int {
   return 1;
 }
 
-auto EthereumAdapter::remove(const BYTES &key) -> int {
-  // update nonce
-  update_nonce();
-  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Remove, Nonce is " +
-                                  std::to_string(nonce_.load());
+auto EthereumAdapter::get_batch(const std::vector<BYTES> &keys,
+                                std::map<const BYTES, BYTES> &results) -> int {
+  if (keys.empty()) {
+    return 0;
+  }
+  if (legacy_contract_) {
+    return legacy_get_batch(keys, results);
+  }
+  const size_t word_size = VALUE_SIZE / 2;
+
+  // argument: offset of the array, length, keys
+  std::string key_string;
+  for (const auto &key : keys) {
+    key_string.append(
+        convert_to_32byte(byte_array_to_hex(key.value, key.size)));
+  }
+
+  RpcParams params;
+  params.method = "eth_call";
+  params.data = kEthereumMethodHashGetBatch + int_to_hex(word_size) +
+                int_to_hex(keys.size()) + key_string;
+  params.quantity_tag = "latest";
+
+  const std::string response = call(params, false);
+
+  std::string rpc_result;
+  try {
+    auto json = nlohmann::json::parse(response);
+    rpc_result = json.at("result").get<std::string>().substr(2);
+  } catch (std::exception &) {
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Get_Batch, Failed: "
+                             << response;
+    return 1;
+  }
+
+  // result: offset of found, offset of values, then the arrays. Offsets are
+  // in bytes, the offsets of the strings are relative to the first of them.
+  auto word = [&](size_t byte_offset) {
+    return static_cast<size_t>(
+        hex_to_int(rpc_result.substr(byte_offset * 2, VALUE_SIZE)));
+  };
+  try {
+    size_t found_offset = word(0);
+    size_t values_offset = word(word_size);
+    if (word(found_offset) != keys.size() ||
+        word(values_offset) != keys.size()) {
+      BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Get_Batch, Failed: "
+                                  "unexpected number of results";
+      return 1;
+    }
+    size_t strings_start = values_offset + word_size;
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (word(found_offset + (i + 1) * word_size) == 0) {
+        continue;
+      }
+      size_t string_offset = strings_start + word(strings_start + i * word_size);
+      size_t value_size = word(string_offset);
+      std::string value_hex =
+          rpc_result.substr((string_offset + word_size) * 2, value_size * 2);
+      std::vector<unsigned char> value(value_size);
+      hex_to_byte_array(value_hex, value.data());
+      results.emplace(keys[i], BYTES(value.data(), value_size));
+    }
+  } catch (std::exception &) {
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Get_Batch, Failed: Can not "
+                                "parse getBatch response!";
+    return 1;
+  }
 
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Get_Batch, Successful! "
+                           << results.size() << " of " << keys.size()
+                           << " key(s) found";
+  return 0;
+}
+
+auto EthereumAdapter::remove(const BYTES &key, WRITE_CONTEXT *context)
+    -> int {
   std::string padded_key =
       convert_to_32byte(byte_array_to_hex(key.value, key.size));
   RpcParams params;
@@ -286,6 +455,16 @@ auto EthereumAdapter::remove(const BYTES &key) -> int {
 
   params.data = kEthereumMethodHashRemove + padded_key;
 
+  if (!waits_for_mining(context)) {
+    std::string transaction_id = submit_transaction(params);
+    if (transaction_id.empty()) {
+      BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Remove, Failed!";
+      return 1;
+    }
+    context->pending_transactions.push_back({transaction_id, params.nonce});
+    return 0;
+  }
+
   const std::string response = call(params, true);
   // BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Remove, response: " <<
   // response;
@@ -301,6 +480,151 @@ auto EthereumAdapter::remove(const BYTES &key) -> int {
   return 1;
 }
 
+auto EthereumAdapter::remove_batch(const std::vector<BYTES> &keys,
+                                   WRITE_CONTEXT *context) -> int {
+  if (keys.empty()) {
+    return 0;
+  }
+  if (legacy_contract_) {
+    return legacy_remove_batch(keys, context);
+  }
+
+  // split the keys into chunks that fit into one transaction
+  std::vector<std::string> calldata;
+  size_t chunk_keys = BATCH_GAS_LIMIT / BATCH_GAS_PER_ROW;
+  for (size_t first = 0; first < keys.size(); first += chunk_keys) {
+    size_t last = std::min(keys.size(), first + chunk_keys);
+    std::string key_string;
+    for (size_t i = first; i < last; i++) {
+      key_string.append(
+          convert_to_32byte(byte_array_to_hex(keys[i].value, keys[i].size)));
+    }
+    // argument: offset of the array, length, keys
+    calldata.push_back(kEthereumMethodHashRemoveBatch +
+                       int_to_hex(VALUE_SIZE / 2) + int_to_hex(last - first) +
+                       key_string);
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Remove_Batch, " << keys.size()
+                           << " key(s) in " << calldata.size()
+                           << " transaction(s)";
+
+  for (bool result : send_transactions(calldata, context)) {
+    if (!result) {
+      BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Remove_Batch, Failed!";
+      return 1;
+    }
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Remove_Batch, Successful!";
+  return 0;
+}
+
+auto EthereumAdapter::apply_batch(
+    const std::vector<BATCH_OPERATION> &operations, WRITE_CONTEXT *context)
+    -> int {
+  if (operations.empty()) {
+    return 0;
+  }
+  if (legacy_contract_) {
+    // consecutive puts and consecutive removes are applied together, in the
+    // order of the operations
+    for (auto first = operations.begin(); first != operations.end();) {
+      auto last = first;
+      while (last != operations.end() && last->remove == first->remove) {
+        last++;
+      }
+      int rc;
+      if (first->remove) {
+        std::vector<BYTES> keys;
+        for (auto it = first; it != last; it++) {
+          keys.push_back(it->key);
+        }
+        rc = legacy_remove_batch(keys, context);
+      } else {
+        std::map<const BYTES, const BYTES> batch;
+        for (auto it = first; it != last; it++) {
+          batch.erase(it->key);
+          batch.emplace(it->key, it->value);
+        }
+        rc = put_batch(batch, context);
+      }
+      if (rc != 0) {
+        BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Apply_Batch, Failed!";
+        return 1;
+      }
+      first = last;
+    }
+    return 0;
+  }
+
+  // split the operations into chunks that fit into one transaction, the
+  // chunks keep the order of the operations
+  std::vector<std::string> calldata;
+  auto first = operations.begin();
+  size_t chunk_gas = 0;
+  for (auto it = operations.begin(); it != operations.end(); it++) {
+    size_t row_gas = BATCH_GAS_PER_ROW;
+    if (!it->remove) {
+      row_gas += (it->value.size + VALUE_SIZE / 2 - 1) / (VALUE_SIZE / 2) *
+                 BATCH_GAS_PER_VALUE_WORD;
+    }
+    if (it != first && chunk_gas + row_gas > BATCH_GAS_LIMIT) {
+      calldata.push_back(kEthereumMethodHashApplyBatch +
+                         encode_operations(first, it));
+      first = it;
+      chunk_gas = 0;
+    }
+    chunk_gas += row_gas;
+  }
+  calldata.push_back(kEthereumMethodHashApplyBatch +
+                     encode_operations(first, operations.end()));
+
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Apply_Batch, "
+                           << operations.size() << " operation(s) in "
+                           << calldata.size() << " transaction(s)";
+
+  for (bool result : send_transactions(calldata, context)) {
+    if (!result) {
+      BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Apply_Batch, Failed!";
+      return 1;
+    }
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Apply_Batch, Successful!";
+  return 0;
+}
+
+auto EthereumAdapter::get_live_block_number(uint64_t &block_number) -> bool {
+  // a pushed head is current, a polled one may be a block behind
+  std::shared_ptr<HeadMonitor> monitor = std::atomic_load(&monitor_);
+  if (monitor == nullptr) {
+    return false;
+  }
+  const CHAIN_HEAD head = monitor->head();
+  if (!head.live || head.number == 0) {
+    return false;
+  }
+  block_number = head.number;
+  return true;
+}
+
+auto EthereumAdapter::get_block_number(uint64_t &block_number) -> int {
+  std::string params;
+  std::string method = "eth_blockNumber";
+
+  const std::string response = call(params, method);
+
+  try {
+    auto json = nlohmann::json::parse(response);
+    auto hex_number = json["result"].get<std::string>().substr(2);  // remove 0x
+    block_number = strtoull(hex_number.c_str(), nullptr, ENCODED_BYTE_SIZE);
+  } catch (std::exception &) {
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Get_Block_Number, Failed: "
+                                "Can not parse eth_blockNumber response!";
+    return 1;
+  }
+  return 0;
+}
+
 auto EthereumAdapter::get_all(std::map<const BYTES, BYTES> &results) -> int {
   // check bc-network availability
   if (!check_connection()) {
@@ -337,6 +661,76 @@ auto EthereumAdapter::get_all(std::map<const BYTES, BYTES> &results) -> int {
   return 0;
 }
 
+auto EthereumAdapter::get_transaction_status(const std::string &transaction_id)
+    -> int {
+  std::string transaction_param = "\"" + transaction_id + "\"";
+  const std::string response =
+      post(transaction_param, "eth_getTransactionReceipt");
+
+  try {
+    auto receipt = nlohmann::json::parse(response).at("result");
+    if (receipt.is_null()) {
+      return 2;
+    }
+    return receipt.at("status").get<std::string>() == "0x1" ? 0 : 1;
+  } catch (nlohmann::detail::exception &) {
+    // the node may be unavailable, try again later
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Get_Transaction_Status, "
+                                "Can't parse response "
+                             << response;
+  }
+  return 2;
+}
+
+auto EthereumAdapter::get_transaction_statuses(
+    const std::vector<std::string> &transaction_ids) -> std::vector<int> {
+  std::vector<std::string> params;
+  params.reserve(transaction_ids.size());
+  for (const auto &transaction_id : transaction_ids) {
+    params.push_back("\"" + transaction_id + "\"");
+  }
+  const std::vector<std::string> responses =
+      post_all(params, "eth_getTransactionReceipt");
+
+  // a receipt that can not be read is not mined yet, it is asked for again
+  std::vector<int> statuses(transaction_ids.size(), 2);
+  for (size_t i = 0; i < responses.size(); i++) {
+    auto response = nlohmann::json::parse(responses[i], nullptr, false);
+    if (!response.is_object() || !response.contains("result") ||
+        !response["result"].is_object()) {
+      continue;
+    }
+    const auto &receipt = response["result"];
+    statuses[i] =
+        receipt.contains("status") && receipt["status"] == "0x1" ? 0 : 1;
+  }
+  return statuses;
+}
+
+void EthereumAdapter::watch_transactions(
+    const std::vector<std::string> &transaction_ids,
+    std::chrono::milliseconds timeout,
+    const std::function<void(const std::string &, int)> &finished) {
+  std::shared_ptr<ReceiptPoller> poller = std::atomic_load(&poller_);
+  if (poller == nullptr) {
+    for (const auto &transaction_id : transaction_ids) {
+      finished(transaction_id, 2);
+    }
+    return;
+  }
+  poller->watch(transaction_ids, timeout,
+                [finished](const std::string &transaction_id,
+                           const nlohmann::json &receipt) {
+                  if (!receipt.is_object()) {
+                    finished(transaction_id, 2);
+                    return;
+                  }
+                  bool ok = receipt.contains("status") &&
+                            receipt["status"] == "0x1";
+                  finished(transaction_id, ok ? 0 : 1);
+                });
+}
+
 auto EthereumAdapter::create_table(const std::string &name,
                                    std::string &tableAddress) -> int {
   if (name == tableName_) {
@@ -364,18 +758,12 @@ auto EthereumAdapter::create_table(const std::string &name,
   tableAddress = exec(cmd.c_str());
   storedContractAddress_ = tableAddress;
   tableName_ = name;
+  legacy_contract_ = false;
 
   BOOST_LOG_TRIVIAL(debug)
       << "Ethereum Adapter: Create_Table, Contract Address: "
       << storedContractAddress_ << " for table: " << tableName_;
 
-  // init nonce
-  if (nonce_ == 0) {
-    update_nonce();
-  }
-  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Create_Table, Nonce is " +
-                               std::to_string(nonce_.load());
-
   return 0;
 }
 
@@ -390,17 +778,13 @@ auto EthereumAdapter::load_table(const std::string &name,
   }
 
   tableName_ = name;
+  // tables that were created before the batch functions keep their contract
+  legacy_contract_ = probe_legacy_contract();
 
   BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Load_Table, Contract Address: "
                            << storedContractAddress_
-                           << " for table: " << tableName_;
-
-  // init nonce
-  if (nonce_ == 0) {
-    update_nonce();
-  }
-  BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Load_Table, Nonce is " +
-                                  std::to_string(nonce_.load());
+                           << " for table: " << tableName_
+                           << (legacy_contract_ ? " (legacy contract)" : "");
 
   return 0;
 }
@@ -408,9 +792,11 @@ auto EthereumAdapter::load_table(const std::string &name,
 auto EthereumAdapter::drop_table() -> int {
   std::map<const BYTES, BYTES> results;
   if (this->get_all(results) == 0) {
+    std::vector<BYTES> keys;
     for (auto &result : results) {
-      this->remove(result.first);
+      keys.push_back(result.first);
     }
+    this->remove_batch(keys);
   }
   BOOST_LOG_TRIVIAL(debug)
       << "Ethereum Adapter: Drop_Table, Not implemented correctly. "
@@ -460,35 +846,68 @@ auto EthereumAdapter::verify_connection_string(const std::string &connection_str
   return true;
 }
 
-auto EthereumAdapter::update_nonce() -> bool {
+auto EthereumAdapter::probe_legacy_contract() -> bool {
+  // getBatch with an empty array: offset of the array and its length
   RpcParams params;
-  params.method = "eth_getTransactionCount";
+  params.method = "eth_call";
+  params.data =
+      kEthereumMethodHashGetBatch + int_to_hex(VALUE_SIZE / 2) + int_to_hex(0);
   params.quantity_tag = "latest";
-  std::string param = "\"" + accountAddress_ + R"(", "latest")";
-  std::string method = "eth_getTransactionCount";
+  const std::string response = call(params, false);
 
-  auto response = call(param, method);
-  try {
-    auto json = nlohmann::json::parse(response);
-    auto hex_count = json["result"].get<std::string>().substr(2);  // remove 0x
-    auto tmp_nonce = strtoul(hex_count.c_str(), nullptr, ENCODED_BYTE_SIZE);
-    tmp_nonce = std::max((unsigned long)0, tmp_nonce - 1);  // nonce starts at 0
-    nonce_.store(tmp_nonce);
-  } catch (std::exception &) {
-    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Update Nonce, Failed: Can "
-                                "not parse eth_getTransactionCount response!";
+  auto json = nlohmann::json::parse(response, nullptr, false);
+  if (!json.is_object()) {
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Probe_Legacy_Contract, "
+                                "no response, the batch functions are used";
+    return false;
   }
-  return true;
+  // an old contract has no fallback function, the call reverts or returns
+  // no data
+  if (json.contains("error")) {
+    return true;
+  }
+  return !json.contains("result") || !json["result"].is_string() ||
+         json["result"].get<std::string>().size() <= 2;
+}
+
+auto EthereumAdapter::legacy_get_batch(const std::vector<BYTES> &keys,
+                                       std::map<const BYTES, BYTES> &results)
+    -> int {
+  // get reverts for a missing key, which is not an error here
+  for (const auto &key : keys) {
+    BYTES value;
+    if (get(key, value) == 0) {
+      results.emplace(key, value);
+    }
+  }
+  return 0;
+}
+
+auto EthereumAdapter::legacy_remove_batch(const std::vector<BYTES> &keys,
+                                          WRITE_CONTEXT *context) -> int {
+  std::map<const BYTES, BYTES> found;
+  legacy_get_batch(keys, found);
+  for (const auto &it : found) {
+    if (remove(it.first, context) != 0) {
+      BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Remove_Batch, Failed!";
+      return 1;
+    }
+  }
+  return 0;
 }
 
 auto EthereumAdapter::init() -> bool {
   this->max_waiting_time_ =
       config_.max_waiting_time() * WAITING_TIME_IN_SEC;  // convert to ms
 
-  curl_ = curl_easy_init();
-  curl_easy_setopt(curl_, CURLOPT_TCP_KEEPALIVE, 1L);
-  curl_easy_setopt(curl_, CURLOPT_URL, config_.connection_url().c_str());
-  curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, write_callback);
+  // adapters of the same node share its connections
+  std::atomic_store(&transport_, HttpTransport::get(config_.connection_url(),
+                                                    config_.rpc_timeouts()));
+  std::atomic_store(&monitor_, HeadMonitor::get(std::atomic_load(&transport_),
+                                                config_.ws_url()));
+  std::atomic_store(&poller_, ReceiptPoller::get(std::atomic_load(&transport_),
+                                                 std::atomic_load(&monitor_),
+                                                 config_.rpc_batch_size()));
 
   RpcParams params;
   params.method = "eth_accounts";
@@ -515,7 +934,10 @@ auto EthereumAdapter::init() -> bool {
       return false;
     }
 
-    nonce_ = 0;
+    // all adapters that send with the account share its nonces
+    std::atomic_store(&nonces_,
+                      NonceAllocator::get(std::atomic_load(&transport_),
+                                          accountAddress_));
 
     return true;
   }
@@ -531,6 +953,90 @@ auto EthereumAdapter::convert_to_32byte(const std::string &data)
   return ss.str().substr(0, VALUE_SIZE);
 }
 
+auto EthereumAdapter::split_batch(
+    const std::map<const BYTES, const BYTES> &batch)
+    -> std::vector<std::map<const BYTES, const BYTES>> {
+  std::vector<std::map<const BYTES, const BYTES>> chunks(1);
+  size_t chunk_gas = 0;
+  for (const auto &it : batch) {
+    size_t value_words = (it.second.size + VALUE_SIZE / 2 - 1) / (VALUE_SIZE / 2);
+    size_t row_gas = BATCH_GAS_PER_ROW + value_words * BATCH_GAS_PER_VALUE_WORD;
+    if (!chunks.back().empty() && chunk_gas + row_gas > BATCH_GAS_LIMIT) {
+      chunks.emplace_back();
+      chunk_gas = 0;
+    }
+    chunks.back().emplace(it.first, it.second);
+    chunk_gas += row_gas;
+  }
+  return chunks;
+}
+
+auto EthereumAdapter::encode_batch(
+    const std::map<const BYTES, const BYTES> &batch) -> std::string {
+  const size_t word_size = VALUE_SIZE / 2;
+  std::string key_string;
+  std::string value_offsets;
+  std::string value_string;
+  size_t value_offset = batch.size() * word_size;
+
+  for (const auto &it : batch) {
+    key_string.append(
+        convert_to_32byte(byte_array_to_hex(it.first.value, it.first.size)));
+
+    // offsets are relative to the first offset of the string array
+    value_offsets.append(int_to_hex(value_offset));
+
+    std::string value = byte_array_to_hex(it.second.value, it.second.size);
+    value.append((VALUE_SIZE - value.size() % VALUE_SIZE) % VALUE_SIZE, '0');
+    value_string.append(int_to_hex(it.second.size)).append(value);
+    value_offset += word_size + value.size() / 2;
+  }
+
+  // head: offset of keys, offset of values
+  return int_to_hex(2 * word_size) +
+         int_to_hex((3 + batch.size()) * word_size) +
+         int_to_hex(batch.size()) + key_string + int_to_hex(batch.size()) +
+         value_offsets + value_string;
+}
+
+auto EthereumAdapter::encode_operations(
+    std::vector<BATCH_OPERATION>::const_iterator first,
+    std::vector<BATCH_OPERATION>::const_iterator last) -> std::string {
+  const size_t word_size = VALUE_SIZE / 2;
+  const size_t count = std::distance(first, last);
+  std::string key_string;
+  std::string value_offsets;
+  std::string value_string;
+  std::string remove_string;
+  size_t value_offset = count * word_size;
+
+  for (auto it = first; it != last; it++) {
+    key_string.append(
+        convert_to_32byte(byte_array_to_hex(it->key.value, it->key.size)));
+
+    // offsets are relative to the first offset of the string array, removes
+    // have an empty value
+    value_offsets.append(int_to_hex(value_offset));
+    size_t value_size = it->remove ? 0 : it->value.size;
+    std::string value = byte_array_to_hex(it->value.value, value_size);
+    value.append((VALUE_SIZE - value.size() % VALUE_SIZE) % VALUE_SIZE, '0');
+    value_string.append(int_to_hex(value_size)).append(value);
+    value_offset += word_size + value.size() / 2;
+
+    remove_string.append(int_to_hex(it->remove ? 1 : 0));
+  }
+
+  // head: offset of keys, offset of values, offset of removes
+  size_t keys_offset = 3 * word_size;
+  size_t values_offset = keys_offset + (1 + count) * word_size;
+  size_t removes_offset = values_offset + word_size + value_string.size() / 2 +
+                          value_offsets.size() / 2;
+  return int_to_hex(keys_offset) + int_to_hex(values_offset) +
+         int_to_hex(removes_offset) + int_to_hex(count) + key_string +
+         int_to_hex(count) + value_offsets + value_string + int_to_hex(count) +
+         remove_string;
+}
+
 auto EthereumAdapter::split(const std::string &response, int split_length)
     -> std::map<const BYTES, BYTES> {
   std::map<const BYTES, BYTES> ret;
@@ -590,12 +1096,6 @@ auto EthereumAdapter::split(const std::string &response, int split_length)
   return ret;
 }
 
-auto EthereumAdapter::write_callback(char *contents, size_t size, size_t nmemb,
-                                     void *userp) -> size_t {
-  ((std::string *)userp)->append(contents, size * nmemb);
-  return size * nmemb;
-}
-
 auto EthereumAdapter::parse_params_to_json(const RpcParams &params)
     -> std::string {
   std::vector<std::string> els;
@@ -647,7 +1147,7 @@ auto EthereumAdapter::call(RpcParams params, bool set_gas) -> std::string {
   // Increment nonce to indicate that Ethereum should not replace a currently
   // pending transaction, but add as new transaction
   if (params.method == "eth_sendTransaction") {
-    params.nonce = ++nonce_;
+    params.nonce = reserve_nonces(1);
   }
 
   std::string json = parse_params_to_json(params);
@@ -662,25 +1162,10 @@ auto EthereumAdapter::call(RpcParams params, bool set_gas) -> std::string {
 
 auto EthereumAdapter::call(std::string &params, std::string &method)
     -> std::string {
-  std::string read_buffer_call;
-  const std::string post_data = R"({"jsonrpc":"2.0","id":1,"method":")" +
-                                method + R"(","params":[)" + params + "]}";
   std::string read_buffer;
 
-  if (curl_ != nullptr) {
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &read_buffer_call);
-    curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, post_data.c_str());
-    CURLcode res = curl_easy_perform(curl_);
-
-    if (res != CURLE_OK) {
-      auto msg = "CURL perform() returned an error: " +
-                 std::string(curl_easy_strerror(res));
-      BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Call, " << msg;
-    }
+  if (std::atomic_load(&transport_) != nullptr) {
+    const std::string read_buffer_call = post(params, method);
 
     if (method == "eth_sendTransaction") {
       nlohmann::json json_response;
@@ -688,10 +1173,10 @@ auto EthereumAdapter::call(std::string &params, std::string &method)
       auto transaction_id = json_response["result"].get<std::string>();
       BOOST_LOG_TRIVIAL(debug)
           << "Ethereum Adapter: Call, Transaction-ID: " << transaction_id;
-      read_buffer = check_mining_result(transaction_id);
-      if (!check_transaction_receipt(transaction_id)) {
-        read_buffer = "error";
-      }
+      nlohmann::json receipt;
+      read_buffer = wait_for_transaction(transaction_id, receipt)
+                        ? receipt.dump()
+                        : "error";
     } else {
       read_buffer = read_buffer_call;
     }
@@ -699,6 +1184,192 @@ auto EthereumAdapter::call(std::string &params, std::string &method)
   return read_buffer;
 }
 
+auto EthereumAdapter::post(const std::string &params,
+                           const std::string &method) -> std::string {
+  std::string read_buffer_call;
+  const std::string post_data = R"({"jsonrpc":"2.0","id":1,"method":")" +
+                                method + R"(","params":[)" + params + "]}";
+
+  // the transport is kept while the request runs, even if the adapter is shut
+  // down meanwhile
+  std::shared_ptr<HttpTransport> transport = std::atomic_load(&transport_);
+  if (transport != nullptr && !transport->post(post_data, read_buffer_call)) {
+    BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Call, request to "
+                             << transport->url() << " failed";
+  }
+  return read_buffer_call;
+}
+
+auto EthereumAdapter::post_all(const std::vector<std::string> &params,
+                               const std::string &method)
+    -> std::vector<std::string> {
+  std::shared_ptr<HttpTransport> transport = std::atomic_load(&transport_);
+  if (transport == nullptr) {
+    return std::vector<std::string>(params.size());
+  }
+
+  std::vector<JSON_RPC_CALL> calls;
+  calls.reserve(params.size());
+  for (const auto &param : params) {
+    calls.push_back({method, param});
+  }
+  return post_json_rpc_batch(*transport, calls, config_.rpc_batch_size());
+}
+
+auto EthereumAdapter::send_transaction(RpcParams params,
+                                       nlohmann::json &receipt) -> bool {
+  std::string transaction_id = submit_transaction(params);
+  if (transaction_id.empty()) {
+    return false;
+  }
+  return wait_for_transaction(transaction_id, receipt);
+}
+
+auto EthereumAdapter::submit_transaction(RpcParams &params) -> std::string {
+  // a rejected transaction is sent again or its nonce is filled like the
+  // ones of a batch, so that it does not hold back later transactions
+  std::vector<RpcParams> transactions{params};
+  std::string transaction_id = submit_transactions(transactions)[0];
+  params = std::move(transactions[0]);
+  if (!transaction_id.empty()) {
+    BOOST_LOG_TRIVIAL(debug)
+        << "Ethereum Adapter: Submit_Transaction, Transaction-ID: "
+        << transaction_id;
+  }
+  return transaction_id;
+}
+
+auto EthereumAdapter::submit_transactions(std::vector<RpcParams> &params)
+    -> std::vector<std::string> {
+  std::vector<std::string> bodies;
+  bodies.reserve(params.size());
+  uint64_t nonce = reserve_nonces(params.size());
+  for (auto &transaction : params) {
+    transaction.method = "eth_sendTransaction";
+    transaction.from = accountAddress_;
+    if (transaction.to.empty()) {
+      transaction.to = storedContractAddress_;
+    }
+    transaction.gas = kEthereumGas;
+    transaction.nonce = nonce++;
+    bodies.push_back(parse_params_to_json(transaction));
+  }
+
+  std::vector<std::string> responses =
+      post_all(bodies, "eth_sendTransaction");
+  std::vector<std::string> transaction_ids(params.size());
+  for (size_t i = 0; i < params.size(); i++) {
+    nlohmann::json json_response;
+    parseTX_response(responses[i], json_response);
+    if (json_response.contains("result") &&
+        json_response["result"].is_string()) {
+      transaction_ids[i] = json_response["result"].get<std::string>();
+      continue;
+    }
+    // the transactions with later nonces can not be mined before this one.
+    // The account may have been used by another client, later nonces are
+    // taken above its transactions.
+    resync_nonces();
+    json_response = nlohmann::json();
+    parseTX_response(post(bodies[i], "eth_sendTransaction"), json_response);
+    if (json_response.contains("result") &&
+        json_response["result"].is_string()) {
+      transaction_ids[i] = json_response["result"].get<std::string>();
+      continue;
+    }
+    RpcParams filler;
+    filler.method = "eth_sendTransaction";
+    filler.from = accountAddress_;
+    filler.to = accountAddress_;
+    filler.nonce = params[i].nonce;
+    post(parse_params_to_json(filler), filler.method);
+    BOOST_LOG_TRIVIAL(debug)
+        << "Ethereum Adapter: Submit_Transactions, transaction with nonce "
+        << params[i].nonce << " was not accepted";
+  }
+  return transaction_ids;
+}
+
+auto EthereumAdapter::reserve_nonces(uint64_t count) -> uint64_t {
+  std::shared_ptr<NonceAllocator> nonces = std::atomic_load(&nonces_);
+  // without an account the node chooses the nonce
+  return nonces != nullptr ? nonces->reserve(count) : 0;
+}
+
+void EthereumAdapter::resync_nonces() {
+  std::shared_ptr<NonceAllocator> nonces = std::atomic_load(&nonces_);
+  if (nonces != nullptr) {
+    nonces->resync();
+  }
+}
+
+auto EthereumAdapter::waits_for_mining(const WRITE_CONTEXT *context) -> bool {
+  return context == nullptr || context->wait_for_mining;
+}
+
+auto EthereumAdapter::send_transactions(
+    const std::vector<std::string> &calldata, WRITE_CONTEXT *context,
+    std::vector<nlohmann::json> *receipts) -> std::vector<bool> {
+  std::vector<bool> results(calldata.size(), false);
+  // receipts are only known once the transactions are mined
+  bool wait_for_mining = waits_for_mining(context) || receipts != nullptr;
+  if (receipts != nullptr) {
+    receipts->assign(calldata.size(), nlohmann::json());
+  }
+  // the nonces order the transactions, so they are mined one after another
+  size_t window = wait_for_mining
+                      ? static_cast<size_t>(MAX_TRANSACTIONS_IN_FLIGHT)
+                      : calldata.size();
+  for (size_t first = 0; first < calldata.size(); first += window) {
+    size_t last = std::min(calldata.size(), first + window);
+    std::vector<RpcParams> params(last - first);
+    for (size_t i = first; i < last; i++) {
+      params[i - first].data = calldata[i];
+    }
+    std::vector<std::string> transaction_ids = submit_transactions(params);
+
+    if (!wait_for_mining) {
+      for (size_t i = first; i < last; i++) {
+        if (transaction_ids[i - first].empty()) {
+          continue;
+        }
+        // the receipt is checked by the caller later
+        context->pending_transactions.push_back(
+            {transaction_ids[i - first], params[i - first].nonce});
+        results[i] = true;
+      }
+      continue;
+    }
+    std::vector<nlohmann::json> window_receipts;
+    std::vector<bool> mined =
+        wait_for_transactions(transaction_ids, &window_receipts);
+    for (size_t i = first; i < last; i++) {
+      results[i] = mined[i - first];
+      if (receipts != nullptr) {
+        (*receipts)[i] = std::move(window_receipts[i - first]);
+      }
+    }
+  }
+  return results;
+}
+
+auto EthereumAdapter::wait_for_transaction(std::string &transaction_ID,
+                                           nlohmann::json &receipt) -> bool {
+  std::shared_ptr<ReceiptPoller> poller = std::atomic_load(&poller_);
+  if (poller == nullptr) {
+    return false;
+  }
+  receipt = poller->wait({transaction_ID},
+                         std::chrono::milliseconds(max_waiting_time_))[0];
+  if (!receipt.is_object()) {
+    BOOST_LOG_TRIVIAL(debug)
+        << "Ethereum Adapter: Wait_For_Transaction, " << transaction_ID
+        << " not mined after " << max_waiting_time_ << " ms";
+    return false;
+  }
+  return receipt.contains("status") && receipt["status"] == "0x1";
+}
+
 void EthereumAdapter::parseTX_response(const std::string &read_buffer_call,
                                        nlohmann::json &json_response) {
   try {
@@ -720,63 +1391,38 @@ void EthereumAdapter::parseTX_response(const std::string &read_buffer_call,
   }
 }
 
-auto EthereumAdapter::check_mining_result(std::string &transaction_ID)
-    -> std::string {
-  std::string response;
-  size_t waited = 0;
-
-  while ((waited + MINING_CHECK_INTERVAL) < this->max_waiting_time_) {
-    std::this_thread::sleep_for(
-        std::chrono::milliseconds(MINING_CHECK_INTERVAL));
-    std::string transaction_param = "\"" + transaction_ID + "\"";
-    std::string method = "eth_getTransactionByHash";
-    response = call(transaction_param, method);
-
-    try {
-      nlohmann::json json_response = nlohmann::json::parse(response);
-
-      if (!(json_response.at("result").at("blockNumber").is_null())) {
-        std::stringstream msg;
-        msg << "Mining took about " << waited << " ms";
-        BOOST_LOG_TRIVIAL(debug)
-            << "Ethereum Adapter: check_mining_result, " << msg.str();
-        return response;
-      }
-    } catch (nlohmann::detail::exception &) {
-      BOOST_LOG_TRIVIAL(debug)
-          << "Ethereum Adapter: check_mining_result, Can't parse response"
-          << response;
-      // continue, so try again
+auto EthereumAdapter::wait_for_transactions(
+    const std::vector<std::string> &transaction_IDs,
+    std::vector<nlohmann::json> *mined_receipts) -> std::vector<bool> {
+  std::vector<bool> results(transaction_IDs.size(), false);
+  std::shared_ptr<ReceiptPoller> poller = std::atomic_load(&poller_);
+  if (poller == nullptr) {
+    if (mined_receipts != nullptr) {
+      mined_receipts->assign(transaction_IDs.size(), nlohmann::json());
     }
-
-    waited += MINING_CHECK_INTERVAL;
+    return results;
   }
 
-  return response;
-}
-
-auto EthereumAdapter::check_transaction_receipt(std::string &transaction_ID)
-    -> bool {
-  std::string method = "eth_getTransactionReceipt";
-  std::string transaction_param = "\"" + transaction_ID + "\"";
-  std::string response = call(transaction_param, method);
-
-  try {
-    nlohmann::json json_response = nlohmann::json::parse(response);
-    BOOST_LOG_TRIVIAL(debug)
-        << "Ethereum Adapter: check_transaction_receipt, Status: "
-        << json_response.at("result").at("status").get<std::string>();
-    if (json_response.at("result").at("status").get<std::string>() == "0x1") {
-      return true;
+  std::vector<nlohmann::json> receipts = poller->wait(
+      transaction_IDs, std::chrono::milliseconds(max_waiting_time_));
+  size_t not_mined = 0;
+  for (size_t i = 0; i < transaction_IDs.size(); i++) {
+    const auto &receipt = receipts[i];
+    if (!receipt.is_object()) {
+      not_mined += transaction_IDs[i].empty() ? 0 : 1;
+      continue;
     }
-  } catch (nlohmann::detail::exception &e) {
+    results[i] = receipt.contains("status") && receipt["status"] == "0x1";
+  }
+  if (not_mined != 0) {
     BOOST_LOG_TRIVIAL(debug)
-        << "EthereumAdapter: check_transaction_receipt, Can't parse response"
-        << e.what();
+        << "Ethereum Adapter: Wait_For_Transactions, " << not_mined
+        << " transaction(s) not mined after " << max_waiting_time_ << " ms";
   }
-  BOOST_LOG_TRIVIAL(debug)
-      << "Ethereum Adapter: check_transaction_receipt, Response: " << response;
-  return false;
+  if (mined_receipts != nullptr) {
+    *mined_receipts = std::move(receipts);
+  }
+  return results;
 }
 
 auto EthereumAdapter::createRpcBatch(std::map<RpcParams, bool> batch,
@@ -801,10 +1447,8 @@ auto EthereumAdapter::createRpcBatch(std::map<RpcParams, bool> batch,
       intermed.gas = kEthereumGas;
     }
 
-    // do we need to change the way how the nonce is updated? what is the real
-    // logic behind that?
     if (intermed.method == "eth_sendTransaction") {
-      intermed.nonce = ++nonce_;
+      intermed.nonce = reserve_nonces(1);
     }
 
     std::string json = parse_params_to_json(intermed);
@@ -828,7 +1472,8 @@ auto EthereumAdapter::createRpcBatch(std::map<RpcParams, bool> batch,
 }
 
 auto EthereumAdapter::sendRpcBatch(std::map<std::string, std::string> batch,
-                                   std::map<std::string, std::string> key_map)
+                                   std::map<std::string, std::string> key_map,
+                                   WRITE_CONTEXT *context)
     -> std::vector<std::string> {
   std::map<std::string, std::string>::iterator batch_iter;
   std::map<std::string, std::string>::iterator key_map_iter;
@@ -836,33 +1481,27 @@ auto EthereumAdapter::sendRpcBatch(std::map<std::string, std::string> batch,
   std::map<std::string, std::string>::iterator json_tid_iter;
   std::vector<std::string> output;
 
-  std::string read_buffer;
-
-  // iterate over all elements in the batch and initiate the transactions on the
-  // blockchain
+  // initiate all transactions of the batch on the blockchain concurrently, the
+  // batch only holds transactions and their nonces were set when it was
+  // created
+  std::vector<std::string> params;
+  params.reserve(batch.size());
   for (batch_iter = batch.begin(); batch_iter != batch.end(); ++batch_iter) {
-    std::string read_buffer_call;
-    const std::string post_data = R"({"jsonrpc":"2.0","id":1,"method":")" +
-                                  batch_iter->second + R"(","params":[)" +
-                                  batch_iter->first + "]}";
-
-    if (curl_ != nullptr) {
-      struct curl_slist *headers = nullptr;
-      headers = curl_slist_append(headers, "Content-Type: application/json");
-
-      curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
-      curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &read_buffer_call);
-      curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, post_data.c_str());
-      CURLcode res = curl_easy_perform(curl_);
-
-      if (res != CURLE_OK) {
-        auto msg = "CURL perform() returned an error: " +
-                   std::string(curl_easy_strerror(res));
-        BOOST_LOG_TRIVIAL(debug) << "Ethereum Adapter: Call, " << msg;
-      }
-    }
+    params.push_back(batch_iter->first);
+  }
+  std::vector<std::string> responses = post_all(params, "eth_sendTransaction");
+  size_t response_index = 0;
+  for (batch_iter = batch.begin(); batch_iter != batch.end(); ++batch_iter) {
+    const std::string &read_buffer_call = responses[response_index++];
     nlohmann::json json_response;
     parseTX_response(read_buffer_call, json_response);
+    if (!json_response.contains("result") ||
+        !json_response["result"].is_string()) {
+      // the transaction was not accepted
+      key_map_iter = key_map.find(batch_iter->first);
+      output.push_back(key_map_iter->second);
+      continue;
+    }
     auto transaction_id = json_response["result"].get<std::string>();
 
     // create mapping between json and the transaction id
@@ -870,15 +1509,34 @@ auto EthereumAdapter::sendRpcBatch(std::map<std::string, std::string> batch,
         std::pair<std::string, std::string>(batch_iter->first, transaction_id));
   }
 
-  // check for all transactionIDs if the transaction has finished or not
+  // the receipts are checked by the caller later
+  if (!waits_for_mining(context)) {
+    for (const auto &json_tid : json_tid_map) {
+      // the nonce was set when the batch was created
+      auto params = nlohmann::json::parse(json_tid.first, nullptr, false);
+      uint64_t nonce = 0;
+      if (params.is_object() && params.contains("nonce")) {
+        nonce = std::stoull(params["nonce"].get<std::string>(), nullptr,
+                            ENCODED_BYTE_SIZE);
+      }
+      context->pending_transactions.push_back({json_tid.second, nonce});
+    }
+    return output;
+  }
+
+  // wait until all transactions are mined
+  std::vector<std::string> transaction_ids;
+  transaction_ids.reserve(json_tid_map.size());
+  for (json_tid_iter = json_tid_map.begin();
+       json_tid_iter != json_tid_map.end(); ++json_tid_iter) {
+    transaction_ids.push_back(json_tid_iter->second);
+  }
+  std::vector<bool> mined = wait_for_transactions(transaction_ids);
+  size_t mined_index = 0;
   for (json_tid_iter = json_tid_map.begin();
        json_tid_iter != json_tid_map.end(); ++json_tid_iter) {
-    read_buffer = check_mining_result(json_tid_iter->second);
-
     // if error, then add the corresponding key to the return vector
-    if (!check_transaction_receipt(json_tid_iter->second)) {
-      read_buffer = "error";
-
+    if (!mined[mined_index++]) {
       key_map_iter = key_map.find(json_tid_iter->first);
       output.push_back(key_map_iter->second);
     }
@@ -0,0 +1,311 @@
+#include "adapter_ethereum/head_monitor.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <future>
+#include <unordered_map>
+
+#if LIBCURL_VERSION_NUM >= 0x075600
+// Receives a frame with curl_ws_recv, whose frame argument is only const in
+// later versions of libcurl
+template <typename FRAME>
+static auto ws_recv(CURLcode (*recv)(CURL *, void *, size_t, size_t *,
+                                     FRAME **),
+                    CURL *curl, void *buffer, size_t length, size_t *received,
+                    const struct curl_ws_frame **meta) -> CURLcode {
+  FRAME *frame = nullptr;
+  CURLcode res = recv(curl, buffer, length, received, &frame);
+  *meta = frame;
+  return res;
+}
+#endif
+
+auto HeadMonitor::get(const std::shared_ptr<HttpTransport> &transport,
+                      const std::string &ws_url)
+    -> std::shared_ptr<HeadMonitor> {
+  static std::mutex mutex;
+  // monitors are freed when the last adapter of the node is
+  static std::unordered_map<std::string, std::weak_ptr<HeadMonitor>> monitors;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<HeadMonitor> monitor = monitors[transport->url()].lock();
+  if (monitor == nullptr) {
+    monitor = std::make_shared<HeadMonitor>(transport, ws_url);
+    monitors[transport->url()] = monitor;
+  }
+  return monitor;
+}
+
+HeadMonitor::HeadMonitor(std::shared_ptr<HttpTransport> transport,
+                         std::string ws_url)
+    : transport_(std::move(transport)), ws_url_(std::move(ws_url)) {
+  if (pipe(wakeup_pipe_) != 0) {
+    // the monitor thread then notices a stop only after its next timeout
+    BOOST_LOG_TRIVIAL(debug) << "Head Monitor: Can't create wakeup pipe";
+    wakeup_pipe_[0] = wakeup_pipe_[1] = -1;
+  }
+  thread_ = std::thread(&HeadMonitor::run, this);
+}
+
+HeadMonitor::~HeadMonitor() {
+  stopping_ = true;
+  if (wakeup_pipe_[1] != -1 && write(wakeup_pipe_[1], "x", 1) != 1) {
+    BOOST_LOG_TRIVIAL(debug) << "Head Monitor: Can't wake monitor thread";
+  }
+  thread_.join();
+  for (int fd : wakeup_pipe_) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+}
+
+auto HeadMonitor::head() const -> CHAIN_HEAD {
+  CHAIN_HEAD head;
+  uint64_t before = 0;
+  uint64_t after = 0;
+  do {
+    before = sequence_.load(std::memory_order_acquire);
+    head.number = number_.load(std::memory_order_relaxed);
+    head.timestamp = timestamp_.load(std::memory_order_relaxed);
+    head.observed = Clock::time_point(
+        Clock::duration(observed_.load(std::memory_order_relaxed)));
+    head.live = live_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = sequence_.load(std::memory_order_relaxed);
+  } while ((before & 1) != 0 || before != after);
+  return head;
+}
+
+auto HeadMonitor::add_listener(Listener listener) -> size_t {
+  std::lock_guard<std::mutex> lock(listener_mutex_);
+  size_t id = next_listener_++;
+  listeners_.emplace(id, std::move(listener));
+  return id;
+}
+
+void HeadMonitor::remove_listener(size_t id) {
+  std::lock_guard<std::mutex> lock(listener_mutex_);
+  listeners_.erase(id);
+}
+
+void HeadMonitor::run() {
+  while (!stopping_) {
+    if (!ws_url_.empty() && subscribe()) {
+      // the subscription ended, e.g. the node restarted
+      wait(kMaxPollInterval);
+      continue;
+    }
+    poll();
+  }
+}
+
+auto HeadMonitor::subscribe() -> bool {
+#if LIBCURL_VERSION_NUM >= 0x075600
+  CURL *curl = curl_easy_init();
+  if (curl == nullptr) {
+    return false;
+  }
+  curl_easy_setopt(curl, CURLOPT_URL, ws_url_.c_str());
+  // only the handshake, the frames are sent and received by hand
+  curl_easy_setopt(curl, CURLOPT_CONNECT_ONLY, 2L);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, kConnectTimeoutMs);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  CURLcode res = curl_easy_perform(curl);
+  curl_socket_t socket = CURL_SOCKET_BAD;
+  if (res == CURLE_OK) {
+    res = curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &socket);
+  }
+  if (res == CURLE_OK) {
+    const std::string request =
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_subscribe",)"
+        R"("params":["newHeads"]})";
+    size_t sent = 0;
+    res = curl_ws_send(curl, request.data(), request.size(), &sent, 0,
+                       CURLWS_TEXT);
+  }
+  if (res != CURLE_OK) {
+    BOOST_LOG_TRIVIAL(debug) << "Head Monitor: Subscribe, can't connect to "
+                             << ws_url_ << ": " << curl_easy_strerror(res);
+    curl_easy_cleanup(curl);
+    return false;
+  }
+
+  bool subscribed = false;
+  std::string message;
+  char buffer[4096];
+  while (!stopping_) {
+    size_t received = 0;
+    const struct curl_ws_frame *meta = nullptr;
+    res = ws_recv(curl_ws_recv, curl, buffer, sizeof(buffer), &received,
+                  &meta);
+    if (res == CURLE_AGAIN) {
+      wait(kMaxPollInterval, static_cast<int>(socket));
+      continue;
+    }
+    if (res != CURLE_OK || (meta->flags & CURLWS_CLOSE) != 0) {
+      BOOST_LOG_TRIVIAL(debug)
+          << "Head Monitor: Subscribe, connection to " << ws_url_
+          << " closed: " << curl_easy_strerror(res);
+      break;
+    }
+    if ((meta->flags & (CURLWS_TEXT | CURLWS_CONT)) == 0) {
+      continue;
+    }
+    // a message may arrive in several frames and a frame in several parts
+    message.append(buffer, received);
+    if (meta->bytesleft > 0 || (meta->flags & CURLWS_CONT) != 0) {
+      continue;
+    }
+    auto json = nlohmann::json::parse(message, nullptr, false);
+    message.clear();
+
+    if (!subscribed) {
+      if (!json.is_object() || !json.contains("result") ||
+          !json["result"].is_string()) {
+        BOOST_LOG_TRIVIAL(debug)
+            << "Head Monitor: Subscribe, newHeads not available at "
+            << ws_url_ << ": " << json.dump();
+        break;
+      }
+      subscribed = true;
+      // the first block is pushed when it is mined, until then the head is
+      // read once
+      nlohmann::json block = latest_block();
+      if (!block.is_null()) {
+        publish(block, true);
+      }
+      continue;
+    }
+    if (json.is_object() && json.value("method", "") == "eth_subscription" &&
+        json.contains("params") && json["params"].contains("result")) {
+      publish(json["params"]["result"], true);
+    }
+  }
+  curl_easy_cleanup(curl);
+
+  CHAIN_HEAD head = this->head();
+  if (head.live) {
+    head.live = false;
+    store(head);
+  }
+  return subscribed;
+#else
+  // libcurl supports WebSocket since 7.86.0
+  return false;
+#endif
+}
+
+void HeadMonitor::poll() {
+  const Clock::time_point resubscribe = Clock::now() + kResubscribeInterval;
+  while (!stopping_ && (ws_url_.empty() || Clock::now() < resubscribe)) {
+    std::chrono::milliseconds delay = kMaxPollInterval;
+    const CHAIN_HEAD last = head();
+    nlohmann::json block = latest_block();
+    if (!block.is_null() && publish(block, false)) {
+      const CHAIN_HEAD current = head();
+      if (last.number != 0) {
+        // moving average of the intervals, one sample per poll that saw new
+        // blocks
+        auto sample = std::chrono::duration_cast<std::chrono::milliseconds>(
+            (current.observed - last.observed) /
+            (current.number - last.number));
+        block_interval_ = std::clamp((block_interval_ * 3 + sample) / 4,
+                                     kMinBlockInterval, kMaxBlockInterval);
+      }
+    }
+    if (!block.is_null()) {
+      // poll when the next block is expected, more often if it is overdue
+      const CHAIN_HEAD current = head();
+      const auto until_expected =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              current.observed + block_interval_ - Clock::now());
+      delay = until_expected > kMinPollInterval ? until_expected
+                                                : block_interval_ / 4;
+      delay = std::clamp(delay, kMinPollInterval, kMaxPollInterval);
+    }
+    if (!wait(delay)) {
+      return;
+    }
+  }
+}
+
+auto HeadMonitor::latest_block() -> nlohmann::json {
+  std::future<HTTP_RESPONSE> future = transport_->post_async(
+      R"({"jsonrpc":"2.0","id":1,"method":"eth_getBlockByNumber",)"
+      R"("params":["latest",false]})");
+  // the node may not answer for long, the monitor has to stop anyway
+  while (future.wait_for(kMaxPollInterval) != std::future_status::ready) {
+    if (stopping_) {
+      return nullptr;
+    }
+  }
+  HTTP_RESPONSE response = future.get();
+  auto json = nlohmann::json::parse(response.body, nullptr, false);
+  if (!response.ok || !json.is_object() || !json.contains("result") ||
+      !json["result"].is_object()) {
+    BOOST_LOG_TRIVIAL(debug)
+        << "Head Monitor: Latest_Block, Can't read latest block from "
+        << transport_->url();
+    return nullptr;
+  }
+  return json["result"];
+}
+
+auto HeadMonitor::publish(const nlohmann::json &block, bool live) -> bool {
+  CHAIN_HEAD head;
+  try {
+    head.number =
+        std::stoull(block.at("number").get<std::string>(), nullptr, 16);
+    head.timestamp =
+        std::stoull(block.at("timestamp").get<std::string>(), nullptr, 16);
+  } catch (std::exception &) {
+    BOOST_LOG_TRIVIAL(debug) << "Head Monitor: Publish, Can't parse block "
+                             << block.dump();
+    return false;
+  }
+  head.observed = Clock::now();
+  head.live = live;
+
+  const CHAIN_HEAD current = this->head();
+  // blocks of a reorganization may be pushed after higher ones
+  if (head.number < current.number ||
+      (head.number == current.number && live == current.live)) {
+    return false;
+  }
+  if (head.number == current.number) {
+    head.observed = current.observed;
+    store(head);
+    return false;
+  }
+  store(head);
+
+  std::lock_guard<std::mutex> lock(listener_mutex_);
+  for (auto &listener : listeners_) {
+    listener.second(head);
+  }
+  return true;
+}
+
+void HeadMonitor::store(const CHAIN_HEAD &head) {
+  // only the monitor thread writes, readers retry while the sequence is odd
+  // or changed
+  const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  number_.store(head.number, std::memory_order_relaxed);
+  timestamp_.store(head.timestamp, std::memory_order_relaxed);
+  observed_.store(head.observed.time_since_epoch().count(),
+                  std::memory_order_relaxed);
+  live_.store(head.live, std::memory_order_relaxed);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+auto HeadMonitor::wait(std::chrono::milliseconds timeout, int socket) -> bool {
+  struct pollfd fds[2] = {{wakeup_pipe_[0], POLLIN, 0}, {socket, POLLIN, 0}};
+  ::poll(fds, socket == -1 ? 1 : 2, static_cast<int>(timeout.count()));
+  return !stopping_;
+}
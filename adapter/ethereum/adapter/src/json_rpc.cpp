@@ -0,0 +1,66 @@
+#include "adapter_ethereum/json_rpc.h"
+
+#include <boost/log/trivial.hpp>
+
+#include "storage/blockchainDB/adapter/utils/src/json.hpp"
+
+auto post_json_rpc_batch(HttpTransport &transport,
+                         const std::vector<JSON_RPC_CALL> &calls,
+                         size_t batch_size) -> std::vector<std::string> {
+  std::vector<std::string> responses(calls.size());
+
+  std::vector<std::string> payloads;
+  std::string payload;
+  size_t batched = 0;
+  auto finish_payload = [&]() {
+    // a single call is sent as plain request
+    payloads.push_back(batched == 1 ? payload.substr(1) : payload + "]");
+    payload.clear();
+    batched = 0;
+  };
+  for (size_t i = 0; i < calls.size(); i++) {
+    std::string request = R"({"jsonrpc":"2.0","id":)" + std::to_string(i) +
+                          R"(,"method":")" + calls[i].method +
+                          R"(","params":[)" + calls[i].params + "]}";
+    if (batched != 0 && payload.size() + request.size() + 2 > batch_size) {
+      finish_payload();
+    }
+    payload += batched == 0 ? "[" : ",";
+    payload += request;
+    batched++;
+  }
+  if (batched != 0) {
+    finish_payload();
+  }
+
+  // demultiplex the responses by their ids
+  auto store_response = [&](const nlohmann::json &response) {
+    if (!response.is_object() || !response.contains("id") ||
+        !response["id"].is_number_unsigned()) {
+      return;
+    }
+    size_t id = response["id"].get<size_t>();
+    if (id < responses.size()) {
+      responses[id] = response.dump();
+    }
+  };
+  for (const auto &http_response : transport.post_all(payloads)) {
+    if (!http_response.ok) {
+      continue;
+    }
+    auto json = nlohmann::json::parse(http_response.body, nullptr, false);
+    if (json.is_array()) {
+      for (const auto &response : json) {
+        store_response(response);
+      }
+    } else if (json.is_object() && json.contains("id") &&
+               !json["id"].is_null()) {
+      store_response(json);
+    } else {
+      BOOST_LOG_TRIVIAL(debug)
+          << "JSON-RPC: Post_Batch, batch request failed: "
+          << http_response.body;
+    }
+  }
+  return responses;
+}
@@ -0,0 +1,78 @@
+#include "adapter_ethereum/nonce_allocator.h"
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <unordered_map>
+
+#include "storage/blockchainDB/adapter/utils/src/json.hpp"
+
+auto NonceAllocator::get(const std::shared_ptr<HttpTransport> &transport,
+                         const std::string &account)
+    -> std::shared_ptr<NonceAllocator> {
+  static std::mutex mutex;
+  // allocators are freed when the last adapter of the account is
+  static std::unordered_map<std::string, std::weak_ptr<NonceAllocator>>
+      allocators;
+
+  const std::string id = transport->url() + " " + account;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<NonceAllocator> allocator = allocators[id].lock();
+  if (allocator == nullptr) {
+    allocator = std::make_shared<NonceAllocator>(transport, account);
+    allocators[id] = allocator;
+  }
+  return allocator;
+}
+
+NonceAllocator::NonceAllocator(std::shared_ptr<HttpTransport> transport,
+                               std::string account)
+    : transport_(std::move(transport)), account_(std::move(account)) {}
+
+auto NonceAllocator::reserve(uint64_t count) -> uint64_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the count is read again with the next reservation if the node failed
+  uint64_t pending_count = 0;
+  if (!synced_ && read_pending_count(pending_count)) {
+    next_ = std::max(next_, pending_count);
+    synced_ = true;
+  }
+  uint64_t first = next_;
+  next_ += count;
+  return first;
+}
+
+void NonceAllocator::resync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t pending_count = 0;
+  if (read_pending_count(pending_count)) {
+    next_ = std::max(next_, pending_count);
+  }
+}
+
+auto NonceAllocator::read_pending_count(uint64_t &count) -> bool {
+  // the pending transactions of the account are counted as well
+  const std::string body = R"({"jsonrpc":"2.0","id":1,)"
+                           R"("method":"eth_getTransactionCount","params":[")" +
+                           account_ + R"(","pending"]})";
+  std::string response;
+  if (!transport_->post(body, response)) {
+    BOOST_LOG_TRIVIAL(debug)
+        << "Nonce Allocator: Read_Pending_Count, request to "
+        << transport_->url() << " failed";
+    return false;
+  }
+  auto json = nlohmann::json::parse(response, nullptr, false);
+  if (!json.is_object() || !json.contains("result") ||
+      !json["result"].is_string()) {
+    BOOST_LOG_TRIVIAL(debug) << "Nonce Allocator: Read_Pending_Count, Failed: "
+                                "Can not parse eth_getTransactionCount "
+                                "response!";
+    return false;
+  }
+  try {
+    count = std::stoull(json["result"].get<std::string>(), nullptr, 16);
+  } catch (std::exception &) {
+    return false;
+  }
+  return true;
+}
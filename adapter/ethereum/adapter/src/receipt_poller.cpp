@@ -0,0 +1,254 @@
+#include "adapter_ethereum/receipt_poller.h"
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+
+#include "adapter_ethereum/json_rpc.h"
+
+auto ReceiptPoller::get(const std::shared_ptr<HttpTransport> &transport,
+                        const std::shared_ptr<HeadMonitor> &monitor,
+                        size_t batch_size) -> std::shared_ptr<ReceiptPoller> {
+  static std::mutex mutex;
+  // pollers are freed when the last adapter of the node is
+  static std::unordered_map<std::string, std::weak_ptr<ReceiptPoller>> pollers;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<ReceiptPoller> poller = pollers[transport->url()].lock();
+  if (poller == nullptr) {
+    poller = std::make_shared<ReceiptPoller>(transport, monitor, batch_size);
+    pollers[transport->url()] = poller;
+  }
+  return poller;
+}
+
+ReceiptPoller::ReceiptPoller(std::shared_ptr<HttpTransport> transport,
+                             std::shared_ptr<HeadMonitor> monitor,
+                             size_t batch_size)
+    : transport_(std::move(transport)),
+      monitor_(std::move(monitor)),
+      batch_size_(batch_size) {
+  listener_ = monitor_->add_listener([this](const CHAIN_HEAD &) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    new_head_ = true;
+    work_.notify_one();
+  });
+}
+
+ReceiptPoller::~ReceiptPoller() {
+  monitor_->remove_listener(listener_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_.notify_all();
+  mined_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  // the transactions are not watched anymore
+  for (auto &entry : pending_) {
+    for (auto &watcher : entry.second.watchers) {
+      watcher.second(entry.first, nlohmann::json());
+    }
+  }
+}
+
+auto ReceiptPoller::wait(const std::vector<std::string> &transaction_IDs,
+                         std::chrono::milliseconds timeout)
+    -> std::vector<nlohmann::json> {
+  std::vector<nlohmann::json> receipts(transaction_IDs.size());
+  const Clock::time_point deadline = Clock::now() + timeout;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool registered = false;
+  for (const auto &transaction_ID : transaction_IDs) {
+    if (!transaction_ID.empty()) {
+      pending_[transaction_ID].waiters++;
+      registered = true;
+    }
+  }
+  if (!registered) {
+    return receipts;
+  }
+  if (!thread_.joinable()) {
+    thread_ = std::thread(&ReceiptPoller::run, this);
+  }
+  work_.notify_one();
+
+  mined_.wait_until(lock, deadline, [&]() {
+    if (stopping_) {
+      return true;
+    }
+    for (const auto &transaction_ID : transaction_IDs) {
+      if (!transaction_ID.empty() &&
+          pending_[transaction_ID].receipt.is_null()) {
+        return false;
+      }
+    }
+    return true;
+  });
+
+  for (size_t i = 0; i < transaction_IDs.size(); i++) {
+    auto it = pending_.find(transaction_IDs[i]);
+    if (transaction_IDs[i].empty() || it == pending_.end()) {
+      continue;
+    }
+    receipts[i] = it->second.receipt;
+    if (--it->second.waiters == 0 && it->second.watchers.empty()) {
+      pending_.erase(it);
+    }
+  }
+  return receipts;
+}
+
+void ReceiptPoller::watch(const std::vector<std::string> &transaction_IDs,
+                          std::chrono::milliseconds timeout,
+                          const Watcher &finished) {
+  const Clock::time_point deadline = Clock::now() + timeout;
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool registered = false;
+  for (const auto &transaction_ID : transaction_IDs) {
+    if (!transaction_ID.empty()) {
+      pending_[transaction_ID].watchers.emplace_back(deadline, finished);
+      registered = true;
+    }
+  }
+  if (!registered) {
+    return;
+  }
+  if (!thread_.joinable()) {
+    thread_ = std::thread(&ReceiptPoller::run, this);
+  }
+  work_.notify_one();
+}
+
+void ReceiptPoller::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Clock::time_point last_tick;
+  bool failed = false;
+  while (!stopping_) {
+    if (pending_.empty()) {
+      work_.wait(lock, [&]() { return stopping_ || !pending_.empty(); });
+      continue;
+    }
+    // watchers are called without the lock, they may watch new transactions
+    Clock::time_point next_deadline = Clock::time_point::max();
+    std::vector<WatcherCall> calls = take_watchers(Clock::now(), next_deadline);
+    if (!calls.empty()) {
+      lock.unlock();
+      for (auto &call : calls) {
+        call.first(call.second.first, call.second.second);
+      }
+      lock.lock();
+      continue;
+    }
+    if (new_head_) {
+      new_head_ = false;
+      for (auto &entry : pending_) {
+        entry.second.checked = false;
+      }
+    }
+
+    // new transactions may already be mined, they are checked right away
+    // unless the node failed
+    std::vector<std::string> unchecked;
+    for (const auto &entry : pending_) {
+      if (!entry.second.checked && entry.second.receipt.is_null()) {
+        unchecked.push_back(entry.first);
+      }
+    }
+    Clock::time_point due = last_tick + kRecheckInterval;
+    if (!unchecked.empty()) {
+      due = last_tick + (failed ? kRetryInterval : kMinTick);
+    }
+    if (Clock::now() < due) {
+      // watchers whose time is up are called in the next round
+      work_.wait_until(lock, std::min(due, next_deadline));
+      continue;
+    }
+    if (unchecked.empty()) {
+      for (auto &entry : pending_) {
+        entry.second.checked = false;
+      }
+      continue;
+    }
+
+    last_tick = Clock::now();
+    lock.unlock();
+    std::vector<nlohmann::json> receipts;
+    failed = !poll(unchecked, receipts);
+    lock.lock();
+
+    bool mined = false;
+    for (size_t i = 0; i < unchecked.size(); i++) {
+      auto it = pending_.find(unchecked[i]);
+      // the request failed, the receipt is read again in the next tick
+      if (it == pending_.end() || receipts[i].is_discarded()) {
+        continue;
+      }
+      it->second.checked = true;
+      if (!receipts[i].is_null()) {
+        it->second.receipt = std::move(receipts[i]);
+        mined = true;
+      }
+    }
+    if (mined) {
+      mined_.notify_all();
+    }
+  }
+}
+
+auto ReceiptPoller::take_watchers(Clock::time_point now,
+                                  Clock::time_point &next_deadline)
+    -> std::vector<WatcherCall> {
+  std::vector<WatcherCall> calls;
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    auto &watchers = it->second.watchers;
+    for (auto watcher = watchers.begin(); watcher != watchers.end();) {
+      if (!it->second.receipt.is_null() || watcher->first <= now) {
+        calls.push_back({std::move(watcher->second),
+                         {it->first, it->second.receipt}});
+        watcher = watchers.erase(watcher);
+      } else {
+        next_deadline = std::min(next_deadline, watcher->first);
+        watcher++;
+      }
+    }
+    if (it->second.waiters == 0 && watchers.empty()) {
+      it = pending_.erase(it);
+    } else {
+      it++;
+    }
+  }
+  return calls;
+}
+
+auto ReceiptPoller::poll(const std::vector<std::string> &transaction_IDs,
+                         std::vector<nlohmann::json> &receipts) -> bool {
+  std::vector<JSON_RPC_CALL> calls;
+  calls.reserve(transaction_IDs.size());
+  for (const auto &transaction_ID : transaction_IDs) {
+    calls.push_back({"eth_getTransactionReceipt", "\"" + transaction_ID + "\""});
+  }
+  std::vector<std::string> responses =
+      post_json_rpc_batch(*transport_, calls, batch_size_);
+
+  // the receipt is null until the transaction is mined, a failed request
+  // is marked as discarded
+  bool read = false;
+  receipts.assign(transaction_IDs.size(),
+                  nlohmann::json(nlohmann::json::value_t::discarded));
+  for (size_t i = 0; i < transaction_IDs.size(); i++) {
+    auto response = nlohmann::json::parse(responses[i], nullptr, false);
+    if (response.is_object() && response.contains("result") &&
+        (response["result"].is_object() || response["result"].is_null())) {
+      receipts[i] = std::move(response["result"]);
+      read = true;
+    }
+  }
+  if (!read) {
+    BOOST_LOG_TRIVIAL(debug) << "Receipt Poller: Poll, Can't read receipts from "
+                             << transport_->url();
+  }
+  return read;
+}
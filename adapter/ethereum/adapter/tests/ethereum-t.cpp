@@ -1,6 +1,21 @@
 //#include "adapter_interface_test.h"
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <thread>
+
 #include "adapter_ethereum/adapter_ethereum.h"
+#include "adapter_ethereum/head_monitor.h"
+#include "adapter_ethereum/json_rpc.h"
 #include "adapter_interface_test.h"
 
 // Instantiate AdapterInterfaceTest suite
@@ -16,3 +31,562 @@ TEST(EthereumAdapterTests /*unused*/, singleethereumtest /*unused*/) {
   EXPECT_EQ(5, 5);
   EXPECT_TRUE(true);
 }
+
+/**********************************************
+ *  Head monitor, against a mock node
+ ***********************************************/
+
+// Computes the SHA-1 digest of a message, for the WebSocket handshake
+static auto sha1(const std::string &message) -> std::array<uint8_t, 20> {
+  auto rotl = [](uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+  };
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                   0xC3D2E1F0};
+  std::string data = message;
+  const uint64_t bits = message.size() * 8;
+  data += static_cast<char>(0x80);
+  while (data.size() % 64 != 56) {
+    data += '\0';
+  }
+  for (int i = 7; i >= 0; i--) {
+    data += static_cast<char>((bits >> (i * 8)) & 0xff);
+  }
+  for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      w[i] = 0;
+      for (int j = 0; j < 4; j++) {
+        w[i] = (w[i] << 8) | static_cast<uint8_t>(data[chunk + 4 * i + j]);
+      }
+    }
+    for (int i = 16; i < 80; i++) {
+      w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f = 0;
+      uint32_t k = 0;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t t = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  std::array<uint8_t, 20> digest{};
+  for (int i = 0; i < 20; i++) {
+    digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+  }
+  return digest;
+}
+
+// Encodes bytes as base64, for the WebSocket handshake
+static auto base64(const uint8_t *bytes, size_t size) -> std::string {
+  static const char *alphabet =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  for (size_t i = 0; i < size; i += 3) {
+    uint32_t group = bytes[i] << 16;
+    if (i + 1 < size) {
+      group |= bytes[i + 1] << 8;
+    }
+    if (i + 2 < size) {
+      group |= bytes[i + 2];
+    }
+    encoded += alphabet[(group >> 18) & 0x3f];
+    encoded += alphabet[(group >> 12) & 0x3f];
+    encoded += i + 1 < size ? alphabet[(group >> 6) & 0x3f] : '=';
+    encoded += i + 2 < size ? alphabet[group & 0x3f] : '=';
+  }
+  return encoded;
+}
+
+/**
+ * @brief Mock Ethereum node on localhost. It answers eth_getBlockByNumber
+ * over HTTP and, if WebSocket is enabled, newHeads subscriptions. Otherwise
+ * it rejects the WebSocket handshake, like a node without WebSocket.
+ *
+ */
+class MockNode {
+ public:
+  explicit MockNode(bool websocket) : websocket_(websocket) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    listen(listen_fd_, 16);
+    socklen_t length = sizeof(address);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&address), &length);
+    port_ = ntohs(address.sin_port);
+    accept_thread_ = std::thread(&MockNode::accept_loop, this);
+  }
+
+  ~MockNode() {
+    shutdown(listen_fd_, SHUT_RDWR);
+    close(listen_fd_);
+    accept_thread_.join();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (int fd : clients_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+    }
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+    for (int fd : clients_) {
+      close(fd);
+    }
+  }
+
+  auto url() const -> std::string {
+    return "http://127.0.0.1:" + std::to_string(port_);
+  }
+  auto ws_url() const -> std::string {
+    return "ws://127.0.0.1:" + std::to_string(port_);
+  }
+
+  /**
+   * @brief Sets the head and pushes it to the subscribers
+   */
+  void set_head(uint64_t number) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    head_ = number;
+    for (int fd : subscribers_) {
+      send_frame(fd, R"({"jsonrpc":"2.0","method":"eth_subscription",)"
+                     R"("params":{"subscription":"0x1","result":)" +
+                         block() + "}}");
+    }
+  }
+
+ private:
+  void accept_loop() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      clients_.push_back(fd);
+      threads_.emplace_back(&MockNode::serve, this, fd);
+    }
+  }
+
+  void serve(int fd) {
+    std::string buffer;
+    while (true) {
+      size_t end = 0;
+      while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (!receive(fd, buffer)) {
+          return;
+        }
+      }
+      std::string headers = buffer.substr(0, end + 4);
+      buffer.erase(0, end + 4);
+      std::string lower = headers;
+      std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+      if (lower.find("upgrade: websocket") != std::string::npos) {
+        if (!websocket_) {
+          write_all(fd, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n"
+                        "Connection: close\r\n\r\n");
+          return;
+        }
+        size_t key = lower.find("sec-websocket-key:") + 18;
+        std::string accept_key =
+            headers.substr(key, headers.find("\r\n", key) - key);
+        accept_key.erase(0, accept_key.find_first_not_of(' '));
+        auto digest =
+            sha1(accept_key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+        write_all(fd, "HTTP/1.1 101 Switching Protocols\r\n"
+                      "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Accept: " +
+                          base64(digest.data(), digest.size()) + "\r\n\r\n");
+        subscribe(fd, buffer);
+        return;
+      }
+
+      size_t length_at = lower.find("content-length:");
+      size_t length = length_at == std::string::npos
+                          ? 0
+                          : std::stoul(headers.substr(length_at + 15));
+      while (buffer.size() < length) {
+        if (!receive(fd, buffer)) {
+          return;
+        }
+      }
+      buffer.erase(0, length);
+      std::string body;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body = R"({"jsonrpc":"2.0","id":1,"result":)" + block() + "}";
+      }
+      write_all(fd, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                    "Content-Length: " +
+                        std::to_string(body.size()) + "\r\n\r\n" + body);
+    }
+  }
+
+  // Answers the eth_subscribe frame and pushes heads until the client closes
+  void subscribe(int fd, std::string &buffer) {
+    // client frames are masked, the request is short
+    while (buffer.size() < 6 ||
+           buffer.size() < 6u + (static_cast<uint8_t>(buffer[1]) & 0x7f)) {
+      if (!receive(fd, buffer)) {
+        return;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      subscribers_.push_back(fd);
+      send_frame(fd, R"({"jsonrpc":"2.0","id":1,"result":"0x1"})");
+    }
+    buffer.clear();
+    while (receive(fd, buffer)) {
+      buffer.clear();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.erase(
+        std::remove(subscribers_.begin(), subscribers_.end(), fd),
+        subscribers_.end());
+  }
+
+  // Header of the head block, the caller holds the mutex
+  auto block() const -> std::string {
+    std::stringstream hex;
+    hex << std::hex << head_;
+    return R"({"number":"0x)" + hex.str() + R"(","timestamp":"0x5f5e100"})";
+  }
+
+  // Sends an unmasked text frame, the caller holds the mutex
+  static void send_frame(int fd, const std::string &payload) {
+    std::string frame(1, static_cast<char>(0x81));
+    if (payload.size() < 126) {
+      frame += static_cast<char>(payload.size());
+    } else {
+      frame += static_cast<char>(126);
+      frame += static_cast<char>(payload.size() >> 8);
+      frame += static_cast<char>(payload.size() & 0xff);
+    }
+    write_all(fd, frame + payload);
+  }
+
+  static auto receive(int fd, std::string &buffer) -> bool {
+    char chunk[4096];
+    ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+      return false;
+    }
+    buffer.append(chunk, received);
+    return true;
+  }
+
+  static void write_all(int fd, const std::string &data) {
+    size_t written = 0;
+    while (written < data.size()) {
+      ssize_t sent =
+          send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+      if (sent <= 0) {
+        return;
+      }
+      written += sent;
+    }
+  }
+
+  bool websocket_;
+  int listen_fd_;
+  int port_;
+  std::thread accept_thread_;
+  std::mutex mutex_;
+  std::vector<int> clients_;
+  std::vector<std::thread> threads_;
+  std::vector<int> subscribers_;
+  uint64_t head_ = 0;
+};
+
+// Waits up to 5 seconds until a condition holds
+static auto eventually(const std::function<bool()> &condition) -> bool {
+  for (int i = 0; i < 100; i++) {
+    if (condition()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return condition();
+}
+
+static auto curl_supports_websocket() -> bool {
+  const curl_version_info_data *info = curl_version_info(CURLVERSION_NOW);
+  for (const char *const *protocol = info->protocols; *protocol != nullptr;
+       protocol++) {
+    if (std::string(*protocol) == "ws") {
+      return true;
+    }
+  }
+  return false;
+}
+
+TEST(EthereumAdapterTests /*unused*/, HeadMonitorNewHeads /*unused*/) {
+  if (!curl_supports_websocket()) {
+    GTEST_SKIP() << "libcurl is built without WebSocket support";
+  }
+  MockNode node(true);
+  node.set_head(16);
+  auto transport = std::make_shared<HttpTransport>(node.url());
+  HeadMonitor monitor(transport, node.ws_url());
+
+  // the head is read once when subscribed, then pushed
+  EXPECT_TRUE(eventually([&]() {
+    CHAIN_HEAD head = monitor.head();
+    return head.live && head.number == 16;
+  }));
+  EXPECT_EQ(monitor.head().timestamp, 100000000);
+
+  std::atomic_uint64_t notified{0};
+  size_t listener = monitor.add_listener(
+      [&](const CHAIN_HEAD &head) { notified = head.number; });
+  node.set_head(17);
+  EXPECT_TRUE(eventually([&]() { return notified == 17; }));
+  EXPECT_EQ(monitor.head().number, 17);
+  EXPECT_TRUE(monitor.head().live);
+  monitor.remove_listener(listener);
+}
+
+TEST(EthereumAdapterTests /*unused*/, HeadMonitorPollingFallback /*unused*/) {
+  // the node rejects the WebSocket handshake
+  MockNode node(false);
+  node.set_head(5);
+  auto transport = std::make_shared<HttpTransport>(node.url());
+  HeadMonitor monitor(transport, node.ws_url());
+
+  EXPECT_TRUE(eventually([&]() { return monitor.head().number == 5; }));
+  EXPECT_FALSE(monitor.head().live);
+  node.set_head(6);
+  EXPECT_TRUE(eventually([&]() { return monitor.head().number == 6; }));
+  EXPECT_FALSE(monitor.head().live);
+}
+
+/**********************************************
+ *  HTTP transport, against a mock node
+ ***********************************************/
+
+// Opens a socket that listens but never answers, connects complete in the
+// backlog. Returns the socket and sets the URL of the socket.
+static auto silent_node(std::string &url) -> int {
+  int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+  listen(listen_fd, 16);
+  socklen_t length = sizeof(address);
+  getsockname(listen_fd, reinterpret_cast<sockaddr *>(&address), &length);
+  url = "http://127.0.0.1:" + std::to_string(ntohs(address.sin_port));
+  return listen_fd;
+}
+
+TEST(EthereumAdapterTests /*unused*/, HttpTransportTimeout /*unused*/) {
+  std::string url;
+  int listen_fd = silent_node(url);
+  HTTP_TIMEOUTS timeouts;
+  timeouts.request = 1;
+  HttpTransport transport(url, timeouts);
+  auto begin = std::chrono::steady_clock::now();
+  std::string response;
+  EXPECT_FALSE(transport.post(R"({"method":"eth_blockNumber"})", response));
+  // the requests of the event loop time out as well
+  EXPECT_FALSE(transport.post_async(R"({"method":"eth_blockNumber"})")
+                   .get()
+                   .ok);
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(10));
+  close(listen_fd);
+}
+
+TEST(EthereumAdapterTests /*unused*/, HttpTransportManyInFlight /*unused*/) {
+  MockNode node(false);
+  node.set_head(9);
+  HttpTransport transport(node.url());
+  // more requests than the event loop keeps in flight, the rest is queued
+  std::vector<std::string> bodies(200, R"({"method":"eth_getBlockByNumber"})");
+  std::vector<HTTP_RESPONSE> responses = transport.post_all(bodies);
+  ASSERT_EQ(responses.size(), bodies.size());
+  for (const auto &response : responses) {
+    EXPECT_TRUE(response.ok);
+    EXPECT_NE(response.body.find(R"("number":"0x9")"), std::string::npos);
+  }
+}
+
+TEST(EthereumAdapterTests /*unused*/, HttpTransportStopFailsRequests
+     /*unused*/) {
+  std::string url;
+  int listen_fd = silent_node(url);
+  std::vector<std::future<HTTP_RESPONSE>> responses;
+  auto begin = std::chrono::steady_clock::now();
+  {
+    HttpTransport transport(url);
+    for (int i = 0; i < 3; i++) {
+      responses.push_back(transport.post_async("{}"));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  // the requests in flight fail when the transport is destroyed, without
+  // waiting for the timeout
+  for (auto &response : responses) {
+    EXPECT_FALSE(response.get().ok);
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(10));
+  close(listen_fd);
+}
+
+/**********************************************
+ *  JSON-RPC batches, against a stubbed transport
+ ***********************************************/
+
+/**
+ * @brief Transport that answers the JSON-RPC calls itself. The result of a
+ * call is its method, the calls of failing_methods get an error. A batch is
+ * answered in reverse order, like a node may do.
+ *
+ */
+class StubTransport : public HttpTransport {
+ public:
+  StubTransport() : HttpTransport("http://127.0.0.1:1") {}
+
+  auto post_all(const std::vector<std::string> &bodies)
+      -> std::vector<HTTP_RESPONSE> override {
+    std::vector<HTTP_RESPONSE> responses;
+    for (const auto &body : bodies) {
+      payloads.push_back(body);
+      if (failing_payloads.count(payloads.size() - 1) != 0) {
+        responses.emplace_back();
+        continue;
+      }
+      auto json = nlohmann::json::parse(body);
+      if (json.is_object()) {
+        responses.push_back({true, answer(json).dump()});
+        continue;
+      }
+      nlohmann::json batch = nlohmann::json::array();
+      for (auto call = json.rbegin(); call != json.rend(); ++call) {
+        batch.push_back(answer(*call));
+      }
+      responses.push_back({true, batch.dump()});
+    }
+    return responses;
+  }
+
+  // the posted documents
+  std::vector<std::string> payloads;
+  // indexes of the documents that get no response
+  std::set<size_t> failing_payloads;
+  std::set<std::string> failing_methods;
+
+ private:
+  auto answer(const nlohmann::json &call) -> nlohmann::json {
+    nlohmann::json response = {{"jsonrpc", "2.0"}, {"id", call["id"]}};
+    if (failing_methods.count(call["method"]) != 0) {
+      response["error"] = {{"code", -32000}, {"message", "failed"}};
+    } else {
+      response["result"] = call["method"];
+    }
+    return response;
+  }
+};
+
+// Gets the result of a response, empty if it has none
+static auto rpc_result(const std::string &response) -> std::string {
+  if (response.empty()) {
+    return "";
+  }
+  auto json = nlohmann::json::parse(response);
+  return json.contains("result") ? json["result"].get<std::string>() : "";
+}
+
+TEST(EthereumAdapterTests /*unused*/, JsonRpcBatchSplitsBySize /*unused*/) {
+  StubTransport transport;
+  std::vector<JSON_RPC_CALL> calls;
+  for (int i = 0; i < 10; i++) {
+    calls.push_back({"method" + std::to_string(i), R"("0x1")"});
+  }
+  // a request is about 60 bytes, so three fit into a batch
+  std::vector<std::string> responses =
+      post_json_rpc_batch(transport, calls, 200);
+  ASSERT_EQ(transport.payloads.size(), 4);
+  for (const auto &payload : transport.payloads) {
+    EXPECT_LE(payload.size(), 200);
+  }
+  // the last call is sent as plain request
+  EXPECT_TRUE(nlohmann::json::parse(transport.payloads[0]).is_array());
+  EXPECT_TRUE(nlohmann::json::parse(transport.payloads[3]).is_object());
+  ASSERT_EQ(responses.size(), calls.size());
+  for (size_t i = 0; i < calls.size(); i++) {
+    EXPECT_EQ(rpc_result(responses[i]), calls[i].method);
+  }
+
+  // 0 sends every call on its own
+  transport.payloads.clear();
+  responses = post_json_rpc_batch(transport, calls, 0);
+  EXPECT_EQ(transport.payloads.size(), calls.size());
+  EXPECT_EQ(rpc_result(responses[9]), "method9");
+}
+
+TEST(EthereumAdapterTests /*unused*/, JsonRpcBatchMatchesIds /*unused*/) {
+  StubTransport transport;
+  std::vector<JSON_RPC_CALL> calls = {
+      {"eth_call", ""}, {"eth_getBalance", ""}, {"eth_blockNumber", ""}};
+  std::vector<std::string> responses =
+      post_json_rpc_batch(transport, calls, 1024);
+  // the batch is answered in reverse order
+  ASSERT_EQ(transport.payloads.size(), 1);
+  ASSERT_EQ(responses.size(), 3);
+  EXPECT_EQ(rpc_result(responses[0]), "eth_call");
+  EXPECT_EQ(rpc_result(responses[1]), "eth_getBalance");
+  EXPECT_EQ(rpc_result(responses[2]), "eth_blockNumber");
+}
+
+TEST(EthereumAdapterTests /*unused*/, JsonRpcBatchItemErrors /*unused*/) {
+  StubTransport transport;
+  transport.failing_methods = {"fail"};
+  std::vector<JSON_RPC_CALL> calls = {
+      {"ok1", ""}, {"fail", ""}, {"ok2", ""}, {"ok3", ""}};
+  std::vector<std::string> responses =
+      post_json_rpc_batch(transport, calls, 1024);
+  ASSERT_EQ(responses.size(), 4);
+  // a failed call keeps its error, the other calls of the batch succeed
+  ASSERT_FALSE(responses[1].empty());
+  EXPECT_TRUE(nlohmann::json::parse(responses[1]).contains("error"));
+  EXPECT_EQ(rpc_result(responses[0]), "ok1");
+  EXPECT_EQ(rpc_result(responses[2]), "ok2");
+
+  // the calls of a batch without response are empty
+  transport.payloads.clear();
+  transport.failing_payloads = {0};
+  responses = post_json_rpc_batch(transport, calls, 130);
+  ASSERT_EQ(transport.payloads.size(), 2);
+  EXPECT_TRUE(responses[0].empty());
+  EXPECT_TRUE(responses[1].empty());
+  EXPECT_EQ(rpc_result(responses[2]), "ok2");
+  EXPECT_EQ(rpc_result(responses[3]), "ok3");
+}
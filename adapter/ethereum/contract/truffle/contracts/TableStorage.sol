@@ -13,13 +13,33 @@ contract SimpleStorage {
 
     mapping(bytes32 => Value) private data;        // data store
     bytes32[] internal keyList;                    // list of keys
+    mapping(bytes32 => uint) private keyIndex;     // position of a key in keyList plus one
+
+    // emitted by putIfAbsent for every key that is already stored
+    event KeyExists(bytes32 key);
+
+    function addKey(bytes32 key) internal {
+        keyList.push(key);
+        keyIndex[key] = keyList.length;
+    }
+
+    // remove from keyList: swap with last element, then call pop()
+    function removeKey(bytes32 key) internal {
+        uint index = keyIndex[key] - 1;
+        bytes32 last = keyList[keyList.length - 1];
+
+        keyList[index] = last;
+        keyIndex[last] = index + 1;
+        keyList.pop();
+        delete keyIndex[key];
+    }
 
     function put(bytes32 key, string memory value) public {
 
         Value memory v = Value(block.number,value);
 
         if(data[key].blocknumber == 0) {
-            keyList.push(key);
+            addKey(key);
         }
 
         // persist data in blockchain
@@ -37,6 +57,21 @@ contract SimpleStorage {
         return (value);
     }
 
+    function getBatch(bytes32[] memory keys) public view returns (bool[] memory found, string[] memory values)
+    {
+        found = new bool[](keys.length);
+        values = new string[](keys.length);
+
+        // missing keys are reported instead of reverting the whole call
+        for (uint i = 0; i < keys.length; i++) {
+            Value memory v = data[keys[i]];
+            found[i] = v.blocknumber > 0;
+            values[i] = v.value;
+        }
+
+        return (found, values);
+    }
+
     function tableScan() public view returns (bytes32[] memory keys, string memory values)
     {
         string memory tmp;
@@ -59,22 +94,43 @@ contract SimpleStorage {
         // check if key exists
         require(v.blocknumber > 0);
 
-        // remove from keyList: find index, then swap with last element, then call pop()
-        uint size = keyList.length;
-        uint index = type(uint256).max;
+        removeKey(key);
 
-        for(uint i=0; i<size; i++) {
-            if(keyList[i] == key) {
-                index = i;
-                break;
+        // delete from data
+        delete data[key];
+    }
+
+    function removeBatch(bytes32[] memory keys) public {
+        for (uint i = 0; i < keys.length; i++) {
+
+            // keys that are not stored are skipped instead of reverting the batch
+            if(data[keys[i]].blocknumber == 0) {
+                continue;
             }
+
+            removeKey(keys[i]);
+            delete data[keys[i]];
         }
+    }
 
-        keyList[index] = keyList[size - 1]; // move last element to position of key to delete
-        keyList.pop();
+    // applies puts and removes in their order, removes of missing keys are skipped
+    function applyBatch(bytes32[] memory keys, string[] memory values, bool[] memory removes) public {
+        for (uint i = 0; i < keys.length; i++) {
 
-        // delete from data
-        delete data[key];
+            if(removes[i]) {
+                if(data[keys[i]].blocknumber != 0) {
+                    removeKey(keys[i]);
+                    delete data[keys[i]];
+                }
+                continue;
+            }
+
+            if(data[keys[i]].blocknumber == 0) {
+                addKey(keys[i]);
+            }
+
+            data[keys[i]] = Value(block.number,values[i]);
+        }
     }
 
     function putBatch(bytes32[] memory keys, string[] memory values) public {        
@@ -82,10 +138,24 @@ contract SimpleStorage {
             Value memory v = Value(block.number,values[i]);
 
             if(data[keys[i]].blocknumber == 0) {
-                keyList.push(keys[i]);
+                addKey(keys[i]);
             }
 
             data[keys[i]] = v;
         }
     }
+
+    function putIfAbsent(bytes32[] memory keys, string[] memory values) public {
+        for (uint i = 0; i < keys.length; i++) {
+
+            // keep existing values, the caller is informed by the event
+            if(data[keys[i]].blocknumber != 0) {
+                emit KeyExists(keys[i]);
+                continue;
+            }
+
+            addKey(keys[i]);
+            data[keys[i]] = Value(block.number,values[i]);
+        }
+    }
 }
@@ -13,11 +13,22 @@ const web3 = new Web3(myArgs[4]);
 const contractFile = JSON.parse(fs.readFileSync(COMPILED_CONTRACT, "utf-8"));
 const contract = new web3.eth.Contract(contractFile.abi);
 
-contract.deploy({data: contractFile.bytecode}).send({from: FROM_ACCOUNT, gas: 2000000}).then((newContract) => {
+const deployment = contract.deploy({data: contractFile.bytecode});
+
+// the gas of the deployment grows with the contract, so it is estimated
+// instead of using a fixed limit, with a margin for the estimate
+Promise.all([deployment.estimateGas({from: FROM_ACCOUNT}), web3.eth.getBlock("latest")]).then(([gas, block]) => {
+    if(gas > block.gasLimit) {
+        throw new Error("the contract needs " + gas + " gas, the block gas limit is " + block.gasLimit);
+    }
+    return deployment.send({from: FROM_ACCOUNT, gas: Math.min(Math.ceil(gas * 1.2), block.gasLimit)});
+}).then((newContract) => {
     const address = newContract.options.address;
     if(address) {
         console.log(address);
     } else {
         console.error("Deployment failed!");
     }
+}).catch((error) => {
+    console.error("Deployment failed! " + error.message);
 });
@@ -2,6 +2,8 @@
 #define ADAPTER_INTERFACE_H
 
 #include <boost/property_tree/ptree.hpp>
+#include <chrono>
+#include <functional>
 #include <iomanip>
 #include <string>
 #include <vector>
@@ -143,6 +145,49 @@ inline auto operator<(const BYTES &lhs, const BYTES &rhs) -> bool {
   return false;
 }
 
+/**
+ * @brief Struct that stores one operation of a batch of puts and removes.
+ *
+ * @param key Key of the pair
+ * @param value Value of the pair, ignored for removes
+ * @param remove True to remove the key, false to put the value
+ *
+ */
+struct BATCH_OPERATION {
+  BYTES key;
+  BYTES value;
+  bool remove;
+};
+
+/**
+ * @brief Struct that stores a transaction that was sent without waiting until
+ * it is mined.
+ *
+ * @param id ID (hash) of the transaction
+ * @param nonce Nonce of the transaction, 0 if the blockchain has no nonces
+ *
+ */
+struct PENDING_TRANSACTION {
+  std::string id;
+  uint64_t nonce;
+};
+
+/**
+ * @brief Struct that selects how a write call treats its transactions and
+ * collects the ones it did not wait for. It belongs to the caller, so
+ * sessions that share an adapter do not see each other's transactions.
+ *
+ * @param wait_for_mining Wait until the transactions are mined (default).
+ * If false, the call returns as soon as the node accepted them.
+ * @param pending_transactions Transactions sent without waiting, they are
+ * appended by the call
+ *
+ */
+struct WRITE_CONTEXT {
+  bool wait_for_mining = true;
+  std::vector<PENDING_TRANSACTION> pending_transactions;
+};
+
 /**
  * @brief Interface definition to be used by storage engine to communicate with
  * concrete blockchain technology adapter, like Ethereum, Fabric, ...
@@ -192,10 +237,47 @@ class BcAdapter {
    * @param batch Batch including multiple key-value pairs; succesfully inserted
    * key-value pairs are removed from the batch
    *
+   * @param context How to wait for the transactions, nullptr to wait until
+   * they are mined
+   *
+   * @return status code (0 on success, 1 on failure batch contains remaining
+   * key-value pairs)
+   */
+  virtual auto put(std::map<const BYTES, const BYTES> &batch,
+                   WRITE_CONTEXT *context = nullptr) -> int = 0;
+
+  /**
+   * @brief Put a large batch of key-value pairs into the blockchain with as
+   * few transactions as possible, e.g. for bulk loads
+   *
+   * @param batch Batch including multiple key-value pairs; succesfully inserted
+   * key-value pairs are removed from the batch
+   *
+   * @param context How to wait for the transactions, nullptr to wait until
+   * they are mined
+   *
    * @return status code (0 on success, 1 on failure batch contains remaining
    * key-value pairs)
    */
-  virtual auto put(std::map<const BYTES, const BYTES> &batch) -> int = 0;
+  virtual auto put_batch(std::map<const BYTES, const BYTES> &batch,
+                         WRITE_CONTEXT *context = nullptr) -> int = 0;
+
+  /**
+   * @brief Put a batch of key-value pairs into the blockchain, but only the
+   * pairs whose key is not stored yet. Existing pairs keep their value. The
+   * call always waits until its transactions are mined, since its result
+   * depends on them.
+   *
+   * @param batch Batch including multiple key-value pairs; processed pairs may
+   * be removed from the batch
+   * @param existing_keys Reference to store the keys of the batch that were
+   * already stored and therefore not written
+   *
+   * @return status code (0 on success, also if some keys existed; 1 on failure
+   * batch contains remaining key-value pairs)
+   */
+  virtual auto put_if_absent(std::map<const BYTES, const BYTES> &batch,
+                             std::vector<BYTES> &existing_keys) -> int = 0;
 
   /**
    * @brief Get a value of a key-value pair from the blockchain
@@ -207,6 +289,20 @@ class BcAdapter {
    */
   virtual auto get(const BYTES &key, BYTES &result) -> int = 0;
 
+  /**
+   * @brief Get the values of multiple keys from the blockchain with a single
+   * request
+   *
+   * @param keys Keys of the pairs
+   * @param results Reference to store the read pairs; keys that do not exist
+   * are not added
+   *
+   * @return status code (0 on success, also if some keys do not exist; 1 on
+   * failure)
+   */
+  virtual auto get_batch(const std::vector<BYTES> &keys,
+                         std::map<const BYTES, BYTES> &results) -> int = 0;
+
   /**
    * @brief Gets all key-value pairs from the blockchain
    *
@@ -220,10 +316,109 @@ class BcAdapter {
    * @brief Remove a key value pair from the blockchain
    *
    * @param key Key of the pair
+   * @param context How to wait for the transaction, nullptr to wait until it
+   * is mined
    *
    * @return status code (0 on success, 1 on failure)
    */
-  virtual auto remove(const BYTES &key) -> int = 0;
+  virtual auto remove(const BYTES &key, WRITE_CONTEXT *context = nullptr)
+      -> int = 0;
+
+  /**
+   * @brief Remove multiple key value pairs from the blockchain with as few
+   * transactions as possible. Keys that do not exist are skipped.
+   *
+   * @param keys Keys of the pairs
+   * @param context How to wait for the transactions, nullptr to wait until
+   * they are mined
+   *
+   * @return status code (0 on success, 1 on failure)
+   */
+  virtual auto remove_batch(const std::vector<BYTES> &keys,
+                            WRITE_CONTEXT *context = nullptr) -> int = 0;
+
+  /**
+   * @brief Apply puts and removes in their order with as few transactions as
+   * possible. Removes of keys that do not exist are skipped.
+   *
+   * @param operations The operations
+   * @param context How to wait for the transactions, nullptr to wait until
+   * they are mined
+   *
+   * @return status code (0 on success, 1 on failure)
+   */
+  virtual auto apply_batch(const std::vector<BATCH_OPERATION> &operations,
+                           WRITE_CONTEXT *context = nullptr) -> int = 0;
+
+  /**
+   * @brief Get the number of the most recent block of the blockchain. It is
+   * used to decide whether a previously read table is still up to date.
+   *
+   * @param block_number Reference to store the block number
+   *
+   * @return status code (0 on success, 1 on failure)
+   */
+  virtual auto get_block_number(uint64_t &block_number) -> int = 0;
+
+  /**
+   * @brief Get the number of the most recent block without a request to the
+   * blockchain. Adapters that are notified of new blocks know it, the others
+   * do not.
+   *
+   * @param block_number Reference to store the block number
+   *
+   * @return True if the block number is known, otherwise get_block_number
+   * has to be used
+   */
+  virtual auto get_live_block_number(uint64_t & /*block_number*/) -> bool {
+    return false;
+  }
+
+  /**
+   * @brief Get the state of a transaction that was sent without waiting
+   *
+   * @param transaction_id ID of the transaction
+   *
+   * @return status code (0 if mined successfully, 1 if failed, 2 if not mined
+   * yet)
+   */
+  virtual auto get_transaction_status(const std::string &transaction_id)
+      -> int = 0;
+
+  /**
+   * @brief Get the states of several transactions that were sent without
+   * waiting
+   *
+   * @param transaction_ids IDs of the transactions
+   *
+   * @return status code of every transaction, like get_transaction_status
+   */
+  virtual auto get_transaction_statuses(
+      const std::vector<std::string> &transaction_ids) -> std::vector<int> {
+    std::vector<int> statuses;
+    statuses.reserve(transaction_ids.size());
+    for (const auto &transaction_id : transaction_ids) {
+      statuses.push_back(get_transaction_status(transaction_id));
+    }
+    return statuses;
+  }
+
+  /**
+   * @brief Watch transactions that were sent without waiting until they are
+   * mined, without blocking the caller
+   *
+   * @param transaction_ids IDs of the transactions
+   * @param timeout Time after which a transaction that is not mined is
+   * reported
+   * @param finished Called once per transaction, from a thread of the adapter,
+   * with its ID and status code (0 if mined successfully, 1 if failed, 2 if
+   * not mined in time)
+   */
+  virtual void watch_transactions(
+      const std::vector<std::string> &transaction_ids,
+      std::chrono::milliseconds timeout,
+      const std::function<void(const std::string &, int)> &finished) = 0;
+
   /**
    * @brief Create a table (contract) in the blockchain
    *
@@ -98,6 +98,69 @@ TEST_P(AdapterInterfaceTest /*unused*/, RemoveMissingEntry /*unused*/) {
             << std::endl;
 }
 
+/**********************************************
+ *  Tests for the remove_batch(const std::vector<BYTES> &keys) method
+ ***********************************************/
+
+/**
+ * @brief Test that existing keys are removed and that missing keys are skipped
+ *
+ */
+// NOLINTNEXTLINE(modernize-use-trailing-return-type)
+TEST_P(AdapterInterfaceTest /*unused*/, RemoveBatch /*unused*/) {
+  EXPECT_EQ(adapter_->remove_batch({keys_[0], keys_[1], keys_[3]}), 0);
+  EXPECT_EQ(adapter_->get(keys_[0], result_), 1);
+  EXPECT_EQ(adapter_->get(keys_[1], result_), 1);
+  EXPECT_EQ(adapter_->get(keys_[2], result_), 0);
+  EXPECT_EQ(result_, values_[2]);
+}
+
+/**********************************************
+ *  Tests for the apply_batch(const std::vector<BATCH_OPERATION> &operations)
+ *  method
+ ***********************************************/
+
+/**
+ * @brief Test that puts and removes are applied in their order
+ *
+ */
+// NOLINTNEXTLINE(modernize-use-trailing-return-type)
+TEST_P(AdapterInterfaceTest /*unused*/, ApplyBatch /*unused*/) {
+  std::vector<BATCH_OPERATION> operations = {
+      {keys_[0], values_[0], true},
+      {keys_[1], values_[3], false},
+      {keys_[3], values_[3], false},
+      {keys_[3], values_[3], true},
+      {batch_keys_[0], batch_values_[0], false}};
+  EXPECT_EQ(adapter_->apply_batch(operations), 0);
+  EXPECT_EQ(adapter_->get(keys_[0], result_), 1);
+  EXPECT_EQ(adapter_->get(keys_[1], result_), 0);
+  EXPECT_EQ(result_, values_[3]);
+  EXPECT_EQ(adapter_->get(keys_[3], result_), 1);
+  EXPECT_EQ(adapter_->get(batch_keys_[0], result_), 0);
+  EXPECT_EQ(result_, batch_values_[0]);
+}
+
+/**********************************************
+ *  Tests for the get_batch(const std::vector<BYTES> &keys,
+ *  std::map<const BYTES, BYTES> &results) method
+ ***********************************************/
+
+/**
+ * @brief Test that existing keys are returned with their values and that
+ * missing keys are left out
+ *
+ */
+// NOLINTNEXTLINE(modernize-use-trailing-return-type)
+TEST_P(AdapterInterfaceTest /*unused*/, GetBatch /*unused*/) {
+  std::vector<BYTES> keys = {keys_[0], keys_[3], keys_[2]};
+  EXPECT_EQ(adapter_->get_batch(keys, result_map_), 0);
+  ASSERT_EQ(result_map_.size(), 2);
+  EXPECT_EQ(result_map_.at(keys_[0]), values_[0]);
+  EXPECT_EQ(result_map_.at(keys_[2]), values_[2]);
+  EXPECT_EQ(result_map_.count(keys_[3]), 0);
+}
+
 /**
  * @brief Test that removing from a non-existing (dropped) table results in the
  * expected return code
@@ -145,3 +208,93 @@ TEST_P(AdapterInterfaceTest /*unused*/, TableScanAfterDrop /*unused*/) {
       << "\nTableScanAfterDrop: \" GET_ALL, Failed to open File \" expect!! \n"
       << std::endl;
 }
+
+/**********************************************
+ *  Tests for the get_block_number(uint64_t &block_number) method
+ ***********************************************/
+
+/**
+ * @brief Test that the block number grows when a new entry is written
+ *
+ */
+// NOLINTNEXTLINE(modernize-use-trailing-return-type)
+TEST_P(AdapterInterfaceTest /*unused*/, BlockNumberAfterPut /*unused*/) {
+  uint64_t block_before = 0;
+  uint64_t block_after = 0;
+  EXPECT_EQ(adapter_->get_block_number(block_before), 0);
+  EXPECT_EQ(adapter_->put(batch_), 0);
+  EXPECT_EQ(adapter_->get_block_number(block_after), 0);
+  EXPECT_GT(block_after, block_before);
+}
+
+/**********************************************
+ *  Tests for the put_batch(std::map<const BYTES, const BYTES> &batch) method
+ ***********************************************/
+
+/**
+ * @brief Test that all pairs of a batch are written and removed from the batch
+ *
+ */
+// NOLINTNEXTLINE(modernize-use-trailing-return-type)
+TEST_P(AdapterInterfaceTest /*unused*/, PutBatch /*unused*/) {
+  std::map<const BYTES, const BYTES> batch = batch_;
+  EXPECT_EQ(adapter_->put_batch(batch), 0);
+  EXPECT_TRUE(batch.empty());
+  for (size_t i = 0; i < batch_keys_.size(); i++) {
+    EXPECT_EQ(adapter_->get(batch_keys_[i], result_), 0);
+    EXPECT_EQ(result_, batch_values_[i]);
+  }
+}
+
+/**********************************************
+ *  Tests for the put_if_absent(std::map<const BYTES, const BYTES> &batch,
+ *  std::vector<BYTES> &existing_keys) method
+ ***********************************************/
+
+/**
+ * @brief Test that only missing keys are inserted and that existing keys are
+ * reported without changing their value
+ *
+ */
+// NOLINTNEXTLINE(modernize-use-trailing-return-type)
+TEST_P(AdapterInterfaceTest /*unused*/, PutIfAbsent /*unused*/) {
+  std::map<const BYTES, const BYTES> batch = {{keys_[0], values_[3]},
+                                              {keys_[3], values_[3]}};
+  std::vector<BYTES> existing_keys;
+  EXPECT_EQ(adapter_->put_if_absent(batch, existing_keys), 0);
+  ASSERT_EQ(existing_keys.size(), 1);
+  EXPECT_EQ(existing_keys[0], keys_[0]);
+  EXPECT_EQ(adapter_->get(keys_[0], result_), 0);
+  EXPECT_EQ(result_, values_[0]);
+  EXPECT_EQ(adapter_->get(keys_[3], result_), 0);
+  EXPECT_EQ(result_, values_[3]);
+}
+
+/**
+ * @brief Test that a batch that needs several transactions is inserted
+ * completely and that existing keys of all of them are reported
+ *
+ */
+// NOLINTNEXTLINE(modernize-use-trailing-return-type)
+TEST_P(AdapterInterfaceTest /*unused*/, PutIfAbsentLargeBatch /*unused*/) {
+  std::map<const BYTES, const BYTES> batch = {{keys_[0], values_[3]}};
+  for (int i = 0; i < 200; i++) {
+    batch.emplace(BYTES("large_batch_key" + std::to_string(i)),
+                  BYTES("large_batch_value" + std::to_string(i)));
+  }
+  const size_t batch_size = batch.size();
+  std::vector<BYTES> existing_keys;
+  EXPECT_EQ(adapter_->put_if_absent(batch, existing_keys), 0);
+  EXPECT_TRUE(batch.empty());
+  ASSERT_EQ(existing_keys.size(), 1);
+  EXPECT_EQ(existing_keys[0], keys_[0]);
+  EXPECT_EQ(adapter_->get(keys_[0], result_), 0);
+  EXPECT_EQ(result_, values_[0]);
+  std::vector<BYTES> keys;
+  for (int i = 0; i < 200; i++) {
+    keys.emplace_back("large_batch_key" + std::to_string(i));
+  }
+  std::map<const BYTES, BYTES> results;
+  EXPECT_EQ(adapter_->get_batch(keys, results), 0);
+  EXPECT_EQ(results.size(), batch_size - 1);
+}
@@ -0,0 +1,188 @@
+#ifndef HTTP_TRANSPORT_H
+#define HTTP_TRANSPORT_H
+
+#include <curl/curl.h>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Struct that stores the result of a request.
+ *
+ * @param ok True if a response was received
+ * @param body Body of the response
+ */
+struct HTTP_RESPONSE {
+  bool ok = false;
+  std::string body;
+};
+
+/**
+ * @brief Struct that stores the timeouts of the requests of a transport, in
+ * seconds.
+ *
+ * @param connect Maximum time to connect to the endpoint
+ * @param request Maximum time of a request, including the connect, so a node
+ * that stops answering fails the request instead of blocking it
+ */
+struct HTTP_TIMEOUTS {
+  static constexpr long kDefaultConnect = 10;
+  static constexpr long kDefaultRequest = 60;
+
+  long connect = kDefaultConnect;
+  long request = kDefaultRequest;
+
+  auto operator==(const HTTP_TIMEOUTS &other) const -> bool {
+    return connect == other.connect && request == other.request;
+  }
+};
+
+/**
+ * @brief HTTP transport to a blockchain node that all adapters connected to
+ * the node share. Requests borrow an easy handle from a pool, so concurrent
+ * requests do not wait for each other and idle connections are reused instead
+ * of every adapter holding its own. The handles share the DNS cache, TLS
+ * sessions and connections.
+ *
+ * Requests posted asynchronously are sent by an event loop on a curl multi
+ * handle, which keeps up to kMaxInFlight of them in flight at once. The loop
+ * is started by the first asynchronous request.
+ *
+ */
+class HttpTransport {
+ public:
+  /**
+   * @brief Gets the transport of an endpoint, it is created if no adapter
+   * uses the endpoint with these timeouts yet
+   *
+   * @param url URL of the endpoint
+   * @param timeouts Timeouts of the requests
+   * @return The transport
+   */
+  static auto get(const std::string &url,
+                  const HTTP_TIMEOUTS &timeouts = HTTP_TIMEOUTS())
+      -> std::shared_ptr<HttpTransport>;
+
+  explicit HttpTransport(std::string url,
+                         const HTTP_TIMEOUTS &timeouts = HTTP_TIMEOUTS());
+  virtual ~HttpTransport();
+
+  HttpTransport(const HttpTransport &) = delete;
+  auto operator=(const HttpTransport &) -> HttpTransport & = delete;
+
+  /**
+   * @brief Posts a JSON document to the endpoint
+   *
+   * @param body The JSON document
+   * @param[out] response Body of the response
+   * @return True if a response was received
+   */
+  auto post(const std::string &body, std::string &response) -> bool;
+
+  /**
+   * @brief Posts a JSON document without waiting for the response
+   *
+   * @param body The JSON document
+   * @return Future of the response
+   */
+  auto post_async(std::string body) -> std::future<HTTP_RESPONSE>;
+
+  /**
+   * @brief Posts JSON documents concurrently and waits for all responses.
+   * Virtual, so unit tests can answer the documents without a node.
+   *
+   * @param bodies The JSON documents
+   * @return The responses, in the order of the documents
+   */
+  virtual auto post_all(const std::vector<std::string> &bodies)
+      -> std::vector<HTTP_RESPONSE>;
+
+  /**
+   * @brief Gets the URL of the endpoint
+   */
+  auto url() const -> const std::string & { return url_; }
+
+  /**
+   * @brief Gets the timeouts of the requests
+   */
+  auto timeouts() const -> const HTTP_TIMEOUTS & { return timeouts_; }
+
+ private:
+  // Number of idle handles that are kept for reuse
+  static constexpr size_t kMaxIdleHandles = 64;
+  // Number of asynchronous requests that are sent at once, more are queued
+  static constexpr size_t kMaxInFlight = 64;
+  // Number of connections the event loop opens to the endpoint
+  static constexpr long kMaxConnections = 16;
+  // Time the event loop waits for network activity before it checks for
+  // new requests
+  static constexpr int kPollTimeoutMs = 1000;
+
+  /**
+   * @brief Struct that stores an easy handle of the pool.
+   *
+   * @param curl The handle, configured for the endpoint
+   * @param response Buffer of the response, its memory is reused
+   */
+  struct HANDLE {
+    CURL *curl;
+    std::string response;
+  };
+
+  /**
+   * @brief Struct that stores an asynchronous request.
+   *
+   * @param body The JSON document, it has to live until the request is sent
+   * @param promise Promise of the response
+   * @param handle Handle that sends the request
+   */
+  struct REQUEST {
+    std::string body;
+    std::promise<HTTP_RESPONSE> promise;
+    std::unique_ptr<HANDLE> handle;
+  };
+
+  /**
+   * @brief Event loop that sends the asynchronous requests
+   */
+  void run();
+
+  /**
+   * @brief Takes an idle handle or creates a new one
+   */
+  auto borrow() -> std::unique_ptr<HANDLE>;
+
+  /**
+   * @brief Returns a handle to the pool
+   */
+  void give_back(std::unique_ptr<HANDLE> handle);
+
+  static void lock_share(CURL *curl, curl_lock_data data,
+                         curl_lock_access access, void *userptr);
+  static void unlock_share(CURL *curl, curl_lock_data data, void *userptr);
+  static auto write_callback(char *contents, size_t size, size_t nmemb,
+                             void *userp) -> size_t;
+
+  std::string url_;
+  HTTP_TIMEOUTS timeouts_;
+  CURLSH *share_;
+  // one mutex per kind of data of the share
+  std::mutex share_mutexes_[CURL_LOCK_DATA_LAST];
+  struct curl_slist *headers_;
+  std::mutex pool_mutex_;
+  std::vector<std::unique_ptr<HANDLE>> idle_;
+
+  CURLM *multi_;
+  std::thread loop_;
+  // protects queue_, stopping_ and the start of loop_
+  std::mutex queue_mutex_;
+  std::deque<std::unique_ptr<REQUEST>> queue_;
+  bool stopping_ = false;
+};
+
+#endif  // HTTP_TRANSPORT_H
@@ -0,0 +1,233 @@
+#include "adapter_utils/http_transport.h"
+
+#include <boost/log/trivial.hpp>
+#include <unordered_map>
+
+auto HttpTransport::get(const std::string &url, const HTTP_TIMEOUTS &timeouts)
+    -> std::shared_ptr<HttpTransport> {
+  static std::mutex mutex;
+  // transports are freed when the last adapter of the endpoint is, adapters
+  // with other timeouts get a transport of their own
+  static std::unordered_map<std::string, std::weak_ptr<HttpTransport>>
+      transports;
+
+  const std::string key = url + " " + std::to_string(timeouts.connect) + " " +
+                          std::to_string(timeouts.request);
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<HttpTransport> transport = transports[key].lock();
+  if (transport == nullptr) {
+    transport = std::make_shared<HttpTransport>(url, timeouts);
+    transports[key] = transport;
+  }
+  return transport;
+}
+
+HttpTransport::HttpTransport(std::string url, const HTTP_TIMEOUTS &timeouts)
+    : url_(std::move(url)), timeouts_(timeouts) {
+  share_ = curl_share_init();
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lock_share);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlock_share);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+  headers_ = curl_slist_append(nullptr, "Content-Type: application/json");
+
+  multi_ = curl_multi_init();
+  curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, kMaxConnections);
+}
+
+HttpTransport::~HttpTransport() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stopping_ = true;
+  }
+  curl_multi_wakeup(multi_);
+  if (loop_.joinable()) {
+    loop_.join();
+  }
+  curl_multi_cleanup(multi_);
+  // the handles have to be cleaned up before the share they use
+  for (auto &handle : idle_) {
+    curl_easy_cleanup(handle->curl);
+  }
+  idle_.clear();
+  curl_share_cleanup(share_);
+  curl_slist_free_all(headers_);
+}
+
+auto HttpTransport::post(const std::string &body, std::string &response)
+    -> bool {
+  std::unique_ptr<HANDLE> handle = borrow();
+  if (handle == nullptr) {
+    return false;
+  }
+  handle->response.clear();
+  curl_easy_setopt(handle->curl, CURLOPT_POSTFIELDS, body.c_str());
+  curl_easy_setopt(handle->curl, CURLOPT_POSTFIELDSIZE,
+                   static_cast<long>(body.size()));
+  CURLcode res = curl_easy_perform(handle->curl);
+  if (res != CURLE_OK) {
+    BOOST_LOG_TRIVIAL(debug) << "HttpTransport: Post, CURL perform() returned "
+                                "an error: "
+                             << curl_easy_strerror(res);
+  }
+  // the buffer keeps its memory for the next request of the handle
+  response.assign(handle->response);
+  give_back(std::move(handle));
+  return res == CURLE_OK;
+}
+
+auto HttpTransport::post_async(std::string body)
+    -> std::future<HTTP_RESPONSE> {
+  auto request = std::make_unique<REQUEST>();
+  request->body = std::move(body);
+  std::future<HTTP_RESPONSE> response = request->promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (stopping_) {
+      request->promise.set_value(HTTP_RESPONSE());
+      return response;
+    }
+    queue_.push_back(std::move(request));
+    if (!loop_.joinable()) {
+      loop_ = std::thread(&HttpTransport::run, this);
+    }
+  }
+  curl_multi_wakeup(multi_);
+  return response;
+}
+
+auto HttpTransport::post_all(const std::vector<std::string> &bodies)
+    -> std::vector<HTTP_RESPONSE> {
+  std::vector<std::future<HTTP_RESPONSE>> futures;
+  futures.reserve(bodies.size());
+  for (const auto &body : bodies) {
+    futures.push_back(post_async(body));
+  }
+  std::vector<HTTP_RESPONSE> responses;
+  responses.reserve(bodies.size());
+  for (auto &future : futures) {
+    responses.push_back(future.get());
+  }
+  return responses;
+}
+
+void HttpTransport::run() {
+  std::unordered_map<CURL *, std::unique_ptr<REQUEST>> in_flight;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (stopping_) {
+        break;
+      }
+      while (!queue_.empty() && in_flight.size() < kMaxInFlight) {
+        std::unique_ptr<REQUEST> request = std::move(queue_.front());
+        queue_.pop_front();
+        request->handle = borrow();
+        if (request->handle == nullptr) {
+          request->promise.set_value(HTTP_RESPONSE());
+          continue;
+        }
+        CURL *curl = request->handle->curl;
+        request->handle->response.clear();
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE,
+                         static_cast<long>(request->body.size()));
+        curl_multi_add_handle(multi_, curl);
+        in_flight.emplace(curl, std::move(request));
+      }
+    }
+
+    int running = 0;
+    curl_multi_perform(multi_, &running);
+    int left = 0;
+    while (CURLMsg *msg = curl_multi_info_read(multi_, &left)) {
+      if (msg->msg != CURLMSG_DONE) {
+        continue;
+      }
+      CURL *curl = msg->easy_handle;
+      CURLcode res = msg->data.result;
+      curl_multi_remove_handle(multi_, curl);
+      auto it = in_flight.find(curl);
+      if (it == in_flight.end()) {
+        continue;
+      }
+      std::unique_ptr<REQUEST> request = std::move(it->second);
+      in_flight.erase(it);
+      if (res != CURLE_OK) {
+        BOOST_LOG_TRIVIAL(debug) << "HttpTransport: Run, request returned an "
+                                    "error: "
+                                 << curl_easy_strerror(res);
+      }
+      HTTP_RESPONSE response{res == CURLE_OK, request->handle->response};
+      give_back(std::move(request->handle));
+      request->promise.set_value(std::move(response));
+    }
+    curl_multi_poll(multi_, nullptr, 0, kPollTimeoutMs, nullptr);
+  }
+
+  // the transport is destroyed, unfinished requests fail
+  for (auto &entry : in_flight) {
+    curl_multi_remove_handle(multi_, entry.first);
+    give_back(std::move(entry.second->handle));
+    entry.second->promise.set_value(HTTP_RESPONSE());
+  }
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  for (auto &request : queue_) {
+    request->promise.set_value(HTTP_RESPONSE());
+  }
+  queue_.clear();
+}
+
+auto HttpTransport::borrow() -> std::unique_ptr<HANDLE> {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (!idle_.empty()) {
+      std::unique_ptr<HANDLE> handle = std::move(idle_.back());
+      idle_.pop_back();
+      return handle;
+    }
+  }
+
+  CURL *curl = curl_easy_init();
+  if (curl == nullptr) {
+    return nullptr;
+  }
+  auto handle = std::make_unique<HANDLE>(HANDLE{curl, std::string()});
+  curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+  curl_easy_setopt(curl, CURLOPT_URL, url_.c_str());
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, timeouts_.connect);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeouts_.request);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &handle->response);
+  return handle;
+}
+
+void HttpTransport::give_back(std::unique_ptr<HANDLE> handle) {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  if (idle_.size() < kMaxIdleHandles) {
+    idle_.push_back(std::move(handle));
+  } else {
+    curl_easy_cleanup(handle->curl);
+  }
+}
+
+void HttpTransport::lock_share(CURL *, curl_lock_data data, curl_lock_access,
+                               void *userptr) {
+  static_cast<HttpTransport *>(userptr)->share_mutexes_[data].lock();
+}
+
+void HttpTransport::unlock_share(CURL *, curl_lock_data data, void *userptr) {
+  static_cast<HttpTransport *>(userptr)->share_mutexes_[data].unlock();
+}
+
+auto HttpTransport::write_callback(char *contents, size_t size, size_t nmemb,
+                                   void *userp) -> size_t {
+  static_cast<std::string *>(userp)->append(contents, size * nmemb);
+  return size * nmemb;
+}
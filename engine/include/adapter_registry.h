@@ -0,0 +1,122 @@
+#ifndef BLOCKCHAIN_DB_ADAPTER_REGISTRY
+#define BLOCKCHAIN_DB_ADAPTER_REGISTRY
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "adapter_factory/adapter_factory.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Process-wide registry of the adapters of the bc-tables. A table has
+ * one adapter that is created and connected by the first handler that opens
+ * it and shared by all others. The registry counts the shares of open tables
+ * that use an adapter and removes the adapter when the last one is closed, so
+ * the connections of tables that are evicted from the table cache are not kept
+ * until the plugin is unloaded. It is also removed when its table is dropped
+ * or opened with another connection string.
+ *
+ * The tables are distributed over shards with a mutex each, so opening
+ * different tables does not contend. Adapters are created without holding the
+ * mutex, concurrent handlers of the same table wait for the first one.
+ *
+ */
+class AdapterRegistry {
+  public:
+    // Creates and connects the adapter of a table, nullptr on failure
+    using Factory = std::function<std::shared_ptr<BcAdapter>()>;
+
+    /**
+     * @brief Get the registry of the process
+     *
+     * @return The registry
+     */
+    static auto instance() -> AdapterRegistry &;
+
+    /**
+     * @brief Gets the adapter of a table for an open table and counts the
+     * use. The adapter is created if the table has none yet.
+     *
+     * @param tablename Table name in the format "./db_name/table_name"
+     * @param connection_string Connection string of the table, an adapter
+     * registered with another one is replaced
+     * @param factory Creates the adapter
+     * @return The adapter, nullptr if it can not be created
+     */
+    auto acquire(const std::string &tablename,
+                 const std::string &connection_string,
+                 const Factory &factory) -> std::shared_ptr<BcAdapter>;
+
+    /**
+     * @brief Ends a use of the adapter of a table that was counted by
+     * acquire. The adapter is removed after its last use.
+     *
+     * @param tablename Name of the table
+     * @param adapter The adapter returned by acquire, nothing is counted if
+     * the table has another adapter by now
+     */
+    void release(const std::string &tablename,
+                 const std::shared_ptr<BcAdapter> &adapter);
+
+    /**
+     * @brief Gets the adapter of a table without counting the use, e.g. to
+     * commit a transaction
+     *
+     * @param tablename Name of the table
+     * @return The adapter, nullptr if the table has none
+     */
+    auto find(const std::string &tablename) -> std::shared_ptr<BcAdapter>;
+
+    /**
+     * @brief Removes the adapter of a table, e.g. when the table is dropped.
+     * It is shut down when the last holder releases it.
+     *
+     * @param tablename Name of the table
+     */
+    void remove(const std::string &tablename);
+
+    /**
+     * @brief Removes all adapters
+     */
+    void clear();
+
+  private:
+    // Number of shards, a power of two
+    static constexpr size_t kShards = 16;
+
+    /**
+     * @brief Struct that stores the adapter of a table.
+     *
+     * @param connection_string Connection string the adapter was created with
+     * @param adapter The adapter, nullptr while it is created
+     * @param uses Number of uses counted by acquire
+     */
+    struct ENTRY {
+      std::string connection_string;
+      std::shared_ptr<BcAdapter> adapter;
+      size_t uses = 0;
+    };
+
+    struct SHARD {
+      std::mutex mutex;
+      // Signaled when an adapter of the shard was created or failed
+      std::condition_variable created;
+      std::unordered_map<std::string, ENTRY> entries;
+    };
+
+    /**
+     * @brief Gets the shard of a table
+     */
+    auto shard(const std::string &tablename) -> SHARD &;
+
+    SHARD shards_[kShards];
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_ADAPTER_REGISTRY
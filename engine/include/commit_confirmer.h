@@ -0,0 +1,119 @@
+#ifndef BLOCKCHAIN_DB_COMMIT_CONFIRMER
+#define BLOCKCHAIN_DB_COMMIT_CONFIRMER
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "adapter_factory/adapter_factory.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Enum of the states of a blockchain transaction of an asynchronous
+ * commit
+ *
+ */
+enum class COMMIT_STATUS{PENDING, CONFIRMED, FAILED};
+
+/**
+ * @brief Struct that stores a blockchain transaction of an asynchronous commit.
+ *
+ * @param tablename Name of the table the transaction writes to
+ * @param transaction_id ID of the blockchain transaction
+ * @param status State of the transaction
+ * @param submitted Time when the transaction was accepted by the node
+ * @param finished Time when the transaction was confirmed or failed
+ *
+ */
+struct COMMIT_RECORD {
+  std::string tablename;
+  std::string transaction_id;
+  COMMIT_STATUS status = COMMIT_STATUS::PENDING;
+  std::chrono::system_clock::time_point submitted;
+  std::chrono::system_clock::time_point finished;
+};
+
+/**
+ * @brief Process-wide tracker of the blockchain transactions of asynchronous
+ * commits. The adapters watch the pending transactions, e.g. with the receipt
+ * poller of their node, and report them when they are mined. Finished
+ * transactions are reported to a handler, the most recent confirmed and
+ * failed transactions are kept for the status table.
+ *
+ */
+class CommitConfirmer {
+  public:
+    using FinishHandler = std::function<void(const COMMIT_RECORD &)>;
+
+    /**
+     * @brief Get the confirmer of the process
+     *
+     * @return The confirmer
+     */
+    static auto instance() -> CommitConfirmer &;
+
+    ~CommitConfirmer();
+
+    /**
+     * @brief Set the function that is called for every confirmed or failed
+     * transaction
+     *
+     * @param handler Function that is called by the thread of the adapter
+     * that saw the transaction finish
+     */
+    void set_finish_handler(FinishHandler handler);
+
+    /**
+     * @brief Track transactions until they are mined
+     *
+     * @param tablename Name of the table the transactions write to
+     * @param adapter Adapter of the table, it watches the transactions
+     * @param transactions The transactions
+     */
+    void track(const std::string &tablename, std::shared_ptr<BcAdapter> adapter,
+               const std::vector<PENDING_TRANSACTION> &transactions);
+
+    /**
+     * @brief Get the pending and the most recent finished transactions
+     *
+     * @return Copies of the records, pending transactions first
+     */
+    auto list() -> std::vector<COMMIT_RECORD>;
+
+    /**
+     * @brief Stop tracking. Pending transactions are not reported anymore.
+     */
+    void stop();
+
+  private:
+    // Transactions that are not mined after this time are reported as failed
+    static constexpr std::chrono::seconds kMaxPendingTime{600};
+    // Number of finished transactions that are kept for the status table
+    static constexpr size_t kHistorySize = 1000;
+
+    /**
+     * @brief Called by an adapter when a watched transaction finished
+     *
+     * @param transaction_id ID of the transaction
+     * @param state Status code of the adapter, 0 if mined successfully
+     */
+    void finish(const std::string &transaction_id, int state);
+
+    std::mutex mutex_;
+    bool stopping_ = false;
+    FinishHandler finish_handler_;
+    // Pending transactions, in the order they were sent
+    std::deque<COMMIT_RECORD> pending_;
+    // Finished transactions, the most recent last
+    std::deque<COMMIT_RECORD> finished_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_COMMIT_CONFIRMER
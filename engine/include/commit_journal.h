@@ -0,0 +1,212 @@
+#ifndef BLOCKCHAIN_DB_COMMIT_JOURNAL
+#define BLOCKCHAIN_DB_COMMIT_JOURNAL
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "adapter_factory/adapter_factory.h"
+#include "transaction.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Struct that stores the final state of a key after a commit.
+ *
+ * @param type WRITE or INSERT with the value of the key, or REMOVE
+ * @param value The value of the key, empty for REMOVE
+ *
+ */
+struct JOURNAL_CHANGE {
+  STATEMENT_TYPE type;
+  BYTES value;
+};
+
+/**
+ * @brief Struct that stores the changes of one table by a commit that are not
+ * known to be on the blockchain yet.
+ *
+ * @param tablename Name of the table
+ * @param changes Final state of every key written by the commit. Keys that a
+ * later commit writes again are removed, since the later commit decides their
+ * state.
+ * @param transactions Transactions that were sent without waiting for them to
+ * be mined, confirmed transactions are removed
+ * @param sent Whether all transactions of the commit were sent and none of
+ * them failed
+ * @param recover Whether the entry is left over from before a restart and has
+ * to be recovered when the table is opened
+ *
+ */
+struct JOURNAL_ENTRY {
+  std::string tablename;
+  std::map<BYTES, JOURNAL_CHANGE> changes;
+  std::vector<PENDING_TRANSACTION> transactions;
+  bool sent = false;
+  bool recover = false;
+};
+
+/**
+ * @brief Process-wide, append-only journal of the changes that commits send to
+ * the blockchain. The changes of a table are journaled before they are sent
+ * and the entry is finished once they are known to be on the blockchain, so
+ * after a crash only the unfinished entries have to be checked against the
+ * blockchain, instead of the complete tables.
+ *
+ * Records are buffered and written with one fsync by sync(). The journal is a
+ * file of JSON objects, one per line:
+ *   {"op":"begin","id":..,"table":..,"changes":[[type,key,value],..]}
+ *   {"op":"sent","id":..,"transactions":[[id,nonce],..]}
+ *   {"op":"confirm","transaction":..,"ok":..}
+ *   {"op":"done","id":..}
+ *   {"op":"abort","id":..}
+ * It is rewritten with only the unfinished entries when it is opened and when
+ * it grows beyond kCompactionSize.
+ *
+ */
+class CommitJournal {
+  public:
+    /**
+     * @brief Get the journal of the process
+     *
+     * @return The journal
+     */
+    static auto instance() -> CommitJournal &;
+
+    ~CommitJournal();
+
+    /**
+     * @brief Reads the unfinished entries of an existing journal and opens it
+     * for appending. The entries are recovered when their tables are opened.
+     *
+     * @param path Path of the journal file, created if it does not exist
+     * @return true if the journal can be written
+     */
+    auto open(const std::string &path) -> bool;
+
+    /**
+     * @brief Closes the journal, buffered records are written
+     */
+    void close();
+
+    /**
+     * @brief Journals the changes of a table by a commit
+     *
+     * @param tablename Name of the table
+     * @param transaction The committed transaction, only the statements of
+     * the table are journaled
+     * @return ID of the entry, 0 if the journal is not open
+     */
+    auto begin(const std::string &tablename,
+               const Transaction &transaction) -> uint64_t;
+
+    /**
+     * @brief Journals the transactions of an entry that were sent without
+     * waiting. The entry is finished when all of them are confirmed.
+     *
+     * @param id ID of the entry
+     * @param transactions The transactions
+     */
+    void sent(uint64_t id, const std::vector<PENDING_TRANSACTION> &transactions);
+
+    /**
+     * @brief Journals that the changes of an entry are on the blockchain
+     *
+     * @param id ID of the entry
+     */
+    void finish(uint64_t id);
+
+    /**
+     * @brief Journals that the commit of an entry failed and was reported to
+     * the client, so that a recovery does not complete it
+     *
+     * @param id ID of the entry
+     */
+    void abort(uint64_t id);
+
+    /**
+     * @brief Journals the result of a transaction that was sent without waiting
+     *
+     * @param transaction_id ID of the transaction
+     * @param ok Whether it was mined successfully
+     */
+    void transaction_finished(const std::string &transaction_id, bool ok);
+
+    /**
+     * @brief Writes the buffered records and waits until they are on disk
+     *
+     * @return true on success or if the journal is not open
+     */
+    auto sync() -> bool;
+
+    /**
+     * @brief Drops entries whose begin records could not be written, before
+     * their commit is rejected. Their records are removed from the buffer, so
+     * that they are not written by a later sync either.
+     *
+     * @param ids IDs of the entries
+     */
+    void discard(const std::vector<uint64_t> &ids);
+
+    /**
+     * @brief Brings the changes of the entries of a table that were left over
+     * from before a restart onto the blockchain. The receipts of all entries
+     * are read at once, entries whose transactions were all mined are
+     * finished without reading the table. For the others the journaled keys
+     * are read and the keys that differ are written again.
+     *
+     * @param tablename Name of the table
+     * @param adapter Adapter of the table
+     * @param batch_keys Number of keys that are read with one getBatch call
+     * @return Number of entries that could not be recovered
+     */
+    auto recover(const std::string &tablename, BcAdapter *adapter,
+                 size_t batch_keys) -> size_t;
+
+  private:
+    // Size of the journal file above which it is rewritten
+    static constexpr size_t kCompactionSize = 64 * 1024 * 1024;
+
+    /**
+     * @brief Adds an entry and removes its keys from the earlier entries of
+     * the same table. Requires the lock.
+     */
+    void add_entry(uint64_t id, JOURNAL_ENTRY entry);
+
+    /**
+     * @brief Removes an entry and appends its done or abort record. Requires
+     * the lock.
+     */
+    void finish_entry(uint64_t id, const char *op = "done");
+
+    /**
+     * @brief Writes the records of the unfinished entries to a new file that
+     * replaces the journal. Requires the lock.
+     */
+    auto compact() -> bool;
+
+    /**
+     * @brief Appends a record to the buffer. Requires the lock.
+     */
+    void append(const std::string &record);
+
+    std::mutex mutex_;
+    std::string path_;
+    int fd_ = -1;
+    // records not written yet
+    std::string buffer_;
+    // bytes written to the file
+    size_t file_size_ = 0;
+    uint64_t next_id_ = 1;
+    // Unfinished entries by ID, in the order of the commits
+    std::map<uint64_t, JOURNAL_ENTRY> entries_;
+    // Entry of every transaction that is not confirmed yet
+    std::unordered_map<std::string, uint64_t> transaction_entries_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_COMMIT_JOURNAL
@@ -0,0 +1,100 @@
+#ifndef BLOCKCHAIN_DB_GROUP_COMMIT
+#define BLOCKCHAIN_DB_GROUP_COMMIT
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "adapter_factory/adapter_factory.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Struct that stores the writes of concurrent commits to one table that
+ * are sent with the same blockchain transaction.
+ *
+ * @param rows Merged writes of all members, the members write different keys.
+ * After sending, the rows that were not written.
+ * @param batches Rows of every member, they are kept by the members until the
+ * group is done
+ * @param done Whether the group was sent and its transactions are mined
+ * @param result Status code of the adapter for the group
+ * @param finished Signaled when the group is done
+ *
+ */
+struct COMMIT_GROUP {
+  std::map<const BYTES, const BYTES> rows;
+  std::vector<const std::map<const BYTES, const BYTES> *> batches;
+  bool done = false;
+  int result = 0;
+  std::condition_variable finished;
+};
+
+/**
+ * @brief Process-wide group commit of the writes of concurrent commits. Like
+ * the group commit of the binary log, the first commit to a table becomes the
+ * leader of a group and waits a short time for other commits to join. The
+ * leader sends the merged writes with one putBatch transaction and all members
+ * are released when it is mined. A group is closed early when it reaches a
+ * number of rows. A commit that writes a key of a group that is not done yet
+ * waits until it is, so that the writes of a key are mined and applied to the
+ * table snapshots in the order of their commits.
+ *
+ */
+class GroupCommit {
+  public:
+    /**
+     * @brief Get the group commit of the process
+     *
+     * @return The group commit
+     */
+    static auto instance() -> GroupCommit &;
+
+    /**
+     * @brief Writes rows to a table together with the rows of concurrent
+     * commits and waits until they are mined
+     *
+     * @param tablename Name of the table
+     * @param adapter Adapter of the table
+     * @param batch Rows to write
+     * @param window Time the leader waits for other commits
+     * @param max_rows Number of rows that closes a group
+     * @return 0 if the rows were written, else the status code of the adapter
+     */
+    auto put(const std::string &tablename, BcAdapter *adapter,
+             const std::map<const BYTES, const BYTES> &batch,
+             std::chrono::milliseconds window, size_t max_rows) -> int;
+
+  private:
+    /**
+     * @brief Struct that stores the group of a table that commits can join
+     *
+     */
+    struct TABLE_QUEUE {
+      std::shared_ptr<COMMIT_GROUP> open;
+      // Groups that are not done, including the open one
+      std::vector<std::shared_ptr<COMMIT_GROUP>> unfinished;
+      // Signaled when the open group is closed
+      std::condition_variable closed;
+    };
+
+    /**
+     * @brief Finds a group of a table that is not done and writes one of the
+     * keys of a batch. Requires the lock.
+     */
+    static auto find_conflict(const TABLE_QUEUE &queue,
+                              const std::map<const BYTES, const BYTES> &batch)
+        -> std::shared_ptr<COMMIT_GROUP>;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, TABLE_QUEUE> queues_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_GROUP_COMMIT
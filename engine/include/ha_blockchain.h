@@ -38,13 +38,26 @@
   /sql/handler.h and /storage/blockchain/ha_blockchain.cc
 */
 
+#include <memory>
 #include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 #include <sys/types.h>
 
 #include "adapter_factory/adapter_factory.h"
+#include "adapter_registry.h"
 #include "my_base.h" /* ha_rows */
 #include "my_compiler.h"
 #include "my_inttypes.h"
+#include "commit_confirmer.h"
+#include "commit_journal.h"
+#include "group_commit.h"
+#include "latency_model.h"
+#include "row_filter.h"
+#include "snapshot_cache.h"
+#include "table_cache.h"
+#include "table_statistics.h"
 #include "sql/handler.h" /* handler */
 #include "transaction.h"
 #include "thr_lock.h" /* THR_LOCK, THR_LOCK_DATA */
@@ -68,13 +81,78 @@ struct BC_TABLE {
   size_t connect_string_length;
 };
 
+/**
+ * @brief State of an open bc-table that all handlers of the table share. It is
+ * created by the first handler that opens the table and lives as long as the
+ * TABLE_SHARE, so the adapter is created once per table and handlers reach it
+ * without looking it up.
+ *
+ * @param mutex Serializes the handlers that open the table
+ * @param full_table_name Table name in the format "./db_name/table_name", the
+ * key of the table in the caches of a transaction and of the engine
+ * @param bc_adapter Adapter of the table, nullptr until the table is opened
+ * @param endpoint Blockchain node of the table, used for latency measurements
+ */
+class BC_SHARE : public Handler_share {
+ public:
+  ~BC_SHARE() override;
+
+  std::mutex mutex;
+  std::string full_table_name;
+  std::shared_ptr<BcAdapter> bc_adapter;
+  std::string endpoint;
+};
+
 /** @brief
   Class definition for the handler for blockchain storage engine
 */
 class ha_blockchain : public handler {
-  my_off_t current_position; // current position during table scan
-  std::vector<std::tuple<BYTES, BYTES>>
-      all_items; // buffer for table scan result
+  // state of the table shared by all its handlers
+  BC_SHARE *share = nullptr;
+  // the table in the table cache of the transaction, resolved when the table
+  // is locked or a statement starts, so that rows do not look it up by name
+  TABLE_HANDLE table_handle;
+  // cursor of a table scan, iterates the table cache of the transaction
+  TableCache::const_iterator scan_it;
+  TableCache::const_iterator scan_end;
+  // keys written while scanning, they must not be returned by the scan again
+  std::set<BYTES, ROW_LESS> scan_written_keys;
+  bool scan_active = false;
+  // rows of the current batch of a filtered scan that match the pushed
+  // condition, scan_it points behind the batch
+  std::vector<TableCache::const_iterator> scan_batch;
+  size_t scan_batch_pos = 0;
+  // part of the pushed condition that is evaluated by the engine
+  RowFilter row_filter;
+  // the statement only reads the table, so rows may be decoded partially
+  bool read_locked = false;
+  // byte ranges (offset, length) of the columns of the read set in the stored
+  // value of a row and the read set they were computed for
+  std::vector<std::pair<size_t, size_t>> projection;
+  std::vector<my_bitmap_map> projection_bits;
+  // key of the row the scan returned last, stored by position()
+  uchar current_key[MAX_BC_KEY_SIZE];
+  // cursor of an index scan, the entry of the current row in the ordered
+  // index of the transaction
+  const IndexView *index_set = nullptr;
+  const TableCache *index_table = nullptr;
+  std::string index_current;
+  // record buffer to decode rows and search keys for ordered indexes
+  std::vector<uchar> index_record;
+  // rows of a bulk insert into a lazily loaded table whose keys are checked
+  // together, and whether duplicate keys are ignored or replaced instead of
+  // failing the statement (then every row is checked when it is written)
+  std::vector<std::pair<BYTES, BYTES>> pending_inserts;
+  bool bulk_insert_active = false;
+  bool duplicates_handled = false;
+  // batched multi range read of primary keys: the row keys and range pointers
+  // of the ranges, the rows are fetched before the first one is returned
+  std::vector<std::pair<BYTES, char *>> batch_keys;
+  size_t batch_pos = 0;
+  bool batch_read_active = false;
+  uint batch_mode = 0;
+  RANGE_SEQ_IF batch_seq;
+  range_seq_t batch_seq_it = nullptr;
 
 public:
   ha_blockchain(handlerton *hton, TABLE_SHARE *table_arg);
@@ -92,10 +170,10 @@ public:
     @sa handler::adjust_index_algorithm().
   */
   enum ha_key_alg get_default_index_algorithm() const override {
-    return HA_KEY_ALG_HASH;
+    return HA_KEY_ALG_BTREE;
   }
   bool is_index_algorithm_supported(enum ha_key_alg key_alg) const override {
-    return key_alg == HA_KEY_ALG_HASH;
+    return key_alg == HA_KEY_ALG_BTREE || key_alg == HA_KEY_ALG_HASH;
   }
 
   /** @brief
@@ -120,11 +198,13 @@ public:
     part is the key part to check. First key part is 0.
     If all_parts is set, MySQL wants to know the flags for the combined
     index, up to and including 'part'.
+    All indexes are ordered indexes that are built in memory from the table
+    cache of the transaction.
   */
   ulong index_flags(uint inx MY_ATTRIBUTE((unused)),
                     uint part MY_ATTRIBUTE((unused)),
                     bool all_parts MY_ATTRIBUTE((unused))) const override {
-    return 0;
+    return HA_READ_NEXT | HA_READ_PREV | HA_READ_RANGE | HA_READ_ORDER;
   }
 
   /** @brief
@@ -177,17 +257,16 @@ public:
 
   /** @brief
     Called in test_quick_select to determine if indexes should be used.
+    Includes the measured time to read the table from the blockchain.
   */
-  double scan_time() override {
-    return (double)(stats.records + stats.deleted) / 20.0 + 10;
-  }
+  double scan_time() override;
 
   /** @brief
-    This method will never be called if you do not implement indexes.
+    Cost of reading rows by an index, also used for the cost of multi range
+    reads. Includes the measured time of point reads or of reading the table
+    from the blockchain.
   */
-  double read_time(uint, uint, ha_rows rows) override {
-    return (double)rows / 20.0 + 1;
-  }
+  double read_time(uint index, uint ranges, ha_rows rows) override;
 
   /**********************************************************************
     Everything below are methods that we implement in ha_blockchain.cc.
@@ -297,8 +376,45 @@ public:
   int rnd_pos(uchar *buf, uchar *pos) override; ///< required
   void position(const uchar *record) override;  ///< required
 
+  /** @brief
+    Takes over comparisons of integer columns with constants of the condition
+    of a SELECT. They are evaluated over the stored values of the rows, so
+    rows that do not match are never copied to the record buffer.
+    Returns nullptr if the whole condition was taken over, otherwise the
+    server evaluates the whole condition again.
+  */
+  const Item *cond_push(const Item *cond, bool other_tbls_ok) override;
+  int reset() override;
+
+  /** @brief
+    Multi range reads of the primary key with only complete keys, e.g. the
+    lookups of a batched key access join, fetch all rows that are not cached
+    with a single request. All other multi range reads use the default
+    implementation.
+  */
+  ha_rows multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
+                                      void *seq_init_param, uint n_ranges,
+                                      uint *bufsz, uint *flags,
+                                      bool *force_default_mrr,
+                                      Cost_estimate *cost) override;
+  ha_rows multi_range_read_info(uint keyno, uint n_ranges, uint keys,
+                                uint *bufsz, uint *flags,
+                                Cost_estimate *cost) override;
+  int multi_range_read_init(RANGE_SEQ_IF *seq, void *seq_init_param,
+                            uint n_ranges, uint mode,
+                            HANDLER_BUFFER *buf) override;
+  int multi_range_read_next(char **range_info) override;
+
   int info(uint) override; ///< required
+  int analyze(THD *thd, HA_CHECK_OPT *check_opt) override;
   int extra(enum ha_extra_function operation) override;
+  /** @brief
+    Called before multi-row INSERTs and LOAD DATA. The rows are collected in
+    the transaction as usual, but committed in chunks of putBatch transactions
+    instead of one transaction per row.
+  */
+  void start_bulk_insert(ha_rows rows) override;
+  int end_bulk_insert() override;
   int external_lock(THD *thd, int lock_type) override; ///< required
   int delete_all_rows(void) override;
   ha_rows records_in_range(uint inx, key_range *min_key,
@@ -319,7 +435,213 @@ public:
    *******************/
 
   int find_current_row(uchar *buf);
-  int find_row(my_off_t index, uchar *buf);
+  int find_row(const ROW_REF &value, uchar *buf);
+
+  /**
+   * @brief Decodes a row that is returned to the server. For statements that
+   * only read the table, only the columns of the read set are decoded.
+   *
+   * @param value Stored value of the row
+   * @param[out] buf Record buffer for the row
+   * @return 0 on success
+   */
+  int read_row(const ROW_REF &value, uchar *buf);
+
+  /**
+   * @brief Computes the byte ranges of the columns of the current read set
+   */
+  void init_projection();
+
+  /**
+   * @brief Reads the next batch of rows of a filtered table scan and keeps
+   * the rows that match the pushed condition
+   */
+  void fill_scan_batch();
+
+  /**
+   * @brief Converts a comparison of the pushed condition to a predicate of the
+   * row filter
+   *
+   * @param item Comparison of the condition
+   * @return true if the predicate was added to the row filter
+   */
+  bool push_predicate(const Item *item);
+
+  /**
+   * @brief Skips the entries of the active index whose rows do not match the
+   * pushed condition
+   *
+   * @param it First entry to check
+   * @param forward Direction in which entries are skipped
+   * @return First matching entry in the given direction or the end of the index
+   */
+  auto next_matching_entry(IndexView::const_iterator it, bool forward)
+      -> IndexView::const_iterator;
+
+  /**
+   * @brief Builds the entry of a row or of a search key for an ordered index.
+   * The sort keys of the key parts are concatenated, so entries can be
+   * compared bytewise.
+   *
+   * @param index Number of the index
+   * @param record Row or search key in record format
+   * @param key_parts Number of key parts to use
+   * @return Sort keys of the key parts
+   */
+  auto make_index_entry(uint index, const uchar *record, uint key_parts)
+      -> std::string;
+
+  /**
+   * @brief Converts a search key to the format of the entries of an ordered
+   * index
+   *
+   * @param index Number of the index
+   * @param key Search key in key format
+   * @param key_len Length of the search key
+   * @param[out] key_parts Number of key parts in the search key or nullptr
+   * @return Sort keys of the key parts of the search key
+   */
+  auto make_search_prefix(uint index, const uchar *key, uint key_len,
+                          uint *key_parts) -> std::string;
+
+  /**
+   * @brief Prepares the cursor of the active index. Loads the complete table
+   * and builds the ordered index if the transaction did not use it yet.
+   *
+   * @return 0 on success, HA_ERR_NO_CONNECTION if the table can not be read
+   */
+  int init_index_cursor();
+
+  /**
+   * @brief Reads the row of an index entry and moves the index cursor to it
+   *
+   * @param it Entry of the ordered index
+   * @param[out] buf Record buffer for the row
+   * @return 0 on success, HA_ERR_END_OF_FILE at the end of the index
+   */
+  int read_index_entry(IndexView::const_iterator it, uchar *buf);
+
+  /**
+   * @brief Reads the first row of the active index that matches a search key
+   *
+   * @param[out] buf Record buffer for the row
+   * @param key Search key in key format
+   * @param key_len Length of the search key
+   * @param find_flag Which row to read relative to the search key
+   * @return 0 on success, HA_ERR_KEY_NOT_FOUND if there is no such row
+   */
+  int index_read_ordered(uchar *buf, const uchar *key, uint key_len,
+                         enum ha_rkey_function find_flag);
+
+  /**
+   * @brief Replaces the entries of a row in the ordered indexes that the
+   * transaction built for a table
+   *
+   * @param txn Transaction that uses the table
+   * @param full_table_name Table name in the format "./db_name/table_name"
+   * @param row_key Key of the row
+   * @param old_value Value of the row before the change, empty if the row is
+   * added
+   * @param new_value Value of the row after the change, empty if the row is
+   * removed
+   */
+  void update_indexes(Transaction *txn, const std::string &full_table_name,
+                      const BYTES &row_key,
+                      const std::optional<ROW_REF> &old_value,
+                      const std::optional<ROW_REF> &new_value);
+
+  /**
+   * @brief Replaces the cache of a lazily loaded table by the complete table
+   *
+   * @param txn Transaction that uses the table
+   * @param full_table_name Table name in the format "./db_name/table_name"
+   * @return 0 on success, HA_ERR_NO_CONNECTION if the table can not be read
+   */
+  int ensure_table_loaded(Transaction *txn, const std::string &full_table_name);
+
+  /**
+   * @brief Reads a row by key, including the writes of the transaction. Rows
+   * of lazily loaded tables are read from the blockchain if necessary.
+   *
+   * @param txn Transaction that uses the table
+   * @param full_table_name Table name in the format "./db_name/table_name"
+   * @param key Key of the row
+   * @param[out] value Value of the row in the table cache of the transaction,
+   * valid until the transaction ends
+   * @return 0 if found, HA_ERR_KEY_NOT_FOUND if the row does not exist or
+   * HA_ERR_NO_CONNECTION if the row can not be read
+   */
+  int lookup_row(Transaction *txn, const std::string &full_table_name,
+                 const BYTES &key, ROW_REF *value);
+
+  /**
+   * @brief Inserts a row after checking that its key does not exist
+   *
+   * @param txn Transaction that uses the table
+   * @param key Key of the row
+   * @param value Value of the row
+   * @return 0 on success or the error of the check
+   */
+  int insert_row(Transaction *txn, const BYTES &key, const BYTES &value);
+
+  /**
+   * @brief Checks the keys of the pending rows of a bulk insert with one
+   * request and inserts the rows
+   *
+   * @return 0 on success or the error of the first row that failed
+   */
+  int flush_pending_inserts();
+
+  /**
+   * @brief Marks the table for bulk inserts in the current transaction
+   *
+   * @param rows Expected number of rows or 0 if unknown
+   */
+  void mark_bulk_insert(ha_rows rows);
+
+  /**
+   * @brief Reads the rows of multiple keys of a lazily loaded table from the
+   * blockchain with a single request, so that lookup_row finds them in the
+   * table cache of the transaction
+   *
+   * @param txn Transaction that uses the table
+   * @param keys Keys of the rows
+   * @return 0 on success, HA_ERR_NO_CONNECTION if the rows can not be read
+   */
+  int prefetch_rows(Transaction *txn, const std::vector<BYTES> &keys);
+
+  /**
+   * @brief Computes the key of a row from its complete primary key
+   *
+   * @param key Primary key in key format
+   * @return Hash of the primary key
+   */
+  auto make_row_key(const uchar *key) -> BYTES;
+
+  /**
+   * @brief Lets the optimizer use batched multi range reads for the primary
+   * key instead of the default implementation
+   *
+   * @param keyno Number of the index
+   * @param[in,out] flags Flags of the multi range read
+   */
+  void choose_mrr_impl(uint keyno, uint *flags);
+
+  /**
+   * @brief Estimates the time until the complete table is available to the
+   * current transaction, based on the measured latencies of the endpoint
+   *
+   * @return Time in milliseconds, 0 if the transaction has the table already
+   */
+  double table_load_ms();
+
+  /**
+   * @brief Gets the state of the table shared by all its handlers, it is
+   * created if the table has none yet
+   *
+   * @return The shared state, nullptr if it can not be created
+   */
+  BC_SHARE *get_share();
 
   // Storage engine methods
   static handler *bc_create_handler(handlerton *hton, TABLE_SHARE *table,
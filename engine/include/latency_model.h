@@ -0,0 +1,97 @@
+#ifndef BLOCKCHAIN_DB_LATENCY_MODEL
+#define BLOCKCHAIN_DB_LATENCY_MODEL
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace blockchain_db {
+
+/**
+ * @brief Struct that stores the measured costs of the requests to one
+ * blockchain endpoint. All values are moving averages.
+ *
+ * @param call_ms Round trip time of a simple RPC request (eth_blockNumber)
+ * @param get_ms Time to read one row by key (eth_call of get)
+ * @param scan_ms_per_byte Time to transfer one byte of a table scan (eth_call
+ * of tableScan), without the round trip time
+ * @param call_samples, get_samples, scan_samples Number of measurements
+ *
+ */
+struct ENDPOINT_LATENCY {
+  double call_ms = 5.0;
+  double get_ms = 5.0;
+  double scan_ms_per_byte = 0.001;
+  uint64_t call_samples = 0;
+  uint64_t get_samples = 0;
+  uint64_t scan_samples = 0;
+};
+
+/**
+ * @brief Process-wide measurements of the request latencies of all blockchain
+ * endpoints. The storage engine records the time of every request and uses
+ * the averages to estimate the cost of table scans and index reads.
+ *
+ */
+class LatencyModel {
+  public:
+    /**
+     * @brief Get the latency model of the process
+     *
+     * @return The latency model
+     */
+    static auto instance() -> LatencyModel &;
+
+    /**
+     * @brief Get the measured latencies of an endpoint. Endpoints without
+     * measurements get default values.
+     *
+     * @param endpoint Connection string of the endpoint
+     * @return The latencies of the endpoint
+     */
+    auto get(const std::string &endpoint) -> ENDPOINT_LATENCY;
+
+    /**
+     * @brief Record the round trip time of a simple RPC request
+     *
+     * @param endpoint Connection string of the endpoint
+     * @param ms Measured time in milliseconds
+     */
+    void record_call(const std::string &endpoint, double ms);
+
+    /**
+     * @brief Record the time to read one row by key
+     *
+     * @param endpoint Connection string of the endpoint
+     * @param ms Measured time in milliseconds
+     */
+    void record_get(const std::string &endpoint, double ms);
+
+    /**
+     * @brief Record the time of a table scan
+     *
+     * @param endpoint Connection string of the endpoint
+     * @param ms Measured time in milliseconds
+     * @param bytes Number of bytes of the scanned rows
+     */
+    void record_scan(const std::string &endpoint, double ms, uint64_t bytes);
+
+  private:
+    // Weight of a new measurement in the moving averages
+    static constexpr double kWeight = 0.2;
+
+    /**
+     * @brief Add a measurement to a moving average. The first measurement
+     * replaces the default value.
+     */
+    static void add_sample(double &average, uint64_t &samples, double value);
+
+    std::mutex mutex_;
+    // Latencies by connection string of the endpoint
+    std::unordered_map<std::string, ENDPOINT_LATENCY> latencies_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_LATENCY_MODEL
@@ -0,0 +1,91 @@
+#ifndef BLOCKCHAIN_DB_ROW_FILTER
+#define BLOCKCHAIN_DB_ROW_FILTER
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "adapter_factory/adapter_factory.h"
+#include "row_ref.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Enum of the comparisons of a column with constants
+ *
+ */
+enum class FILTER_OP{EQ, NE, LT, LE, GT, GE, IN};
+
+/**
+ * @brief Struct that stores the comparison of an integer column with constants,
+ * e.g. a < 5 or a IN (1, 2, 3).
+ *
+ * @param offset Offset of the column in the stored value of a row
+ * @param length Length of the column in bytes (1, 2, 3, 4 or 8), stored little-endian
+ * @param is_unsigned Whether the column and the constants are unsigned
+ * @param op The comparison
+ * @param values The constants, one for all comparisons except IN. Unsigned
+ * constants are stored with the same bits.
+ *
+ */
+struct COLUMN_PREDICATE{
+  size_t offset;
+  size_t length;
+  bool is_unsigned;
+  FILTER_OP op;
+  std::vector<int64_t> values;
+};
+
+/**
+ * @brief Conjunction of column predicates that is evaluated over the stored
+ * values of rows, without decoding them into record buffers. Rows are
+ * evaluated in batches: each column is gathered into an array and compared
+ * with tight loops that the compiler can vectorize.
+ *
+ */
+class RowFilter {
+  public:
+    // Maximal number of rows evaluated at once
+    static constexpr size_t kBatchSize = 256;
+
+    /**
+     * @brief Adds a predicate that all matching rows have to satisfy
+     *
+     * @param predicate The predicate
+     */
+    void add(COLUMN_PREDICATE predicate);
+
+    /**
+     * @brief Removes all predicates
+     */
+    void clear();
+
+    /**
+     * @brief Whether the filter has no predicates and matches all rows
+     */
+    auto empty() const -> bool;
+
+    /**
+     * @brief Evaluates the filter for one row
+     *
+     * @param value Stored value of the row
+     * @return true if the row satisfies all predicates
+     */
+    auto matches(const ROW_REF &value) const -> bool;
+
+    /**
+     * @brief Evaluates the filter for a batch of rows
+     *
+     * @param values Stored values of the rows
+     * @param count Number of rows, at most kBatchSize
+     * @param[out] result 1 for every row that satisfies all predicates, else 0
+     */
+    void evaluate(const ROW_REF *values, size_t count, uint8_t *result) const;
+
+  private:
+    std::vector<COLUMN_PREDICATE> predicates_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_ROW_FILTER
@@ -0,0 +1,61 @@
+#ifndef BLOCKCHAIN_DB_ROW_REF
+#define BLOCKCHAIN_DB_ROW_REF
+
+#include <cstring>
+
+#include "adapter_factory/adapter_factory.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Struct that references bytes without owning them, e.g. bytes stored in the arena of a
+ * transaction, which are valid as long as the transaction exists.
+ *
+ * @param value Pointer to the first byte
+ * @param size Number of bytes
+ *
+ */
+struct ROW_REF{
+  const unsigned char *value;
+  size_t size;
+
+  /**
+   * @brief Copies the bytes into a BYTES object, e.g. to keep them after the transaction
+   */
+  auto bytes() const -> BYTES {
+    return BYTES(const_cast<unsigned char *>(value), size);
+  }
+};
+
+/**
+ * @brief Compares referenced bytes like BYTES objects
+ */
+inline auto operator<(const ROW_REF &lhs, const ROW_REF &rhs) -> bool {
+  if (lhs.size != rhs.size)
+    return lhs.size < rhs.size;
+  return memcmp(lhs.value, rhs.value, lhs.size) < 0;
+}
+
+/**
+ * @brief Orders BYTES and ROW_REF objects like BYTES objects. Maps with BYTES keys that use it can be
+ * searched with a ROW_REF, which does not copy the key.
+ *
+ */
+struct ROW_LESS{
+  using is_transparent = void;
+
+  static auto ref(const BYTES &bytes) -> ROW_REF {
+    return ROW_REF{bytes.value, bytes.size};
+  }
+  static auto ref(const ROW_REF &row) -> ROW_REF {
+    return row;
+  }
+  template <typename L, typename R>
+  auto operator()(const L &lhs, const R &rhs) const -> bool {
+    return ref(lhs) < ref(rhs);
+  }
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_ROW_REF
@@ -0,0 +1,100 @@
+#ifndef BLOCKCHAIN_DB_SNAPSHOT_CACHE
+#define BLOCKCHAIN_DB_SNAPSHOT_CACHE
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "adapter_factory/adapter_factory.h"
+#include "table_cache.h"
+#include "transaction.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Process-wide cache that stores one snapshot per bc-table. It is shared
+ * by all transactions, so that a table only has to be scanned from the
+ * blockchain again when new blocks were mined.
+ * Snapshots handed out by the cache are never modified. Changes committed by
+ * the storage engine are written through by replacing the cached snapshot with
+ * a new version that shares the rows of the old one (or by modifying it in
+ * place when no transaction uses it anymore).
+ *
+ */
+class SnapshotCache {
+  public:
+    /**
+     * @brief Get the cache instance of the process
+     *
+     * @return The snapshot cache
+     */
+    static auto instance() -> SnapshotCache &;
+
+    /**
+     * @brief Get the cached snapshot of a table if it is recent enough
+     *
+     * @param tablename Name of the table
+     * @param head_block_number Number of the current head of the blockchain
+     * @param max_staleness Number of blocks the snapshot may lag behind the head
+     * @return The snapshot or nullptr if there is no usable snapshot
+     */
+    auto get(const std::string &tablename, uint64_t head_block_number,
+             uint64_t max_staleness) -> std::shared_ptr<const TABLE_SNAPSHOT>;
+
+    /**
+     * @brief Get the cached snapshot of a table regardless of its age, e.g. to
+     * estimate the size of the table
+     *
+     * @param tablename Name of the table
+     * @return The snapshot or nullptr if the table is not cached
+     */
+    auto peek(const std::string &tablename)
+        -> std::shared_ptr<const TABLE_SNAPSHOT>;
+
+    /**
+     * @brief Store a new snapshot of a table, replacing an older one
+     *
+     * @param tablename Name of the table
+     * @param snapshot The snapshot to store
+     */
+    void put(const std::string &tablename,
+             std::shared_ptr<TABLE_SNAPSHOT> snapshot);
+
+    /**
+     * @brief Write committed statements through to the snapshot of a table.
+     * Statements of other tables are ignored. If the snapshot was current
+     * when the commit was sent, it is current at the block the commit was
+     * mined in as well, so its block number is moved to that block.
+     *
+     * @param tablename Name of the table
+     * @param transaction The committed transaction
+     * @param sent_block_number Head of the chain when the commit was sent
+     * @param mined_block_number Head of the chain after the commit was mined,
+     * 0 if it is unknown, e.g. for asynchronous commits
+     */
+    void apply(const std::string &tablename,
+               const Transaction &transaction,
+               uint64_t sent_block_number = 0,
+               uint64_t mined_block_number = 0);
+
+    /**
+     * @brief Remove the snapshot of a table, e.g. when its state on the
+     * blockchain is unknown after a failed commit
+     *
+     * @param tablename Name of the table
+     */
+    void invalidate(const std::string &tablename);
+
+  private:
+    std::mutex mutex_;
+    // Snapshots by full table name, e.g. "./db/table"
+    std::unordered_map<std::string, std::shared_ptr<TABLE_SNAPSHOT>> snapshots_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_SNAPSHOT_CACHE
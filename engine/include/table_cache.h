@@ -0,0 +1,339 @@
+#ifndef BLOCKCHAIN_DB_TABLE_CACHE
+#define BLOCKCHAIN_DB_TABLE_CACHE
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+
+#include "adapter_factory/adapter_factory.h"
+#include "row_ref.h"
+
+namespace blockchain_db {
+
+/**
+ * @brief Ordered index of a table. An entry consists of the sort keys of the indexed columns followed by the key
+ * of the row, so the entries are unique and ordered like the index.
+ *
+ */
+using ORDERED_INDEX = std::set<std::string>;
+
+/**
+ * @brief Struct that stores the ordered indexes of a snapshot, they are built once by the first transaction
+ * that uses an index and shared by all transactions that read the snapshot.
+ *
+ * @param mutex Protects the indexes
+ * @param indexes Built indexes by index number
+ *
+ */
+struct SNAPSHOT_INDEXES {
+  std::mutex mutex;
+  std::map<unsigned int, std::shared_ptr<const ORDERED_INDEX>> indexes;
+};
+
+using SNAPSHOT_ROWS = std::map<BYTES, BYTES, ROW_LESS>;
+// rows written since the rows of a snapshot were read, an empty value marks a removed row
+using SNAPSHOT_CHANGES = std::map<BYTES, std::optional<BYTES>, ROW_LESS>;
+
+/**
+ * @brief Struct that stores a complete copy of a bc-table. Committed changes are not applied to the rows
+ * that were read, which older versions of the snapshot share, but stored next to them, so that a new
+ * version of the snapshot only copies the changes. They are folded into a new copy of the rows once they
+ * outgrow the square root of the table size, so a commit costs O(sqrt(table size)) amortized instead of a
+ * copy of the table.
+ *
+ * @param block_number Number of the block that was the head of the chain when
+ * the table was read
+ * @param rows Key-value pairs of the table when it was read, shared by the versions of the snapshot
+ * @param changes Rows written since the rows were read, they replace the rows with the same keys
+ * @param size Number of rows of the table including the changes
+ * @param indexes Ordered indexes of this version of the snapshot
+ *
+ */
+struct TABLE_SNAPSHOT {
+  /**
+   * @brief Iterates the rows of the snapshot in the order of their keys
+   */
+  class const_iterator {
+    public:
+      const_iterator() = default;
+
+      auto key() const -> ROW_REF;
+      auto value() const -> ROW_REF;
+      auto operator++() -> const_iterator &;
+      auto operator==(const const_iterator &other) const -> bool;
+      auto operator!=(const const_iterator &other) const -> bool;
+
+    private:
+      friend struct TABLE_SNAPSHOT;
+
+      const_iterator(const TABLE_SNAPSHOT *snapshot, SNAPSHOT_ROWS::const_iterator row,
+                     SNAPSHOT_CHANGES::const_iterator change);
+      /**
+       * @brief Moves the iterator to the next row that is not removed
+       */
+      void settle();
+
+      const TABLE_SNAPSHOT *snapshot_ = nullptr;
+      SNAPSHOT_ROWS::const_iterator row_;
+      SNAPSHOT_CHANGES::const_iterator change_;
+      // the current row is a change
+      bool in_changes_ = false;
+  };
+
+  uint64_t block_number = 0;
+  std::shared_ptr<SNAPSHOT_ROWS> rows = std::make_shared<SNAPSHOT_ROWS>();
+  SNAPSHOT_CHANGES changes;
+  size_t size = 0;
+  std::shared_ptr<SNAPSHOT_INDEXES> indexes = std::make_shared<SNAPSHOT_INDEXES>();
+
+  /**
+   * @brief Finds the row of a key
+   *
+   * @param key The key
+   * @return The value of the row, empty if the table does not contain it
+   */
+  auto find(const ROW_REF &key) const -> std::optional<ROW_REF>;
+  /**
+   * @brief Writes a row, only the owner of the snapshot may change it
+   */
+  void put(const BYTES &key, const BYTES &value);
+  /**
+   * @brief Removes a row, only the owner of the snapshot may change it
+   */
+  void erase(const BYTES &key);
+  /**
+   * @brief Applies the changes to the rows once they outgrow the square root of the table size. The
+   * rows are copied if an older version of the snapshot shares them.
+   */
+  void fold();
+  /**
+   * @brief Gets an ordered index of the snapshot, it is built if no transaction used it yet
+   *
+   * @param number Number of the index
+   * @param build Builds the index from the rows of the snapshot
+   * @return The index
+   */
+  auto index(unsigned int number, const std::function<ORDERED_INDEX(const TABLE_SNAPSHOT &)> &build) const
+      -> std::shared_ptr<const ORDERED_INDEX>;
+
+  auto begin() const -> const_iterator;
+  auto end() const -> const_iterator;
+};
+
+/**
+ * @brief Rows of a bc-table as seen by a transaction. The cache refers to the shared snapshot of the table,
+ * which is never copied, and stores only the rows that the transaction changed or read by key on top of it.
+ * These rows are not copied either, the cache references their bytes in the arena of the transaction, which
+ * the statements of the transaction share. A table that is loaded lazily has no snapshot.
+ *
+ */
+class TableCache {
+  public:
+    /**
+     * @brief Iterates the rows of the cache in the order of their keys, the rows of the transaction replace
+     * the rows of the snapshot with the same keys. Writes to the cache do not invalidate the iterator, rows
+     * written behind it are returned when it gets there.
+     *
+     */
+    class const_iterator {
+      public:
+        const_iterator() = default;
+
+        auto key() const -> ROW_REF;
+        auto value() const -> ROW_REF;
+        auto operator++() -> const_iterator &;
+        auto operator==(const const_iterator &other) const -> bool;
+        auto operator!=(const const_iterator &other) const -> bool;
+
+      private:
+        friend class TableCache;
+        using BaseIterator = TABLE_SNAPSHOT::const_iterator;
+        using DeltaIterator = std::map<ROW_REF, std::optional<ROW_REF>, ROW_LESS>::const_iterator;
+
+        const_iterator(const TableCache *cache, BaseIterator base, DeltaIterator delta);
+        /**
+         * @brief Moves the iterator to the next row that is not removed
+         */
+        void settle();
+
+        const TableCache *cache_ = nullptr;
+        BaseIterator base_;
+        DeltaIterator delta_;
+        // version of the cache that delta_ was positioned in
+        uint64_t version_ = 0;
+        // the current row is the one of the transaction
+        bool in_delta_ = false;
+    };
+
+    /**
+     * @brief Creates the cache of a lazily loaded table, it only contains the rows that are added
+     */
+    TableCache() = default;
+    /**
+     * @brief Creates the cache of a complete table
+     *
+     * @param snapshot The shared snapshot of the table
+     */
+    explicit TableCache(std::shared_ptr<const TABLE_SNAPSHOT> snapshot);
+
+    /**
+     * @brief Finds the row of a key
+     *
+     * @param key The key
+     * @return The value of the row, empty if the cache does not contain it. It stays valid when the row is
+     * changed.
+     */
+    auto find(const BYTES &key) const -> std::optional<ROW_REF>;
+    /**
+     * @brief Finds the row of a key without copying the key, e.g. a key stored by position()
+     *
+     * @param key The key
+     * @return The value of the row, empty if the cache does not contain it
+     */
+    auto find(const ROW_REF &key) const -> std::optional<ROW_REF>;
+    /**
+     * @brief Writes a row, it replaces a row of the snapshot with the same key. The bytes are not copied,
+     * they have to stay valid as long as the cache, e.g. in the arena of the transaction.
+     *
+     * @param key The key
+     * @param value The value
+     */
+    void put(const ROW_REF &key, const ROW_REF &value);
+    /**
+     * @brief Removes a row
+     *
+     * @param key The key, it has to stay valid as long as the cache
+     */
+    void erase(const ROW_REF &key);
+    /**
+     * @brief Replaces the snapshot, e.g. when a lazily loaded table is read completely. The rows of the
+     * transaction are discarded.
+     *
+     * @param snapshot The shared snapshot of the table
+     */
+    void reset(std::shared_ptr<const TABLE_SNAPSHOT> snapshot);
+
+    /**
+     * @brief Gets an ordered index of the snapshot, without the rows of the transaction
+     *
+     * @param number Number of the index
+     * @param build Builds the index from the rows of the snapshot
+     * @return The index, built once per snapshot version
+     */
+    auto index(unsigned int number, const std::function<ORDERED_INDEX(const TABLE_SNAPSHOT &)> &build) const
+        -> std::shared_ptr<const ORDERED_INDEX>;
+    /**
+     * @brief The shared snapshot, an empty one if the table is loaded lazily
+     */
+    auto base() const -> const TABLE_SNAPSHOT &;
+    /**
+     * @brief Rows written or read by key by the transaction, an empty value marks a removed row
+     */
+    auto changes() const -> const std::map<ROW_REF, std::optional<ROW_REF>, ROW_LESS> &;
+
+    /**
+     * @brief Number of rows
+     */
+    auto size() const -> size_t;
+    auto begin() const -> const_iterator;
+    auto end() const -> const_iterator;
+
+  private:
+    // snapshots are shared, so a cache without one uses an empty snapshot
+    static auto empty_snapshot() -> const TABLE_SNAPSHOT &;
+
+    std::shared_ptr<const TABLE_SNAPSHOT> snapshot_;
+    // rows written or read by key by the transaction, an empty value marks a removed row. Entries are only
+    // dropped by reset, so iterators can keep pointing to them.
+    std::map<ROW_REF, std::optional<ROW_REF>, ROW_LESS> delta_;
+    // incremented when a key is added to delta_
+    uint64_t version_ = 0;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Ordered index of a table as seen by a transaction. It refers to the shared index of the snapshot and
+ * stores only the entries of the rows that the transaction changed on top of it.
+ *
+ */
+class IndexView {
+  public:
+    /**
+     * @brief Iterates the entries of the view in order, in both directions
+     */
+    class const_iterator {
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::string;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string *;
+        using reference = const std::string &;
+
+        const_iterator() = default;
+
+        auto operator*() const -> const std::string &;
+        auto operator->() const -> const std::string *;
+        auto operator++() -> const_iterator &;
+        auto operator--() -> const_iterator &;
+        auto operator==(const const_iterator &other) const -> bool;
+        auto operator!=(const const_iterator &other) const -> bool;
+
+      private:
+        friend class IndexView;
+
+        const_iterator(const IndexView *view, ORDERED_INDEX::const_iterator base,
+                       ORDERED_INDEX::const_iterator added);
+        /**
+         * @brief Whether the current entry is the one of the shared index
+         */
+        auto in_base() const -> bool;
+        /**
+         * @brief Moves the iterator of the shared index past removed entries
+         */
+        void skip_removed();
+
+        const IndexView *view_ = nullptr;
+        // first entry of the shared index and of the added entries that is not smaller than the current one
+        ORDERED_INDEX::const_iterator base_;
+        ORDERED_INDEX::const_iterator added_;
+    };
+
+    /**
+     * @brief Creates the view of a shared index
+     *
+     * @param base The shared index of the snapshot
+     */
+    explicit IndexView(std::shared_ptr<const ORDERED_INDEX> base);
+
+    /**
+     * @brief Adds the entry of a row
+     */
+    void insert(const std::string &entry);
+    /**
+     * @brief Removes the entry of a row
+     */
+    void erase(const std::string &entry);
+
+    auto empty() const -> bool;
+    auto begin() const -> const_iterator;
+    auto end() const -> const_iterator;
+    auto lower_bound(const std::string &entry) const -> const_iterator;
+    auto upper_bound(const std::string &entry) const -> const_iterator;
+
+  private:
+    std::shared_ptr<const ORDERED_INDEX> base_;
+    // entries of the transaction that are not in the shared index
+    ORDERED_INDEX added_;
+    // entries of the shared index that the transaction removed
+    ORDERED_INDEX removed_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_TABLE_CACHE
@@ -0,0 +1,114 @@
+#ifndef BLOCKCHAIN_DB_TABLE_STATISTICS
+#define BLOCKCHAIN_DB_TABLE_STATISTICS
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace blockchain_db {
+
+/**
+ * @brief Struct that stores the statistics of one index of a bc-table.
+ *
+ * @param rec_per_key Average number of rows per distinct value of the first
+ * n+1 key parts
+ * @param histogram Index entries (sort keys of all key parts) at equally spaced
+ * positions of the ordered index, used to estimate the size of ranges
+ *
+ */
+struct INDEX_STATISTICS {
+  std::vector<double> rec_per_key;
+  std::vector<std::string> histogram;
+};
+
+/**
+ * @brief Struct that stores the statistics of a bc-table that ANALYZE TABLE
+ * computed.
+ *
+ * @param records Number of rows
+ * @param data_length Total size of keys and values of all rows in bytes
+ * @param indexes Statistics by index number
+ *
+ */
+struct TABLE_STATISTICS {
+  uint64_t records = 0;
+  uint64_t data_length = 0;
+  std::map<unsigned int, INDEX_STATISTICS> indexes;
+};
+
+/**
+ * @brief Process-wide store of the statistics of the bc-tables. It is filled
+ * by ANALYZE TABLE and used by the optimizer when the rows of a table are not
+ * cached.
+ *
+ * When a file is opened, the statistics are kept in it as one JSON object by
+ * table name, so that they survive a restart. The file is rewritten on every
+ * change, which only happens on ANALYZE TABLE and DROP TABLE.
+ *
+ */
+class StatisticsCache {
+  public:
+    /**
+     * @brief Get the statistics store of the process
+     *
+     * @return The statistics store
+     */
+    static auto instance() -> StatisticsCache &;
+
+    /**
+     * @brief Reads the statistics stored in a file and keeps the statistics
+     * in it from now on
+     *
+     * @param path Path of the file, created with the next change if it does
+     * not exist
+     * @return true if the file could be read or does not exist
+     */
+    auto open(const std::string &path) -> bool;
+
+    /**
+     * @brief Get the statistics of a table
+     *
+     * @param tablename Name of the table
+     * @return The statistics or nullptr if the table was not analyzed
+     */
+    auto get(const std::string &tablename)
+        -> std::shared_ptr<const TABLE_STATISTICS>;
+
+    /**
+     * @brief Store the statistics of a table, replacing older ones
+     *
+     * @param tablename Name of the table
+     * @param statistics The statistics to store
+     */
+    void put(const std::string &tablename,
+             std::shared_ptr<const TABLE_STATISTICS> statistics);
+
+    /**
+     * @brief Remove the statistics of a table, e.g. when it is dropped
+     *
+     * @param tablename Name of the table
+     */
+    void invalidate(const std::string &tablename);
+
+  private:
+    /**
+     * @brief Writes all statistics to a new file that replaces the file.
+     * Requires the lock.
+     */
+    auto save() -> bool;
+
+    std::mutex mutex_;
+    // File of the statistics, empty if they are only kept in memory
+    std::string path_;
+    // Statistics by full table name, e.g. "./db/table"
+    std::unordered_map<std::string, std::shared_ptr<const TABLE_STATISTICS>>
+        statistics_;
+};
+
+} // namespace blockchain_db
+
+#endif // BLOCKCHAIN_DB_TABLE_STATISTICS
@@ -5,8 +5,13 @@
 #include <vector>
 #include <unordered_map>
 #include <map>
+#include <memory>
+#include <set>
+#include <cstdint>
 #include <cstring>
 #include "adapter_factory/adapter_factory.h"
+#include "row_ref.h"
+#include "table_cache.h"
 using namespace std;
 
 namespace blockchain_db {
@@ -15,28 +20,84 @@ namespace blockchain_db {
  * @brief Enum to distinguish between different statements
  *
  */
-enum class STATEMENT_TYPE{WRITE, REMOVE};
+enum class STATEMENT_TYPE{WRITE, REMOVE, INSERT};
+
+/**
+ * @brief Bump allocator for the bytes of the statements of a transaction. The bytes are copied into large
+ * blocks, so a transaction with many statements is freed with a few deallocations.
+ *
+ */
+class RowArena {
+  public:
+    /**
+     * @brief Copies bytes into the arena
+     *
+     * @param data The bytes
+     * @param size Number of bytes
+     * @return Reference to the copy
+     */
+    auto copy(const unsigned char *data, size_t size) -> ROW_REF;
+
+  private:
+    // Size of a block, larger rows get a block of their own
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<unsigned char[]>> blocks_;
+    // Free bytes at the end of the last block
+    unsigned char *free_ = nullptr;
+    size_t free_size_ = 0;
+};
 
 /**
  * @brief Struct that stores a single statement.
  *
- * @param type Type of the statement (write or remove)
- * @param tablename The name of the table to which this statement will be applied
+ * @param type Type of the statement (write, remove or insert of a key whose existence is checked at commit)
+ * @param table ID of the table to which this statement will be applied, see Transaction::tableId
  * @param key The key that this statement targets
  * @param value The value of the write statement. Empty if it is remove statement
  *
  */
 struct STATEMENT{
   STATEMENT_TYPE type;
-  std::string tablename;
-  BYTES key;
-  BYTES value;
+  uint32_t table;
+  ROW_REF key;
+  ROW_REF value;
+};
+
+/**
+ * @brief Struct that stores the state of a table that is loaded lazily. The table cache of such a table only
+ * contains the rows that were read by key or written by the transaction.
+ *
+ * @param missing_keys Keys that are known to not exist, because they were not found or removed by the transaction
+ * @param lookups Number of reads by key from the blockchain, a batch of keys counts as one read
+ *
+ */
+struct PARTIAL_TABLE{
+  std::set<BYTES> missing_keys;
+  ulong lookups = 0;
+};
+
+/**
+ * @brief Struct that stores a table of the table cache as resolved by its handler once per statement, so
+ * that the rows of the statement do not look the table up by name.
+ *
+ * @param id ID of the table, see Transaction::tableId
+ * @param cache Table cache of the table, nullptr if the table is not in the table cache
+ * @param partial State of the table if it is loaded lazily, see Transaction::partialTable
+ * @param completed Number of tables that the transaction had loaded completely when the state was resolved
+ *
+ */
+struct TABLE_HANDLE{
+  uint32_t id = 0;
+  TableCache *cache = nullptr;
+  PARTIAL_TABLE *partial = nullptr;
+  uint64_t completed = 0;
 };
 
 /**
  * @brief Transaction class that is used in the blockchain storage engine to store all information while executing database statements.
  * When a transaction is startet the storage engine creates a new object of this class and adds all statements that are processed to it
- * and stores for each accessed table a copy in a table cache that is used until commit. When committing the list of statements is executed
+ * and keeps for each accessed table a view of the shared snapshot of the table in a table cache that is used until commit. When committing the list of statements is executed
  * and applied to the blockchain. When rolling back the transaction it is cleared and nothing is applied to the blockchain.
  *
  */
@@ -47,12 +108,13 @@ class Transaction {
      * @brief Adds a table to the table cache of this transaction
      *
      * @param tablename Name of the table
-     * @param table_map Table as map of strings (key, value)
+     * @param snapshot Shared snapshot of the table, it is not copied
      * @return 0 if success
      */
-    auto addTable(const std::string &tablename, std::map<BYTES, BYTES> &table_map) -> int;
+    auto addTable(const std::string &tablename, std::shared_ptr<const TABLE_SNAPSHOT> snapshot) -> int;
     /**
-     * @brief Adds a write statement to the statement list
+     * @brief Adds a write statement to the statement list. The statements of a table are applied to its
+     * table cache, which references their bytes.
      *
      * @param tablename Name of the table that statement belongs to
      * @param key The key of the write statement
@@ -68,13 +130,150 @@ class Transaction {
      * @return 0 if success
      */
     auto addRemove(const std::string &tablename, const BYTES &key) -> int;
+    /**
+     * @brief Adds an insert statement to the statement list. The key is only written if it does not
+     * exist on the blockchain, which is checked when committing.
+     *
+     * @param tablename Name of the table that statement belongs to
+     * @param key The key of the insert statement
+     * @param value The value of the insert statement
+     * @return 0 if success
+     */
+    auto addInsert(const std::string &tablename, BYTES &key, BYTES &value) -> int;
+    /**
+     * @brief Adds statements like addWrite, addRemove and addInsert for a table that was resolved with
+     * tableHandle
+     *
+     * @param table Handle of the table
+     * @param key The key of the statement
+     * @param value The value of the statement
+     * @return 0 if success
+     */
+    auto addWrite(const TABLE_HANDLE &table, const BYTES &key, const BYTES &value) -> int;
+    auto addRemove(const TABLE_HANDLE &table, const BYTES &key) -> int;
+    auto addInsert(const TABLE_HANDLE &table, const BYTES &key, const BYTES &value) -> int;
+    /**
+     * @brief Adds a row that was read by key from the blockchain to the table cache of a lazily loaded table
+     *
+     * @param tablename Name of the table
+     * @param key The key of the row
+     * @param value The value of the row
+     * @return 0 if success, 1 if the table is not in the table cache
+     */
+    auto addReadRow(const std::string &tablename, const BYTES &key, const BYTES &value) -> int;
+    /**
+     * @brief Adds a row that was read by key like addReadRow, for a table that was resolved with tableHandle
+     *
+     * @param table Handle of the table
+     * @param key The key of the row
+     * @param value The value of the row
+     */
+    void addReadRow(const TABLE_HANDLE &table, const BYTES &key, const BYTES &value);
+    /**
+     * @brief Adds a lazily loaded table to the table cache of this transaction
+     *
+     * @param tablename Name of the table
+     * @return 0 if success
+     */
+    auto addPartialTable(const std::string &tablename) -> int;
+    /**
+     * @brief Replaces the cache of a lazily loaded table by the complete table. The statements of the
+     * transaction are applied to the complete table, so that it contains all writes of the transaction.
+     *
+     * @param tablename Name of the table
+     * @param snapshot Shared snapshot of the complete table, it is not copied
+     * @return 0 if success
+     */
+    auto completeTable(const std::string &tablename, std::shared_ptr<const TABLE_SNAPSHOT> snapshot) -> int;
+
+    /**
+     * @brief Resolves a table of the table cache for a handler. The table gets an ID if it has none yet.
+     *
+     * @param tablename Name of the table
+     * @return Handle of the table, its cache is nullptr if the table is not in the table cache
+     */
+    auto tableHandle(const std::string &tablename) -> TABLE_HANDLE;
+    /**
+     * @brief Gets the state of a lazily loaded table. completeTable removes the state, so the state of
+     * the handle is resolved again if a table was loaded completely since the handle was resolved.
+     *
+     * @param table Handle of the table
+     * @return The state, nullptr if the table is loaded completely
+     */
+    auto partialTable(TABLE_HANDLE &table) -> PARTIAL_TABLE *;
+
+    /**
+     * @brief Gets the ID of a table that statements use instead of its name, the table gets an ID if it
+     * has none yet
+     *
+     * @param tablename Name of the table
+     * @return ID of the table
+     */
+    auto tableId(const std::string &tablename) -> uint32_t;
+    /**
+     * @brief Gets the ID of a table without giving it one
+     *
+     * @param tablename Name of the table
+     * @param[out] id ID of the table
+     * @return true if the table has an ID, i.e. the transaction has statements of it or it was resolved
+     * with tableHandle
+     */
+    auto findTableId(const std::string &tablename, uint32_t &id) const -> bool;
+    /**
+     * @brief Gets the name of a table
+     *
+     * @param id ID of the table
+     * @return Name of the table
+     */
+    auto tableName(uint32_t id) const -> const std::string &;
 
-    // List of statements of the transaction
+    // List of statements of the transaction, at most one per key of a table. A statement of a key that
+    // already has one replaces it, so the list holds the final state of every key the transaction changed.
+    // A key that is inserted and removed again has no statement. The order of the list is not kept.
+    // Keys and values are stored in the arena of the transaction.
     std::vector<STATEMENT> statements;
     // Cache holding all used tables of the transaction.
-    std::unordered_map<std::string, std::map<BYTES, BYTES>> table_cache;
+    std::unordered_map<std::string, TableCache> table_cache;
+    // Tables of the table cache that are not loaded completely
+    std::unordered_map<std::string, PARTIAL_TABLE> partial_tables;
+    // Ordered indexes of completely loaded tables by index number, the shared index of the snapshot with the
+    // rows of the transaction, set up when an index is used first
+    std::unordered_map<std::string, std::map<uint, IndexView>> table_indexes;
+    // Tables with bulk inserts, their writes are sent with as few blockchain transactions as possible
+    std::set<std::string> bulk_tables;
     // Counter of locks
     ulong lock_count=0;
+
+  private:
+    /**
+     * @brief Adds a statement to the statement list, or merges it with the statement of the same key
+     *
+     * @param type Type of the statement
+     * @param table ID of the table
+     * @param cache Table cache of the table, nullptr if the table is not in the table cache
+     * @param key The key of the statement
+     * @param value The value of the statement, nullptr for removes
+     */
+    void addStatement(STATEMENT_TYPE type, uint32_t table, TableCache *cache, const BYTES &key,
+                      const BYTES *value);
+    /**
+     * @brief Removes a statement from the statement list, the last statement takes its position. The
+     * caller removes the statement from the statement index.
+     *
+     * @param position Position of the statement
+     */
+    void dropStatement(size_t position);
+
+    // Keys and values of the statements and of the rows read by key, the table cache references them
+    RowArena arena;
+    // Names of the tables by ID
+    std::vector<std::string> table_names;
+    // IDs of the tables by name
+    std::unordered_map<std::string, uint32_t> table_ids;
+    // Position of the statement of every key in the list of statements, by table ID
+    std::vector<std::map<ROW_REF, size_t>> statement_index;
+    // Number of tables that were loaded completely by completeTable
+    uint64_t completed_tables = 0;
 };
 
 } // namespace blockchain_db
@@ -0,0 +1,94 @@
+#include "storage/blockchainDB/engine/include/adapter_registry.h"
+
+using namespace blockchain_db;
+
+auto AdapterRegistry::instance() -> AdapterRegistry &{
+    static AdapterRegistry registry;
+    return registry;
+}
+
+auto AdapterRegistry::shard(const std::string &tablename) -> SHARD &{
+    return shards_[std::hash<std::string>()(tablename) & (kShards - 1)];
+}
+
+auto AdapterRegistry::acquire(const std::string &tablename,
+                              const std::string &connection_string,
+                              const Factory &factory) -> std::shared_ptr<BcAdapter>{
+    SHARD &shard = this->shard(tablename);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(tablename);
+    // wait while another handler creates the adapter
+    while(it != shard.entries.end() && it->second.adapter == nullptr){
+        shard.created.wait(lock);
+        it = shard.entries.find(tablename);
+    }
+    if(it != shard.entries.end()){
+        if(it->second.connection_string == connection_string){
+            it->second.uses++;
+            return it->second.adapter;
+        }
+        // the table was created again with another connection string, holders of the old adapter
+        // keep it until they release it
+        shard.entries.erase(it);
+    }
+
+    // an entry without adapter makes other handlers of the table wait
+    shard.entries[tablename].connection_string = connection_string;
+    lock.unlock();
+    std::shared_ptr<BcAdapter> adapter = factory();
+    lock.lock();
+    it = shard.entries.find(tablename);
+    if(it != shard.entries.end() && it->second.adapter == nullptr){
+        if(adapter != nullptr){
+            it->second.adapter = adapter;
+            it->second.uses = 1;
+        } else {
+            shard.entries.erase(it);
+        }
+    }
+    shard.created.notify_all();
+    return adapter;
+}
+
+void AdapterRegistry::release(const std::string &tablename,
+                              const std::shared_ptr<BcAdapter> &adapter){
+    SHARD &shard = this->shard(tablename);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(tablename);
+    if(it == shard.entries.end() || it->second.adapter != adapter || it->second.uses == 0)
+        return;
+    // an adapter without open tables is removed, it is shut down when the last commit that still
+    // holds it is done
+    if(--it->second.uses == 0)
+        shard.entries.erase(it);
+}
+
+auto AdapterRegistry::find(const std::string &tablename) -> std::shared_ptr<BcAdapter>{
+    SHARD &shard = this->shard(tablename);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(tablename);
+    if(it == shard.entries.end())
+        return nullptr;
+    return it->second.adapter;
+}
+
+void AdapterRegistry::remove(const std::string &tablename){
+    SHARD &shard = this->shard(tablename);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(tablename);
+    // an adapter that is being created is registered by its creator
+    if(it != shard.entries.end() && it->second.adapter != nullptr)
+        shard.entries.erase(it);
+}
+
+void AdapterRegistry::clear(){
+    for(auto &shard : shards_){
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for(auto it = shard.entries.begin(); it != shard.entries.end();){
+            if(it->second.adapter != nullptr)
+                it = shard.entries.erase(it);
+            else
+                ++it;
+        }
+    }
+}
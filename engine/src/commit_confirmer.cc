@@ -0,0 +1,84 @@
+#include "storage/blockchainDB/engine/include/commit_confirmer.h"
+
+#include <algorithm>
+
+using namespace blockchain_db;
+
+auto CommitConfirmer::instance() -> CommitConfirmer &{
+    static CommitConfirmer confirmer;
+    return confirmer;
+}
+
+CommitConfirmer::~CommitConfirmer(){
+    stop();
+}
+
+void CommitConfirmer::set_finish_handler(FinishHandler handler){
+    std::lock_guard<std::mutex> lock(mutex_);
+    finish_handler_ = std::move(handler);
+}
+
+void CommitConfirmer::track(const std::string &tablename,
+                            std::shared_ptr<BcAdapter> adapter,
+                            const std::vector<PENDING_TRANSACTION> &transactions){
+    if(transactions.empty())
+        return;
+    std::vector<std::string> transaction_ids;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        auto now = std::chrono::system_clock::now();
+        for(const auto &transaction : transactions){
+            COMMIT_RECORD record;
+            record.tablename = tablename;
+            record.transaction_id = transaction.id;
+            record.submitted = now;
+            pending_.push_back(std::move(record));
+            transaction_ids.push_back(transaction.id);
+        }
+    }
+    // transactions of all tables of a node are watched with one poller, which
+    // reads their receipts together when a new block is mined
+    adapter->watch_transactions(transaction_ids, kMaxPendingTime,
+                                [this](const std::string &transaction_id, int state){
+                                    finish(transaction_id, state);
+                                });
+}
+
+auto CommitConfirmer::list() -> std::vector<COMMIT_RECORD>{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<COMMIT_RECORD> records;
+    records.reserve(pending_.size() + finished_.size());
+    records.insert(records.end(), pending_.begin(), pending_.end());
+    records.insert(records.end(), finished_.begin(), finished_.end());
+    return records;
+}
+
+void CommitConfirmer::stop(){
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    pending_.clear();
+}
+
+void CommitConfirmer::finish(const std::string &transaction_id, int state){
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = std::find_if(pending_.begin(), pending_.end(),
+                           [&](const COMMIT_RECORD &record){
+                               return record.transaction_id == transaction_id;
+                           });
+    if(stopping_ || it == pending_.end())
+        return;
+    // a transaction that was not mined in time is reported as failed
+    COMMIT_RECORD record = std::move(*it);
+    pending_.erase(it);
+    record.status = state == 0 ? COMMIT_STATUS::CONFIRMED : COMMIT_STATUS::FAILED;
+    record.finished = std::chrono::system_clock::now();
+    finished_.push_back(record);
+    if(finished_.size() > kHistorySize)
+        finished_.pop_front();
+
+    FinishHandler handler = finish_handler_;
+    lock.unlock();
+    if(handler)
+        handler(record);
+}
@@ -0,0 +1,467 @@
+#include "storage/blockchainDB/engine/include/commit_journal.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+#include "storage/blockchainDB/adapter/utils/include/adapter_utils/encoding_helpers.h"
+#include "storage/blockchainDB/adapter/utils/src/json.hpp"
+
+using namespace blockchain_db;
+
+/**
+ * @brief Decodes a hex string of the journal
+ */
+static auto hex_to_bytes(const std::string &hex) -> BYTES{
+    std::vector<unsigned char> data(hex.size() / 2);
+    hex_to_byte_array(hex, data.data());
+    return BYTES(data.data(), data.size());
+}
+
+/**
+ * @brief Writes a complete buffer to a file
+ */
+static auto write_all(int fd, const std::string &data) -> bool{
+    size_t written = 0;
+    while(written < data.size()){
+        ssize_t rc = ::write(fd, data.data() + written, data.size() - written);
+        if(rc < 0)
+            return false;
+        written += rc;
+    }
+    return true;
+}
+
+static auto begin_record(uint64_t id, const JOURNAL_ENTRY &entry) -> std::string{
+    nlohmann::json changes = nlohmann::json::array();
+    for(const auto &change : entry.changes){
+        const char *type = change.second.type == STATEMENT_TYPE::WRITE ? "w"
+                           : change.second.type == STATEMENT_TYPE::INSERT ? "i" : "r";
+        changes.push_back({type, byte_array_to_hex(change.first.value, change.first.size),
+                           byte_array_to_hex(change.second.value.value,
+                                             change.second.value.size)});
+    }
+    nlohmann::json record = {{"op", "begin"}, {"id", id},
+                             {"table", entry.tablename}, {"changes", changes}};
+    return record.dump();
+}
+
+static auto sent_record(uint64_t id, const JOURNAL_ENTRY &entry,
+                        bool failed) -> std::string{
+    nlohmann::json transactions = nlohmann::json::array();
+    for(const auto &transaction : entry.transactions)
+        transactions.push_back({transaction.id, transaction.nonce});
+    nlohmann::json record = {{"op", "sent"}, {"id", id},
+                             {"transactions", transactions}};
+    // a transaction of the entry failed before the journal was compacted
+    if(failed)
+        record["failed"] = true;
+    return record.dump();
+}
+
+auto CommitJournal::instance() -> CommitJournal &{
+    static CommitJournal journal;
+    return journal;
+}
+
+CommitJournal::~CommitJournal(){
+    close();
+}
+
+auto CommitJournal::open(const std::string &path) -> bool{
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    entries_.clear();
+    transaction_entries_.clear();
+    // entries with failed transactions, they can not be finished by receipts
+    std::map<uint64_t, bool> failed;
+
+    std::ifstream file(path_);
+    std::string line;
+    while(std::getline(file, line)){
+        auto record = nlohmann::json::parse(line, nullptr, false);
+        // a record that was not written completely ends the journal
+        if(!record.is_object() || !record.contains("op"))
+            break;
+        try{
+            const std::string op = record["op"];
+            if(op == "begin"){
+                uint64_t id = record["id"];
+                JOURNAL_ENTRY entry;
+                entry.tablename = record["table"];
+                for(const auto &change : record["changes"]){
+                    const std::string type = change[0];
+                    entry.changes[hex_to_bytes(change[1])] = {
+                        type == "w" ? STATEMENT_TYPE::WRITE
+                        : type == "i" ? STATEMENT_TYPE::INSERT : STATEMENT_TYPE::REMOVE,
+                        hex_to_bytes(change[2])};
+                }
+                add_entry(id, std::move(entry));
+                next_id_ = std::max(next_id_, id + 1);
+            } else if(op == "sent"){
+                auto it = entries_.find(record["id"].get<uint64_t>());
+                if(it == entries_.end())
+                    continue;
+                it->second.sent = true;
+                for(const auto &transaction : record["transactions"]){
+                    const std::string transaction_id = transaction[0];
+                    it->second.transactions.push_back({transaction_id, transaction[1]});
+                    transaction_entries_[transaction_id] = it->first;
+                }
+                if(record.value("failed", false))
+                    failed[it->first] = true;
+            } else if(op == "confirm"){
+                const std::string transaction_id = record["transaction"];
+                auto tx_it = transaction_entries_.find(transaction_id);
+                if(tx_it == transaction_entries_.end())
+                    continue;
+                uint64_t id = tx_it->second;
+                transaction_entries_.erase(tx_it);
+                auto it = entries_.find(id);
+                if(it == entries_.end())
+                    continue;
+                if(!record["ok"].get<bool>()){
+                    failed[id] = true;
+                    continue;
+                }
+                auto &transactions = it->second.transactions;
+                for(auto t = transactions.begin(); t != transactions.end(); t++){
+                    if(t->id == transaction_id){
+                        transactions.erase(t);
+                        break;
+                    }
+                }
+                if(transactions.empty() && !failed[id])
+                    entries_.erase(it);
+            } else if(op == "done" || op == "abort"){
+                entries_.erase(record["id"].get<uint64_t>());
+            }
+        } catch(nlohmann::detail::exception &){
+            break;
+        }
+    }
+    file.close();
+
+    for(auto &entry : entries_){
+        entry.second.recover = true;
+        // only a recovery can finish an entry with a failed transaction
+        if(failed[entry.first])
+            entry.second.sent = false;
+    }
+    return compact();
+}
+
+void CommitJournal::close(){
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(fd_ < 0)
+        return;
+    if(write_all(fd_, buffer_))
+        fdatasync(fd_);
+    buffer_.clear();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+auto CommitJournal::begin(const std::string &tablename,
+                          const Transaction &transaction) -> uint64_t{
+    JOURNAL_ENTRY entry;
+    entry.tablename = tablename;
+    uint32_t table;
+    if(transaction.findTableId(tablename, table)){
+        for(const auto &statement : transaction.statements){
+            if(statement.table == table)
+                entry.changes[statement.key.bytes()] = {statement.type, statement.value.bytes()};
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(fd_ < 0)
+        return 0;
+    uint64_t id = next_id_++;
+    append(begin_record(id, entry));
+    add_entry(id, std::move(entry));
+    return id;
+}
+
+void CommitJournal::sent(uint64_t id,
+                         const std::vector<PENDING_TRANSACTION> &transactions){
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(id);
+    if(fd_ < 0 || it == entries_.end())
+        return;
+    it->second.sent = true;
+    it->second.transactions = transactions;
+    append(sent_record(id, it->second, false));
+    if(transactions.empty()){
+        finish_entry(id);
+        return;
+    }
+    for(const auto &transaction : transactions)
+        transaction_entries_[transaction.id] = id;
+}
+
+void CommitJournal::finish(uint64_t id){
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(fd_ < 0 || entries_.count(id) == 0)
+        return;
+    finish_entry(id);
+}
+
+void CommitJournal::abort(uint64_t id){
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(fd_ < 0 || entries_.count(id) == 0)
+        return;
+    finish_entry(id, "abort");
+}
+
+void CommitJournal::transaction_finished(const std::string &transaction_id,
+                                         bool ok){
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto tx_it = transaction_entries_.find(transaction_id);
+    if(fd_ < 0 || tx_it == transaction_entries_.end())
+        return;
+    uint64_t id = tx_it->second;
+    transaction_entries_.erase(tx_it);
+    nlohmann::json record = {{"op", "confirm"}, {"transaction", transaction_id},
+                             {"ok", ok}};
+    append(record.dump());
+    auto it = entries_.find(id);
+    if(it == entries_.end())
+        return;
+    if(!ok){
+        // the entry stays until it is recovered after the next restart
+        it->second.sent = false;
+        return;
+    }
+    auto &transactions = it->second.transactions;
+    for(auto t = transactions.begin(); t != transactions.end(); t++){
+        if(t->id == transaction_id){
+            transactions.erase(t);
+            break;
+        }
+    }
+    if(transactions.empty() && it->second.sent)
+        finish_entry(id);
+}
+
+auto CommitJournal::sync() -> bool{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(fd_ < 0 || buffer_.empty())
+        return true;
+    if(!write_all(fd_, buffer_) || fdatasync(fd_) != 0){
+        // a partly written record would end the journal when it is read, it
+        // is cut off since the buffer is written again by the next sync
+        int rc = ftruncate(fd_, file_size_);
+        (void)rc;
+        return false;
+    }
+    file_size_ += buffer_.size();
+    buffer_.clear();
+    if(file_size_ > kCompactionSize)
+        compact();
+    return true;
+}
+
+void CommitJournal::discard(const std::vector<uint64_t> &ids){
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(fd_ < 0)
+        return;
+    std::set<uint64_t> discarded;
+    for(uint64_t id : ids){
+        auto it = entries_.find(id);
+        if(it == entries_.end())
+            continue;
+        for(const auto &transaction : it->second.transactions)
+            transaction_entries_.erase(transaction.id);
+        entries_.erase(it);
+        discarded.insert(id);
+    }
+    if(discarded.empty())
+        return;
+
+    // keep the records of other commits that are still buffered
+    std::string buffer;
+    size_t start = 0;
+    while(start < buffer_.size()){
+        size_t end = buffer_.find('\n', start);
+        std::string line = buffer_.substr(start, end - start);
+        start = end + 1;
+        auto record = nlohmann::json::parse(line, nullptr, false);
+        if(record.is_object() && record.value("op", "") == "begin" &&
+           discarded.count(record.value("id", uint64_t(0))) != 0)
+            continue;
+        buffer += line;
+        buffer += '\n';
+    }
+    buffer_ = std::move(buffer);
+}
+
+auto CommitJournal::recover(const std::string &tablename, BcAdapter *adapter,
+                            size_t batch_keys) -> size_t{
+    // take the entries of the table, so that they are recovered only once
+    std::vector<std::pair<uint64_t, JOURNAL_ENTRY>> recovering;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto &entry : entries_){
+            if(entry.second.recover && entry.second.tablename == tablename){
+                entry.second.recover = false;
+                recovering.emplace_back(entry.first, entry.second);
+            }
+        }
+    }
+    if(recovering.empty())
+        return 0;
+
+    // the receipts of the transactions of all entries are read together
+    std::vector<std::string> transaction_ids;
+    for(const auto &it : recovering){
+        if(!it.second.sent)
+            continue;
+        for(const auto &transaction : it.second.transactions)
+            transaction_ids.push_back(transaction.id);
+    }
+    std::unordered_map<std::string, int> statuses;
+    if(!transaction_ids.empty()){
+        std::vector<int> status = adapter->get_transaction_statuses(transaction_ids);
+        for(size_t i = 0; i < transaction_ids.size() && i < status.size(); i++)
+            statuses[transaction_ids[i]] = status[i];
+    }
+
+    size_t failed = 0;
+    for(auto &it : recovering){
+        JOURNAL_ENTRY &entry = it.second;
+        // if all transactions were mined, the changes are on the blockchain
+        bool mined = entry.sent;
+        for(const auto &transaction : entry.transactions){
+            if(!mined)
+                break;
+            auto status = statuses.find(transaction.id);
+            mined = status != statuses.end() && status->second == 0;
+        }
+
+        if(!mined && !entry.changes.empty()){
+            // compare the journaled keys with the blockchain
+            std::vector<BYTES> keys;
+            for(const auto &change : entry.changes)
+                keys.push_back(change.first);
+            std::map<const BYTES, BYTES> found;
+            bool ok = true;
+            for(size_t first = 0; first < keys.size() && ok; first += batch_keys){
+                std::vector<BYTES> batch(keys.begin() + first,
+                                         keys.begin() + std::min(keys.size(), first + batch_keys));
+                std::map<const BYTES, BYTES> batch_found;
+                ok = adapter->get_batch(batch, batch_found) == 0;
+                found.insert(batch_found.begin(), batch_found.end());
+            }
+            std::vector<BATCH_OPERATION> operations;
+            std::map<const BYTES, const BYTES> inserts;
+            for(const auto &change : entry.changes){
+                auto found_it = found.find(change.first);
+                if(change.second.type == STATEMENT_TYPE::REMOVE){
+                    if(found_it != found.end())
+                        operations.push_back({change.first, change.second.value, true});
+                } else if(change.second.type == STATEMENT_TYPE::INSERT){
+                    // an existing key was not inserted by the commit either
+                    if(found_it == found.end())
+                        inserts.emplace(change.first, change.second.value);
+                } else if(found_it == found.end() ||
+                          !(found_it->second == change.second.value)){
+                    operations.push_back({change.first, change.second.value, false});
+                }
+            }
+            std::vector<BYTES> existing_keys;
+            if(ok && !operations.empty())
+                ok = adapter->apply_batch(operations) == 0;
+            if(ok && !inserts.empty())
+                ok = adapter->put_if_absent(inserts, existing_keys) == 0;
+            mined = ok;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(entries_.count(it.first) == 0)
+            continue;
+        if(mined){
+            finish_entry(it.first);
+        } else {
+            // try again when the table is opened the next time
+            entries_[it.first].recover = true;
+            failed++;
+        }
+    }
+    sync();
+    return failed;
+}
+
+void CommitJournal::add_entry(uint64_t id, JOURNAL_ENTRY entry){
+    // the new entry decides the state of its keys
+    for(auto it = entries_.begin(); it != entries_.end();){
+        if(it->second.tablename == entry.tablename){
+            for(const auto &change : entry.changes)
+                it->second.changes.erase(change.first);
+        }
+        if(it->second.changes.empty()){
+            for(const auto &transaction : it->second.transactions)
+                transaction_entries_.erase(transaction.id);
+            it = entries_.erase(it);
+        } else {
+            it++;
+        }
+    }
+    entries_.emplace(id, std::move(entry));
+}
+
+void CommitJournal::finish_entry(uint64_t id, const char *op){
+    auto it = entries_.find(id);
+    for(const auto &transaction : it->second.transactions)
+        transaction_entries_.erase(transaction.id);
+    entries_.erase(it);
+    nlohmann::json record = {{"op", op}, {"id", id}};
+    append(record.dump());
+}
+
+auto CommitJournal::compact() -> bool{
+    if(fd_ >= 0){
+        write_all(fd_, buffer_);
+        ::close(fd_);
+        fd_ = -1;
+    }
+    buffer_.clear();
+
+    std::string records;
+    for(const auto &entry : entries_){
+        records += begin_record(entry.first, entry.second) + "\n";
+        // an entry that is not sent anymore has a failed transaction
+        if(entry.second.sent || !entry.second.transactions.empty())
+            records += sent_record(entry.first, entry.second, !entry.second.sent) + "\n";
+    }
+    // the new journal replaces the old one only when it is complete
+    std::string tmp_path = path_ + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if(fd < 0)
+        return false;
+    bool ok = write_all(fd, records) && fdatasync(fd) == 0;
+    ::close(fd);
+    if(!ok || std::rename(tmp_path.c_str(), path_.c_str()) != 0)
+        return false;
+    // the rename is only durable once the directory is on disk
+    size_t slash = path_.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : path_.substr(0, slash + 1);
+    int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if(dir_fd >= 0){
+        fsync(dir_fd);
+        ::close(dir_fd);
+    }
+
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_APPEND);
+    file_size_ = records.size();
+    return fd_ >= 0;
+}
+
+void CommitJournal::append(const std::string &record){
+    buffer_ += record;
+    buffer_ += '\n';
+}
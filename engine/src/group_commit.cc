@@ -0,0 +1,79 @@
+#include "storage/blockchainDB/engine/include/group_commit.h"
+
+#include <algorithm>
+
+using namespace blockchain_db;
+
+auto GroupCommit::instance() -> GroupCommit &{
+    static GroupCommit group_commit;
+    return group_commit;
+}
+
+auto GroupCommit::put(const std::string &tablename, BcAdapter *adapter,
+                      const std::map<const BYTES, const BYTES> &batch,
+                      std::chrono::milliseconds window, size_t max_rows) -> int{
+    std::unique_lock<std::mutex> lock(mutex_);
+    TABLE_QUEUE &queue = queues_[tablename];
+    // the rows of a key are written one after the other, a commit that writes
+    // a key of an earlier group joins a group after it
+    for(auto conflict = find_conflict(queue, batch); conflict != nullptr;
+        conflict = find_conflict(queue, batch))
+        conflict->finished.wait(lock, [&]{ return conflict->done; });
+
+    bool leader = queue.open == nullptr;
+    if(leader){
+        queue.open = std::make_shared<COMMIT_GROUP>();
+        queue.unfinished.push_back(queue.open);
+    }
+    std::shared_ptr<COMMIT_GROUP> group = queue.open;
+    group->batches.push_back(&batch);
+    group->rows.insert(batch.begin(), batch.end());
+    if(group->rows.size() >= max_rows){
+        queue.open = nullptr;
+        queue.closed.notify_all();
+    }
+
+    if(leader){
+        queue.closed.wait_for(lock, window, [&]{ return queue.open != group; });
+        if(queue.open == group)
+            queue.open = nullptr;
+        // new commits start the next group while this one is sent
+        std::map<const BYTES, const BYTES> rows;
+        rows.swap(group->rows);
+        lock.unlock();
+        // a single row is sent like without group commit
+        int result = rows.size() > 1 ? adapter->put_batch(rows) : adapter->put(rows);
+        lock.lock();
+        group->rows.swap(rows);
+        group->result = result;
+        group->done = true;
+        queue.unfinished.erase(std::find(queue.unfinished.begin(),
+                                         queue.unfinished.end(), group));
+        group->finished.notify_all();
+    } else {
+        group->finished.wait(lock, [&]{ return group->done; });
+    }
+
+    if(group->result == 0)
+        return 0;
+    // the adapter keeps the rows it could not write in the batch
+    for(const auto &row : batch){
+        if(group->rows.count(row.first) != 0)
+            return group->result;
+    }
+    return 0;
+}
+
+auto GroupCommit::find_conflict(const TABLE_QUEUE &queue,
+                                const std::map<const BYTES, const BYTES> &batch)
+    -> std::shared_ptr<COMMIT_GROUP>{
+    for(const auto &group : queue.unfinished){
+        for(const auto *member_batch : group->batches){
+            for(const auto &row : batch){
+                if(member_batch->count(row.first) != 0)
+                    return group;
+            }
+        }
+    }
+    return nullptr;
+}
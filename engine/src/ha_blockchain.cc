@@ -98,6 +98,8 @@
 
 #include <sql/sql_thd_internal_api.h>
 #include <sql/table.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <vector>
 
@@ -107,18 +109,24 @@
 #include <boost/algorithm/string.hpp>
 #include <string>
 #include <filesystem>
+#include <future>
 #include <regex>
 #include <set>
 #include <unordered_map>
 
 #include "my_sys.h"
+#include "mysqld_error.h"
 #include "mysql/components/services/log_builtins.h"
 #include "mysql/plugin.h"
 #include "sql/field.h"
+#include "sql/item.h"
+#include "sql/item_cmpfunc.h"
+#include "sql/key.h"
 #include "sql/mysqld.h" /* use mysql_real_data_home var (path to mysql data dir) */
 #include "sql/sql_base.h"
 #include "sql/sql_class.h"
 #include "sql/sql_plugin.h"
+#include "sql/sql_show.h"
 #include "sql/transaction.h"
 #include "typelib.h"
 
@@ -135,15 +143,36 @@
 
 using namespace rapidjson;
 handlerton *blockchain_hton;
-// Map of bc_adapters for open tables, <full_table_name, bc_adapter>
-static std::unordered_map<std::string, std::unique_ptr<BcAdapter>>
-    bc_adapter_map;
 
 // LOG-Tag for this class
 #define LOG_TAG "blockchain"
 
 // System variables for configuration
 static char *config_configuration_path;
+// number of blocks a cached table snapshot may lag behind the chain head
+static ulong config_snapshot_max_staleness;
+// how a transaction loads the bc-tables it uses
+enum bc_table_load_mode { BC_LOAD_SNAPSHOT, BC_LOAD_LAZY, BC_LOAD_ADAPTIVE };
+static ulong config_table_load_mode;
+// number of point lookups after which a lazily loaded table is read completely
+static ulong config_lazy_lookup_limit;
+// how a transaction checks that inserted keys do not exist yet
+enum bc_insert_mode { BC_INSERT_CHECKED, BC_INSERT_BLIND };
+static ulong config_insert_mode;
+// cost of one millisecond of blockchain latency in optimizer cost units
+static double config_latency_cost_per_ms;
+// whether a commit waits until its blockchain transactions are mined
+enum bc_commit_mode { BC_COMMIT_SYNC, BC_COMMIT_ASYNC };
+static ulong config_commit_mode;
+// time the first of concurrent commits waits for others to join its group
+static ulong config_group_commit_window;
+// number of rows that closes a commit group
+static ulong config_group_commit_max_rows;
+// number of entries of the histogram that ANALYZE TABLE builds for an index
+static const size_t INDEX_HISTOGRAM_SIZE = 128;
+// number of keys that one getBatch call reads, e.g. inserted keys that a
+// commit checks or the keys of a multi range read
+static const size_t DUPLICATE_CHECK_KEYS = 512;
 // path to mysql data dir
 const char *mysql_real_data_home_ptr = mysql_real_data_home;
 //~/mysql-server/build-debug/data/
@@ -165,6 +194,53 @@ static int blockchain_init_func(void *p) {
   blockchain_hton->rollback = ha_blockchain::bc_rollback;
   blockchain_hton->close_connection = ha_blockchain::bc_close_connection;
 
+  // Changes that are sent to the blockchain are journaled, the changes left
+  // over from before a restart are recovered when their tables are opened
+  std::string journal_path = mysql_real_data_home;
+  journal_path.append("blockchain_journal.log");
+  if (!CommitJournal::instance().open(journal_path)) {
+    LogErr(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+           ("BlockchainDB: can not write the journal " + journal_path +
+            ", commits are not recovered after a crash")
+               .c_str());
+  }
+
+  // Statistics of ANALYZE TABLE are kept next to the journal, so that the
+  // optimizer has them after a restart without analyzing the tables again
+  std::string statistics_path = mysql_real_data_home;
+  statistics_path.append("blockchain_statistics.json");
+  if (!StatisticsCache::instance().open(statistics_path)) {
+    LogErr(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+           ("BlockchainDB: can not read the statistics " + statistics_path +
+            ", the affected tables have to be analyzed again")
+               .c_str());
+  }
+
+  // Transactions of asynchronous commits that fail are logged, the state of
+  // their table on the blockchain is unknown then
+  CommitConfirmer::instance().set_finish_handler(
+      [](const COMMIT_RECORD &record) {
+        bool confirmed = record.status == COMMIT_STATUS::CONFIRMED;
+        CommitJournal::instance().transaction_finished(record.transaction_id,
+                                                       confirmed);
+        CommitJournal::instance().sync();
+        if (confirmed) return;
+        LogErr(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+               ("BlockchainDB: asynchronous commit of " + record.tablename +
+                " failed, transaction " + record.transaction_id +
+                " was not mined successfully")
+                   .c_str());
+        SnapshotCache::instance().invalidate(record.tablename);
+      });
+
+  return 0;
+}
+
+static int blockchain_deinit_func(void *) {
+  DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: blockchain_deinit_func"));
+  CommitConfirmer::instance().stop();
+  CommitJournal::instance().close();
+  AdapterRegistry::instance().clear();
   return 0;
 }
 
@@ -288,6 +364,170 @@ std::string get_path_to_file_with_table_metadata(
   return path_to_file;
 }
 
+/**
+ * @brief Get the time since a point in time
+ *
+ * @param[in] start Point in time
+ *
+ * @return Elapsed time in milliseconds
+ */
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * @brief Reads the number of the head of the chain, from the head monitor of
+ * the node if it is subscribed, otherwise with a request
+ *
+ * @param[in] bc_adapter Adapter of a table on the node
+ * @param[out] head_block_number Number of the head
+ *
+ * @return true if the head is known
+ */
+static bool read_head_block_number(BcAdapter *bc_adapter,
+                                   uint64_t &head_block_number) {
+  return bc_adapter->get_live_block_number(head_block_number) ||
+         bc_adapter->get_block_number(head_block_number) == 0;
+}
+
+/**
+ * @brief Get the complete content of a bc-table. The process-wide snapshot of
+ * the table is used if no (or not too many) new blocks were mined since it was
+ * read, otherwise the table is scanned and the snapshot is replaced.
+ *
+ * @param[in] bc_adapter Adapter of the table
+ * @param[in] full_table_name Table name in the format "./db_name/table_name"
+ * @param[in] cached_only Do not scan the table if there is no usable snapshot
+ * @param[in] endpoint Blockchain node of the table, for latency measurements
+ *
+ * @return Snapshot of the table or nullptr if the blockchain network is NOT
+ * available (or there is no usable snapshot and cached_only is set)
+ */
+static std::shared_ptr<const TABLE_SNAPSHOT> get_table_snapshot(
+    BcAdapter *bc_adapter, const std::string &full_table_name,
+    bool cached_only, const std::string &endpoint) {
+  // Reuse the shared snapshot of the table if no (or not too many) new
+  // blocks were mined since it was read
+  uint64_t head_block_number = 0;
+  bool head_known = bc_adapter->get_live_block_number(head_block_number);
+  if (!head_known) {
+    auto start = std::chrono::steady_clock::now();
+    head_known = bc_adapter->get_block_number(head_block_number) == 0;
+    if (head_known) {
+      LatencyModel::instance().record_call(endpoint, elapsed_ms(start));
+    }
+  }
+  std::shared_ptr<const TABLE_SNAPSHOT> snapshot;
+  if (head_known) {
+    snapshot = SnapshotCache::instance().get(
+        full_table_name, head_block_number, config_snapshot_max_staleness);
+  }
+  if (snapshot != nullptr) {
+    DBUG_PRINT(LOG_TAG, ("get_table_snapshot: reuse snapshot of block %lu",
+                         (ulong)snapshot->block_number));
+    return snapshot;
+  }
+  if (cached_only) {
+    return nullptr;
+  }
+
+  // Tablescan
+  std::map<const BYTES, BYTES> table_map;
+  auto start = std::chrono::steady_clock::now();
+  if ( (bc_adapter->get_all(table_map)) == -1 ) {
+    // blockchain network is NOT available
+    DBUG_PRINT(LOG_TAG,("get_table_snapshot: blockchain network is NOT available"));
+    return nullptr;
+  }
+  double scan_ms = elapsed_ms(start);
+
+  auto new_snapshot = std::make_shared<TABLE_SNAPSHOT>();
+  new_snapshot->block_number = head_block_number;
+  uint64_t scan_bytes = 0;
+  for (auto &entry : table_map) {
+    scan_bytes += entry.first.size + entry.second.size;
+    new_snapshot->rows->emplace(entry.first, entry.second);
+  }
+  new_snapshot->size = new_snapshot->rows->size();
+  LatencyModel::instance().record_scan(endpoint, scan_ms, scan_bytes);
+  // the head is read before the scan, so the snapshot is at least as
+  // recent as its block number
+  if (head_known) {
+    SnapshotCache::instance().put(full_table_name, new_snapshot);
+  }
+  return new_snapshot;
+}
+
+// Lower bound in the entries of an ordered index or of an index histogram
+static IndexView::const_iterator index_lower_bound(
+    const IndexView &entries, const std::string &prefix) {
+  return entries.lower_bound(prefix);
+}
+static std::vector<std::string>::const_iterator index_lower_bound(
+    const std::vector<std::string> &entries, const std::string &prefix) {
+  return std::lower_bound(entries.begin(), entries.end(), prefix);
+}
+
+/**
+ * @brief Get the first of sorted index entries that does not start with a
+ * prefix and is not smaller than it
+ *
+ * @param[in] entries Sorted index entries
+ * @param[in] prefix Sort keys of the first key parts
+ *
+ * @return First entry after all entries that start with the prefix
+ */
+template <class Entries>
+static auto index_prefix_end(const Entries &entries, std::string prefix)
+    -> typename Entries::const_iterator {
+  // The smallest string that is greater than all strings with the prefix
+  while (!prefix.empty() && static_cast<uchar>(prefix.back()) == 0xff) {
+    prefix.pop_back();
+  }
+  if (prefix.empty()) {
+    return entries.end();
+  }
+  prefix.back() = static_cast<char>(prefix.back() + 1);
+  return index_lower_bound(entries, prefix);
+}
+
+/**
+ * @brief Count the sorted index entries that lie between two search keys
+ *
+ * @param[in] entries Sorted index entries
+ * @param[in] min_key Lower bound or nullptr
+ * @param[in] min_prefix Lower bound in the format of the index entries
+ * @param[in] max_key Upper bound or nullptr
+ * @param[in] max_prefix Upper bound in the format of the index entries
+ *
+ * @return Number of entries in the range
+ */
+template <class Entries>
+static size_t count_index_range(const Entries &entries,
+                                const key_range *min_key,
+                                const std::string &min_prefix,
+                                const key_range *max_key,
+                                const std::string &max_prefix) {
+  auto lower = entries.begin();
+  auto upper = entries.end();
+  if (min_key != nullptr) {
+    lower = min_key->flag == HA_READ_AFTER_KEY
+                ? index_prefix_end(entries, min_prefix)
+                : index_lower_bound(entries, min_prefix);
+  }
+  if (max_key != nullptr) {
+    upper = max_key->flag == HA_READ_AFTER_KEY
+                ? index_prefix_end(entries, max_prefix)
+                : index_lower_bound(entries, max_prefix);
+  }
+  if (lower == entries.end() || (upper != entries.end() && !(*lower < *upper))) {
+    return 0;
+  }
+  return std::distance(lower, upper);
+}
+
 /**************************
  * Storage engine methods *
  **************************/
@@ -302,12 +542,6 @@ handler *ha_blockchain::bc_create_handler(handlerton *hton, TABLE_SHARE *table,
 int ha_blockchain::bc_commit(handlerton *, THD *thd, bool commit_trx) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: bc_commit"));
 
-  // test_print
-  for (auto it = bc_adapter_map.cbegin(); it != bc_adapter_map.cend(); ++it) {
-    DBUG_PRINT(LOG_TAG,
-               ("bc_commit: bc_adapter_map_key = %s", (*it).first.c_str() ));
-  }
-
   if (!commit_trx &&
       thd_test_options(thd, (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN))) {
     // Statement commit but in a transaction so nothing to do
@@ -321,89 +555,290 @@ int ha_blockchain::bc_commit(handlerton *, THD *thd, bool commit_trx) {
 
   if (txn == nullptr) return 0;
 
-  // intermediate data structure for batching write transactions.for every table
-  // we store all the write statements that operate on that table.
-  std::map<std::string, std::map<const BYTES, const BYTES>> write_batch_map;
-  // Loop over all statements and send them to the blockchain
-  for (unsigned int i = 0; i < txn->statements.size(); i++) {
-    std::string full_table_name = std::string(txn->statements[i].tablename);
-    std::string database_name =
-        full_table_name.substr(2, full_table_name.find_last_of('/') - 2);
-    std::string table_name = full_table_name.substr(
-        full_table_name.find_last_of('/') + 1, full_table_name.length());
-
-    // for tables on data_chain
-    std::string key_hex = byte_array_to_hex(txn->statements[i].key.value,
-                                              txn->statements[i].key.size);
-    DBUG_PRINT(LOG_TAG, ("bc_commit: i = %d", i));
-    DBUG_PRINT(LOG_TAG, ("bc_commit: txn->statements[i].key.c_str() = %s",
-                          key_hex.c_str()));
-
-    std::string key_str = key_hex.c_str();
-    // define bc_adapter_map_key for table name
-    std::string bc_adapter_map_key = full_table_name;
-    DBUG_PRINT(LOG_TAG, ("bc_commit: bc_adapter_map_key = %s",
-                          bc_adapter_map_key.c_str()));
-
-    auto it = bc_adapter_map.find(bc_adapter_map_key);
-
-    if (it == bc_adapter_map.end()) {
-      std::string tablename = std::string(txn->statements[i].tablename);
+  // an asynchronous commit returns when the node accepted the blockchain
+  // transactions, they are confirmed in the background
+  bool async_commit = config_commit_mode == BC_COMMIT_ASYNC;
+
+  // Adapter and outcome of every table of the transaction
+  struct TABLE_COMMIT {
+    // held while committing, the table may be closed or dropped meanwhile
+    std::shared_ptr<BcAdapter> bc_adapter;
+    // ID of the table in the transaction
+    uint32_t table_id;
+    // at least one statement could not be applied
+    bool failed = false;
+    // an inserted key already existed on the blockchain
+    bool duplicate_key = false;
+    // head of the chain when the statements were sent and after they were
+    // mined, 0 if unknown
+    bool track_head = false;
+    uint64_t sent_block_number = 0;
+    uint64_t mined_block_number = 0;
+    // wait mode of the writes and the transactions they left pending
+    WRITE_CONTEXT context;
+  };
+  std::map<std::string, TABLE_COMMIT> table_commits;
+  for (const auto &statement : txn->statements) {
+    const std::string &tablename = txn->tableName(statement.table);
+    if (table_commits.count(tablename) != 0) continue;
+    std::shared_ptr<BcAdapter> bc_adapter =
+        AdapterRegistry::instance().find(tablename);
+    if (bc_adapter == nullptr) {
       DBUG_PRINT(LOG_TAG,
                  ("BC_COMMIT: can't find bc_adapter for table_name = %s",
                   tablename.c_str()));
       return 1;
     }
-    std::map<std::string, std::map<const BYTES, const BYTES>>::iterator
-        table_it = write_batch_map.find(bc_adapter_map_key);
-    if (table_it == write_batch_map.end()) {
-      std::map<const BYTES, const BYTES> write_batch;
-      write_batch_map.emplace(bc_adapter_map_key, write_batch);
-      table_it = write_batch_map.find(bc_adapter_map_key);
-    }
-    // High level logic of the following lines:
-    // Assume the following transaction order (W=Write, R=Remove): W1, W2, R1,
-    // W3, W4, W5, R2 In this case, we batch W1 and W2 and send them together to
-    // the blockchain; then R1 is executed Afterwards, W3-W5 are batched and
-    // sent to the blockchain; lastly, R2 is executed
-    if (txn->statements[i].type == STATEMENT_TYPE::WRITE) {
-      size_t value_size = txn->statements[i].value.size;
-      // create BYTES struct from value
-      BYTES value_bytes = BYTES(txn->statements[i].value.value, value_size);
-      table_it->second.emplace(txn->statements[i].key, value_bytes);
-    } else if (txn->statements[i].type == STATEMENT_TYPE::REMOVE) {
-      // If a remove statement occurs, then first check if we have elements in
-      // the batch Add the elements in the batch to the blockchain and then
-      // clear the batch
-      if (table_it->second.size() != 0) {
-        it->second->put(table_it->second);
-        //if (!(it->second->put(table_it->second))) {
-          // blockchain network is NOT available
-        //  DBUG_PRINT(LOG_TAG,("bc_commit: blockchain network is NOT available"));
-        //  return 1;
-        //}
-        table_it->second.clear();
+    TABLE_COMMIT commit{bc_adapter, statement.table};
+    commit.context.wait_for_mining = !async_commit;
+    table_commits.emplace(tablename, std::move(commit));
+  }
+
+  // Inserted keys must not exist yet. They are checked before anything is
+  // sent, so that a duplicate key aborts the commit without changing any
+  // table. putIfAbsent checks them again when they are written, for rows
+  // that other writers insert meanwhile.
+  int check_rc = 0;
+  for (const auto &table_it : table_commits) {
+    std::vector<BYTES> insert_keys;
+    for (const auto &statement : txn->statements) {
+      if (statement.table == table_it.second.table_id &&
+          statement.type == STATEMENT_TYPE::INSERT) {
+        insert_keys.push_back(statement.key.bytes());
+      }
+    }
+    for (size_t first = 0; first < insert_keys.size() && check_rc == 0;
+         first += DUPLICATE_CHECK_KEYS) {
+      std::vector<BYTES> keys(
+          insert_keys.begin() + first,
+          insert_keys.begin() +
+              std::min(insert_keys.size(), first + DUPLICATE_CHECK_KEYS));
+      std::map<const BYTES, BYTES> existing;
+      if (table_it.second.bc_adapter->get_batch(keys, existing) != 0) {
+        check_rc = HA_ERR_NO_CONNECTION;
+      } else if (!existing.empty()) {
+        DBUG_PRINT(LOG_TAG, ("bc_commit: inserted key(s) of %s already exist",
+                             table_it.first.c_str()));
+        check_rc = HA_ERR_FOUND_DUPP_KEY;
       }
-      // Then the remove statement is executed afterwards
-      it->second->remove(txn->statements[i].key);
+    }
+    if (check_rc != 0) {
+      break;
     }
   }
-  // send all of the elements of write_batch to the blockchain
-  for (auto table_it = write_batch_map.begin();
-       table_it != write_batch_map.end(); table_it++) {
-    if (table_it->second.size() != 0) {
-      auto it = bc_adapter_map.find(table_it->first);
-      it->second->put(table_it->second);
-      //if (!(it->second->put(table_it->second))) {
-        // blockchain network is NOT available
-      //  DBUG_PRINT(LOG_TAG,("bc_commit: blockchain network is NOT available"));
-      //  return 1;
-      //}
+  if (check_rc != 0) {
+    delete txn;
+    thd->get_ha_data(blockchain_hton->slot)->ha_ptr = nullptr;
+    return check_rc;
+  }
+
+  // Journal the changes of every table before anything is sent, so that they
+  // can be recovered if the server stops before they are on the blockchain
+  std::map<std::string, uint64_t> journal_ids;
+  for (const auto &table_it : table_commits) {
+    journal_ids[table_it.first] =
+        CommitJournal::instance().begin(table_it.first, *txn);
+  }
+  if (!CommitJournal::instance().sync()) {
+    DBUG_PRINT(LOG_TAG, ("bc_commit: can not write the journal"));
+    // nothing was sent, the entries must not be recovered after a restart
+    std::vector<uint64_t> ids;
+    for (const auto &journal_it : journal_ids) {
+      ids.push_back(journal_it.second);
+    }
+    CommitJournal::instance().discard(ids);
+    delete txn;
+    thd->get_ha_data(blockchain_hton->slot)->ha_ptr = nullptr;
+    return 1;
+  }
+
+  // Send the statements of one table to the blockchain. The transaction holds
+  // the final state of every key, so the keys do not depend on each other and
+  // a table needs at most one batch of inserts and one of writes and removes.
+  // Inserts are sent first: if another writer inserted one of the keys since
+  // they were checked, the writes and removes of all tables are not sent.
+  auto send_inserts = [&](const std::string &table, TABLE_COMMIT &commit) {
+    BcAdapter *bc_adapter = commit.bc_adapter.get();
+    // the snapshot of the table stays current if a synchronous commit was
+    // mined right after it was read
+    commit.track_head = !async_commit &&
+                        SnapshotCache::instance().peek(table) != nullptr &&
+                        read_head_block_number(bc_adapter,
+                                               commit.sent_block_number);
+    // inserted keys must not exist yet
+    std::map<const BYTES, const BYTES> insert_batch;
+    for (const auto &statement : txn->statements) {
+      if (statement.table == commit.table_id &&
+          statement.type == STATEMENT_TYPE::INSERT) {
+        insert_batch.emplace(statement.key.bytes(), statement.value.bytes());
+      }
+    }
+    // existing keys are not overwritten
+    if (!insert_batch.empty()) {
+      std::vector<BYTES> existing_keys;
+      if (bc_adapter->put_if_absent(insert_batch, existing_keys) != 0) {
+        commit.failed = true;
+      } else if (!existing_keys.empty()) {
+        commit.duplicate_key = true;
+        commit.failed = true;
+      }
+    }
+  };
+  auto send_changes = [&](const std::string &table, TABLE_COMMIT &commit) {
+    BcAdapter *bc_adapter = commit.bc_adapter.get();
+    std::map<const BYTES, const BYTES> write_batch;
+    std::vector<BYTES> remove_batch;
+    for (const auto &statement : txn->statements) {
+      if (statement.table != commit.table_id) continue;
+      if (statement.type == STATEMENT_TYPE::WRITE) {
+        write_batch.emplace(statement.key.bytes(), statement.value.bytes());
+      } else if (statement.type == STATEMENT_TYPE::REMOVE) {
+        remove_batch.push_back(statement.key.bytes());
+      }
+    }
+    if (!remove_batch.empty() && !write_batch.empty() &&
+        txn->bulk_tables.count(table) == 0) {
+      // removes and writes are applied with the same transactions
+      std::vector<BATCH_OPERATION> operations;
+      operations.reserve(remove_batch.size() + write_batch.size());
+      for (const auto &key : remove_batch) {
+        operations.push_back({key, key, true});
+      }
+      for (const auto &row : write_batch) {
+        operations.push_back({row.first, row.second, false});
+      }
+      if (bc_adapter->apply_batch(operations, &commit.context) != 0) {
+        commit.failed = true;
+      }
+      write_batch.clear();
+    } else if (!remove_batch.empty() &&
+               bc_adapter->remove_batch(remove_batch, &commit.context) != 0) {
+      commit.failed = true;
+    }
+    // several rows are written with putBatch transactions. Small synchronous
+    // commits of concurrent sessions are merged into shared transactions, a
+    // commit that would close a group on its own is sent directly.
+    if (!write_batch.empty()) {
+      int rc;
+      if (txn->bulk_tables.count(table) == 0 && !async_commit &&
+          config_group_commit_window > 0 &&
+          write_batch.size() < config_group_commit_max_rows) {
+        rc = GroupCommit::instance().put(
+            table, bc_adapter, write_batch,
+            std::chrono::milliseconds(config_group_commit_window),
+            config_group_commit_max_rows);
+      } else if (txn->bulk_tables.count(table) != 0 || write_batch.size() > 1) {
+        rc = bc_adapter->put_batch(write_batch, &commit.context);
+      } else {
+        rc = bc_adapter->put(write_batch, &commit.context);
+      }
+      if (rc != 0) {
+        commit.failed = true;
+      }
+    }
+    uint64_t head_block_number = 0;
+    if (commit.track_head && !commit.failed &&
+        read_head_block_number(bc_adapter, head_block_number)) {
+      commit.mined_block_number = head_block_number;
+    }
+  };
+
+  // Tables are sent concurrently, so a transaction waits for the slowest
+  // table instead of the sum of all tables
+  auto send_tables = [&](const auto &send) {
+    if (table_commits.size() == 1) {
+      send(table_commits.begin()->first, table_commits.begin()->second);
+      return;
+    }
+    std::vector<std::future<void>> senders;
+    for (auto &table_it : table_commits) {
+      senders.push_back(std::async(std::launch::async, send,
+                                   std::cref(table_it.first),
+                                   std::ref(table_it.second)));
+    }
+    for (auto &sender : senders) {
+      sender.wait();
+    }
+  };
+  send_tables(send_inserts);
+  bool duplicate_key = false;
+  for (const auto &table_it : table_commits) {
+    duplicate_key = duplicate_key || table_it.second.duplicate_key;
+  }
+  if (duplicate_key) {
+    // The commit is aborted. The blockchain can not take back the rows that
+    // were inserted before the duplicate was found, in its table and in the
+    // other tables of the transaction, so those tables are read again. The
+    // journal entries are aborted, the commit must not be completed by a
+    // recovery either.
+    DBUG_PRINT(LOG_TAG, ("bc_commit: inserted key(s) were inserted by "
+                         "another writer, the commit is aborted"));
+    for (const auto &table_it : table_commits) {
+      CommitJournal::instance().abort(journal_ids[table_it.first]);
+      SnapshotCache::instance().invalidate(table_it.first);
+    }
+    CommitJournal::instance().sync();
+    delete txn;
+    thd->get_ha_data(blockchain_hton->slot)->ha_ptr = nullptr;
+    return HA_ERR_FOUND_DUPP_KEY;
+  }
+  send_tables(send_changes);
+
+  // tables for which at least one statement could not be applied
+  std::set<std::string> failed_tables;
+  for (const auto &table_it : table_commits) {
+    if (table_it.second.failed) {
+      failed_tables.insert(table_it.first);
+    }
+  }
+  // Hand the transactions that are not mined yet to the commit confirmer. The
+  // journal entry of a table is finished when its changes are on the
+  // blockchain. The commit of a failed table is reported as failed, so its
+  // entry is aborted and a recovery does not complete it after a restart.
+  for (const auto &table_it : table_commits) {
+    uint64_t journal_id = journal_ids[table_it.first];
+    bool failed = failed_tables.count(table_it.first) != 0;
+    if (failed) {
+      CommitJournal::instance().abort(journal_id);
+    }
+    if (async_commit) {
+      const auto &bc_adapter = table_it.second.bc_adapter;
+      const auto &transactions = table_it.second.context.pending_transactions;
+      if (!failed) {
+        CommitJournal::instance().sent(journal_id, transactions);
+      }
+      CommitConfirmer::instance().track(table_it.first, bc_adapter,
+                                        transactions);
+    } else if (!failed) {
+      CommitJournal::instance().finish(journal_id);
+    }
+  }
+  CommitJournal::instance().sync();
+  // Write the committed changes through to the shared table snapshots. If a
+  // table could not be written completely its state on the blockchain is
+  // unknown, so its snapshot has to be read again. The table cache refers to
+  // the snapshots, it is released first so that a snapshot no other
+  // transaction uses is changed in place instead of being copied.
+  txn->table_cache.clear();
+  for (auto table_it = table_commits.begin();
+       table_it != table_commits.end(); table_it++) {
+    if (failed_tables.count(table_it->first) != 0) {
+      SnapshotCache::instance().invalidate(table_it->first);
+    } else {
+      SnapshotCache::instance().apply(table_it->first, *txn,
+                                      table_it->second.sent_block_number,
+                                      table_it->second.mined_block_number);
     }
   }
   // Remove transaction
   delete txn;
   thd->get_ha_data(blockchain_hton->slot)->ha_ptr = nullptr;
+  // the other tables may be written, so the commit is applied partially
+  if (!failed_tables.empty()) {
+    DBUG_PRINT(LOG_TAG, ("bc_commit: %zu of %zu table(s) failed",
+                         failed_tables.size(), table_commits.size()));
+    return HA_ERR_INTERNAL_ERROR;
+  }
   return 0;
 }
 
@@ -634,6 +1069,14 @@ int ha_blockchain::open(const char *full_table_name, int, uint,
                         const dd::Table *) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: open"));
 
+  if (!(share = get_share())) return HA_ERR_OUT_OF_MEM;
+  // rows are positioned by their key
+  ref_length = MAX_BC_KEY_SIZE;
+
+  // the adapter is created by the first handler of the table
+  std::lock_guard<std::mutex> share_lock(share->mutex);
+  if (share->bc_adapter != nullptr) return 0;
+
   // get database name
   std::string db_name = std::string(full_table_name);
   db_name = db_name.substr(db_name.find_first_of('/') + 1,
@@ -693,17 +1136,26 @@ int ha_blockchain::open(const char *full_table_name, int, uint,
   const std::string table_address = connection_str_as_json["table_address"];
   DBUG_PRINT(LOG_TAG,( "open: table_address = %s", table_address.c_str() ));
                    
-  // create new adapter of type bc_type
-  std::unique_ptr<BcAdapter> bc_adapter;
-  if ( (bc_adapter = AdapterFactory::create_adapter(
-           AdapterFactory::getBC_TYPE(bc_type))) != nullptr ) {
+  // The adapter is created, connected and recovered only by the first open of
+  // the table, all later opens share it
+  std::string tablename = full_table_name;
+  auto create_adapter = [&]() -> std::shared_ptr<BcAdapter> {
+    // create new adapter of type bc_type
+    std::shared_ptr<BcAdapter> bc_adapter =
+        AdapterFactory::create_adapter(AdapterFactory::getBC_TYPE(bc_type));
+    if (bc_adapter == nullptr) {
+      // create adapter failed
+      DBUG_PRINT(LOG_TAG,("open: failed, can not create adapter of type %s",
+                           bc_type.c_str() ));
+      return nullptr;
+    }
 
     // initialize adapter
     DBUG_PRINT(LOG_TAG, ("open: initialize bc adapter"));
-    if (!bc_adapter->init(mysql_real_data_home, connection_string)) { 
+    if (!bc_adapter->init(mysql_real_data_home, connection_string)) {
       // initialize adapter failed
       DBUG_PRINT(LOG_TAG,("open: initialize bc adapter failed"));
-      return 1;
+      return nullptr;
     }
 
     // load table
@@ -711,20 +1163,33 @@ int ha_blockchain::open(const char *full_table_name, int, uint,
     DBUG_PRINT(LOG_TAG, ("open: opening table %s with address: %s",
                          table_name.c_str(), table_address.c_str() ));
 
-    // add adapter to adapter map
-    std::string bc_adapter_map_key = full_table_name;
-    bc_adapter_map.emplace(bc_adapter_map_key, std::move(bc_adapter));
-    // test print bc_adapter_map
-    for (auto it = bc_adapter_map.cbegin(); it != bc_adapter_map.cend(); ++it) {
-      DBUG_PRINT(LOG_TAG,(
-          "open: bc_adapter_map_key = %s", (*it).first.c_str() ));
+    // bring changes of commits that were interrupted by a restart onto the
+    // blockchain
+    size_t unrecovered = CommitJournal::instance().recover(
+        tablename, bc_adapter.get(), DUPLICATE_CHECK_KEYS);
+    if (unrecovered != 0) {
+      LogErr(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+             ("BlockchainDB: " + std::to_string(unrecovered) +
+              " journaled commit(s) of " + tablename +
+              " could not be recovered, retrying when the table is opened "
+              "again")
+                 .c_str());
+      SnapshotCache::instance().invalidate(tablename);
     }
-  } else {
-    // create adapter failed
-    DBUG_PRINT(LOG_TAG,("open: failed, can not create adapter of type %s",
-                         bc_type.c_str() ));
+    return bc_adapter;
+  };
+  share->bc_adapter = AdapterRegistry::instance().acquire(
+      tablename, connection_string, create_adapter);
+  if (share->bc_adapter == nullptr) {
     return 1;
   }
+
+  // tables on the same node share their latency measurements
+  share->endpoint =
+      bc_type + "@" +
+      connection_str_as_json.value("join-ip", nlohmann::json()).dump() + ":" +
+      connection_str_as_json.value("rpc-port", nlohmann::json()).dump();
+  share->full_table_name = tablename;
   return 0;
 }
 
@@ -745,21 +1210,28 @@ int ha_blockchain::open(const char *full_table_name, int, uint,
 int ha_blockchain::close() {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: close"));
   DBUG_PRINT(LOG_TAG, ("CLOSE: Table = %s", table->s->table_name.str));
-  std::stringstream full_table_name;
-  full_table_name << "./";
-  full_table_name << table->s->db.str;
-  full_table_name << "/";
-  full_table_name << table->s->table_name.str;
-
-  // Delete Adapter from map
-  auto it = bc_adapter_map.find(full_table_name.str());
-  if (it != bc_adapter_map.end()) {
-    it->second->shutdown();
-    bc_adapter_map.erase(it);
-  }
+  // the adapter is released with the share of the table
+  table_handle = TABLE_HANDLE();
   return 0;
 }
 
+BC_SHARE::~BC_SHARE() {
+  if (bc_adapter == nullptr) return;
+  // the adapter is removed from the registry when no share uses it anymore
+  AdapterRegistry::instance().release(full_table_name, bc_adapter);
+}
+
+BC_SHARE *ha_blockchain::get_share() {
+  BC_SHARE *tmp_share;
+  lock_shared_ha_data();
+  if (!(tmp_share = static_cast<BC_SHARE *>(get_ha_share_ptr()))) {
+    tmp_share = new BC_SHARE;
+    set_ha_share_ptr(static_cast<Handler_share *>(tmp_share));
+  }
+  unlock_shared_ha_data();
+  return tmp_share;
+}
+
 auto ha_blockchain::get_primary_key(const uchar *buf) -> BYTES {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: get_primary_key"));
   Field *key_field;
@@ -846,18 +1318,94 @@ int ha_blockchain::write_row(uchar *buf) {
   // Add write statement to transaction
   Transaction *txn = static_cast<Transaction *>(
       ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
-  std::stringstream full_table_name;
-  full_table_name << "./";
-  full_table_name << table->s->db.str;
-  full_table_name << "/";
-  full_table_name << table->s->table_name.str;
-  if (txn->table_cache.at(full_table_name.str()).find(key_bytes) !=
-      txn->table_cache.at(full_table_name.str()).end()) {
-    return HA_ERR_WRONG_COMMAND;
-  }
-  txn->addWrite(full_table_name.str(), key_bytes, value_bytes);
-  // Execute write in table cache of transaction
-  txn->table_cache.at(full_table_name.str())[key_bytes] = value_bytes;
+  const std::string &full_table_name = share->full_table_name;
+  const auto &table_cache = *table_handle.cache;
+  PARTIAL_TABLE *partial_table = txn->partialTable(table_handle);
+  // Blind insert: keys that the transaction does not know are checked by the
+  // blockchain when committing instead of being read now
+  if (config_insert_mode == BC_INSERT_BLIND && partial_table != nullptr &&
+      !table_cache.find(key_bytes).has_value() &&
+      partial_table->missing_keys.count(key_bytes) == 0) {
+    // the statement is executed in the table cache of the transaction as well
+    txn->addInsert(table_handle, key_bytes, value_bytes);
+    update_indexes(txn, full_table_name, key_bytes, std::nullopt,
+                   ROW_LESS::ref(value_bytes));
+    if (scan_active) {
+      scan_written_keys.insert(key_bytes);
+    }
+    return 0;
+  }
+  // Checked bulk insert: keys that have to be read from the blockchain are
+  // read together for up to DUPLICATE_CHECK_KEYS rows. The server handles
+  // duplicates of INSERT IGNORE, REPLACE and ON DUPLICATE KEY UPDATE per row,
+  // so their rows are checked one by one.
+  if (bulk_insert_active && !duplicates_handled && partial_table != nullptr &&
+      !table_cache.find(key_bytes).has_value() &&
+      partial_table->missing_keys.count(key_bytes) == 0) {
+    pending_inserts.emplace_back(key_bytes, value_bytes);
+    if (pending_inserts.size() < DUPLICATE_CHECK_KEYS) {
+      return 0;
+    }
+    return flush_pending_inserts();
+  }
+  // rows of the statement are inserted in order
+  if (!pending_inserts.empty()) {
+    int rc = flush_pending_inserts();
+    if (rc != 0) {
+      return rc;
+    }
+  }
+  return insert_row(txn, key_bytes, value_bytes);
+}
+
+int ha_blockchain::insert_row(Transaction *txn, const BYTES &key,
+                              const BYTES &value) {
+  const std::string &full_table_name = share->full_table_name;
+  ROW_REF existing_value;
+  int rc = lookup_row(txn, full_table_name, key, &existing_value);
+  if (rc == 0) {
+    // rows are identified by the primary key
+    errkey = table->s->primary_key;
+    return HA_ERR_FOUND_DUPP_KEY;
+  }
+  if (rc != HA_ERR_KEY_NOT_FOUND) {
+    return rc;
+  }
+  // the statement is executed in the table cache of the transaction as well
+  txn->addWrite(table_handle, key, value);
+  update_indexes(txn, full_table_name, key, std::nullopt,
+                 ROW_LESS::ref(value));
+  // A running scan must not return the new row
+  if (scan_active) {
+    scan_written_keys.insert(key);
+  }
+  return 0;
+}
+
+int ha_blockchain::flush_pending_inserts() {
+  std::vector<std::pair<BYTES, BYTES>> rows;
+  rows.swap(pending_inserts);
+  if (rows.empty()) {
+    return 0;
+  }
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  std::vector<BYTES> keys;
+  keys.reserve(rows.size());
+  for (const auto &row : rows) {
+    keys.push_back(row.first);
+  }
+  int rc = prefetch_rows(txn, keys);
+  if (rc != 0) {
+    return rc;
+  }
+  // duplicates within the rows are found in the table cache
+  for (const auto &row : rows) {
+    rc = insert_row(txn, row.first, row.second);
+    if (rc != 0) {
+      return rc;
+    }
+  }
   return 0;
 }
 
@@ -907,6 +1455,7 @@ int ha_blockchain::update_row(const uchar *old_data, uchar *new_data) {
 
   // Check if keys are still the same
   if (!(key_bytes_old == key_bytes_new)) {
+    delete[] value;
     delete_row(new_data);
     memcpy(new_data + initial_null_bytes, new_value_bytes.value,
            (table->s->reclength - initial_null_bytes));
@@ -918,15 +1467,21 @@ int ha_blockchain::update_row(const uchar *old_data, uchar *new_data) {
   // Add write statement to transaction
   Transaction *txn = static_cast<Transaction *>(
       ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
-  std::stringstream full_table_name;
-  full_table_name << "./";
-  full_table_name << table->s->db.str;
-  full_table_name << "/";
-  full_table_name << table->s->table_name.str;
-
-  txn->addWrite(full_table_name.str(), key_bytes_new, new_value_bytes);
-  // Execute write in table cache of transaction
-  txn->table_cache.at(full_table_name.str())[key_bytes_new] = new_value_bytes;
+  const std::string &full_table_name = share->full_table_name;
+
+  // restore the new row, it was overwritten to compute the old key
+  memcpy(new_data + initial_null_bytes, new_value_bytes.value,
+         (table->s->reclength - initial_null_bytes));
+  delete[] value;
+
+  // the old value stays valid when the statement is executed in the table
+  // cache of the transaction
+  std::optional<ROW_REF> old_value = table_handle.cache->find(key_bytes_new);
+  txn->addWrite(table_handle, key_bytes_new, new_value_bytes);
+  if (old_value.has_value()) {
+    update_indexes(txn, full_table_name, key_bytes_new, old_value,
+                   ROW_LESS::ref(new_value_bytes));
+  }
   return 0;
 }
 
@@ -961,14 +1516,18 @@ int ha_blockchain::delete_row(const uchar *buf) {
   // Add remove statement to transaction
   Transaction *txn = static_cast<Transaction *>(
       ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
-  std::stringstream full_table_name;
-  full_table_name << "./";
-  full_table_name << table->s->db.str;
-  full_table_name << "/";
-  full_table_name << table->s->table_name.str;
-  txn->addRemove(full_table_name.str(), key_bytes);
-  // Execute remove in table cache of transaction
-  txn->table_cache.at(full_table_name.str()).erase(key_bytes);
+  const std::string &full_table_name = share->full_table_name;
+  // the old value stays valid when the statement is executed in the table
+  // cache of the transaction
+  std::optional<ROW_REF> old_value = table_handle.cache->find(key_bytes);
+  txn->addRemove(table_handle, key_bytes);
+  if (old_value.has_value()) {
+    update_indexes(txn, full_table_name, key_bytes, old_value, std::nullopt);
+  }
+  PARTIAL_TABLE *partial_table = txn->partialTable(table_handle);
+  if (partial_table != nullptr) {
+    partial_table->missing_keys.insert(key_bytes);
+  }
   return 0;
 }
 
@@ -978,34 +1537,42 @@ int ha_blockchain::delete_row(const uchar *buf) {
   row if available. If the key value is null, begin at the first key of the
   index.
 */
-int ha_blockchain::index_read_map(uchar *buf, const uchar *key, key_part_map,
+int ha_blockchain::index_read_map(uchar *buf, const uchar *key,
+                                  key_part_map keypart_map,
                                   enum ha_rkey_function func) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: index_read_map"));
-  return index_read(buf, key, 0, func);
+  return index_read(buf, key,
+                    calculate_key_len(table, active_index, keypart_map), func);
 }
 
 /**
   @brief
   Used to read forward through the index.
 */
-int ha_blockchain::index_next(uchar *) {
+int ha_blockchain::index_next(uchar *buf) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: index_next"));
-  int rc;
-  // DBUG_TRACE;
-  rc = HA_ERR_WRONG_COMMAND;
-  return rc;
+  if (index_set == nullptr) {
+    return HA_ERR_END_OF_FILE;
+  }
+  // the entry of the current row may have been removed in the meantime
+  return read_index_entry(
+      next_matching_entry(index_set->upper_bound(index_current), true), buf);
 }
 
 /**
   @brief
   Used to read backwards through the index.
 */
-int ha_blockchain::index_prev(uchar *) {
+int ha_blockchain::index_prev(uchar *buf) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: index_prev"));
-  int rc;
-  // DBUG_TRACE;
-  rc = HA_ERR_WRONG_COMMAND;
-  return rc;
+  if (index_set == nullptr) {
+    return HA_ERR_END_OF_FILE;
+  }
+  auto it = index_set->lower_bound(index_current);
+  if (it == index_set->begin()) {
+    return HA_ERR_END_OF_FILE;
+  }
+  return read_index_entry(next_matching_entry(--it, false), buf);
 }
 
 /**
@@ -1018,12 +1585,13 @@ int ha_blockchain::index_prev(uchar *) {
   @see
   opt_range.cc, opt_sum.cc, sql_handler.cc and sql_select.cc
 */
-int ha_blockchain::index_first(uchar *) {
+int ha_blockchain::index_first(uchar *buf) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: index_first"));
-  int rc;
-  // DBUG_TRACE;
-  rc = HA_ERR_WRONG_COMMAND;
-  return rc;
+  int rc = init_index_cursor();
+  if (rc != 0) {
+    return rc;
+  }
+  return read_index_entry(next_matching_entry(index_set->begin(), true), buf);
 }
 
 /**
@@ -1036,12 +1604,17 @@ int ha_blockchain::index_first(uchar *) {
   @see
   opt_range.cc, opt_sum.cc, sql_handler.cc and sql_select.cc
 */
-int ha_blockchain::index_last(uchar *) {
+int ha_blockchain::index_last(uchar *buf) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: index_last"));
-  int rc;
-  // DBUG_TRACE;
-  rc = HA_ERR_WRONG_COMMAND;
-  return rc;
+  int rc = init_index_cursor();
+  if (rc != 0) {
+    return rc;
+  }
+  if (index_set->empty()) {
+    return HA_ERR_END_OF_FILE;
+  }
+  return read_index_entry(next_matching_entry(--index_set->end(), false),
+                          buf);
 }
 
 // BUG REPORT (please also refer to TDBT-307)
@@ -1056,107 +1629,166 @@ int ha_blockchain::index_last(uchar *) {
 // Byte would be sufficient for storing the length information n Bytes
 // representing the char sequence of the key
 // This difference requires a separate handling
-int ha_blockchain::index_read(uchar *buf, const uchar *key, uint,
+int ha_blockchain::index_read(uchar *buf, const uchar *key, uint key_len,
                               enum ha_rkey_function key_func) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: index_read"));
-  // allocate memory for the new pointer => MySQL library for allocating memory
-  // used
-  uchar *key_adj = (uchar *)my_malloc(
-      0, (sizeof(key) * table->key_info[table->s->primary_key].key_length),
-      MYF(0));
+  // Rows are stored by the hash of the primary key, so only complete primary
+  // keys can be read directly. All other reads use an ordered index.
+  if (key_func != HA_READ_KEY_EXACT || active_index != table->s->primary_key ||
+      key_len < table->key_info[active_index].key_length) {
+    return index_read_ordered(buf, key, key_len, key_func);
+  }
 
-  // copy the values of the key to the location where key_adj is pointing to
-  memcpy(key_adj, key, table->key_info[table->s->primary_key].key_length);
+  BYTES key_bytes = make_row_key(key);
 
-  // determine the size of the key
-  ulong key_size = 0;
-  Field *key_field;
-  uint16 initial_pos = 0;
-  if (table->key_info != nullptr) {
-    for (uint i = 0;
-         i < table->key_info[table->s->primary_key].user_defined_key_parts;
-         i++) {
-      key_field = table->key_info[table->s->primary_key].key_part[i].field;
-      key_size = key_field->pack_length();
-      // If the key_part is of type varchar and has less than 255 characters,
-      // then the key needs to be adjusted If the key has <= 255 chars, the
-      // key_size in Byte is: number_of_chars * 4 Byte + 1 Byte (the additional
-      // Byte indicates the number of chars that are used) If the key has > 255
-      // chars, the key_size in Byte is: number_of_chars * 4 Byte + 2 Byte (the
-      // additional 2 Byte indicate the number of chars that are used) and won't
-      // need adjustment. Hence, key_size % 4 will give us either 1 or 2 and
-      // therefore we know in which range the key size falls. The reason for "%
-      // 4" is that MySQL uses 4 Byte for representing one char.
-      if (key_field->type() == MYSQL_TYPE_VARCHAR && key_size % 4 == 1) {
-        // delete the second entry in the char array by shifting the following
-        // elements to the front by 1
-        memcpy(key_adj + initial_pos + 1, key_adj + initial_pos + 2,
-               table->key_info[table->s->primary_key].key_length - initial_pos -
-                   2);
-      }
-      initial_pos += key_size;
-    }
-    key_size = initial_pos;
+  // Get table cache of transaction
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  const std::string &full_table_name = share->full_table_name;
+
+  ROW_REF value;
+  int rc = lookup_row(txn, full_table_name, key_bytes, &value);
+
+  // a row that does not match the pushed condition is not found
+  if (rc == 0 && !row_filter.empty() && !row_filter.matches(value)) {
+    rc = HA_ERR_KEY_NOT_FOUND;
   }
 
-  // get a new thread which is then used to get the name of the database that is
-  // used
-  THD *thd = ha_thd();
-  std::string db_name = std::string(thd->db().str);
-  // create string that contains a string in the format: "./db_name/table_name"
-  std::string db_str = "./" + db_name + "/" + table->alias;
+  // if an element was found, then copy the value into the buffer
+  if (rc == 0) {
+    read_row(value, buf);
+    memset(current_key, 0, ref_length);
+    memcpy(current_key, key_bytes.value,
+           std::min<size_t>(key_bytes.size, ref_length));
+  }
+
+  return rc;
+}
 
-  // Check that exact match is required
-  if (key_func != HA_READ_KEY_EXACT) {
-    return HA_ERR_WRONG_COMMAND;
+///////// Multi range read operations ////////////////////
+
+ha_rows ha_blockchain::multi_range_read_info_const(
+    uint keyno, RANGE_SEQ_IF *seq, void *seq_init_param, uint n_ranges,
+    uint *bufsz, uint *flags, bool *force_default_mrr, Cost_estimate *cost) {
+  ha_rows rows = handler::multi_range_read_info_const(
+      keyno, seq, seq_init_param, n_ranges, bufsz, flags, force_default_mrr,
+      cost);
+  if (rows != HA_POS_ERROR && !*force_default_mrr) {
+    choose_mrr_impl(keyno, flags);
   }
-  // check that used index uses first column or uses the primary key of the
-  // table
-  KEY key_used = table->key_info[active_index];
-  if (key_used.key_part->field !=
-          table->key_info[table->s->primary_key].key_part->field &&
-      key_used.key_part->field != *(table->field)) {
-    return HA_ERR_WRONG_COMMAND;
+  return rows;
+}
+
+ha_rows ha_blockchain::multi_range_read_info(uint keyno, uint n_ranges,
+                                             uint keys, uint *bufsz,
+                                             uint *flags,
+                                             Cost_estimate *cost) {
+  ha_rows rows =
+      handler::multi_range_read_info(keyno, n_ranges, keys, bufsz, flags, cost);
+  choose_mrr_impl(keyno, flags);
+  return rows;
+}
+
+void ha_blockchain::choose_mrr_impl(uint keyno, uint *flags) {
+  if (keyno == table->s->primary_key &&
+      ha_thd()->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR)) {
+    *flags &= ~HA_MRR_USE_DEFAULT_IMPL;
   }
+}
 
-  // determine the number of leading null bytes in the resulting array
-  uint initial_null_bytes = table->s->null_bytes;
+int ha_blockchain::multi_range_read_init(RANGE_SEQ_IF *seq,
+                                         void *seq_init_param, uint n_ranges,
+                                         uint mode, HANDLER_BUFFER *buf) {
+  DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: multi_range_read_init"));
+  batch_keys.clear();
+  batch_pos = 0;
+  batch_read_active = false;
+
+  if (!(mode & HA_MRR_USE_DEFAULT_IMPL) &&
+      active_index == table->s->primary_key) {
+    // Collect the ranges, all of them have to be complete primary keys
+    uint key_length = table->key_info[active_index].key_length;
+    range_seq_t seq_it = seq->init(seq_init_param, n_ranges, mode);
+    KEY_MULTI_RANGE range;
+    bool all_keys = true;
+    while (!seq->next(seq_it, &range)) {
+      if (!(range.range_flag & EQ_RANGE) ||
+          range.start_key.flag != HA_READ_KEY_EXACT ||
+          range.start_key.length < key_length) {
+        all_keys = false;
+        break;
+      }
+      batch_keys.emplace_back(make_row_key(range.start_key.key), range.ptr);
+    }
 
-  // set all elements of buf (=record) to 0
-  memset(buf, 0, table->s->reclength);
+    if (all_keys) {
+      Transaction *txn = static_cast<Transaction *>(
+          ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
 
-  // transform the key that is to be found from byte representation to hex
-  // representation
-  unsigned char key_hash[HASH_SIZE];
-  unsigned int hash_size;
-  hash_sha256(key_adj, key_size, key_hash, &hash_size);
-  BYTES key_bytes = BYTES(key_hash, hash_size);
+      std::vector<BYTES> keys;
+      keys.reserve(batch_keys.size());
+      for (const auto &entry : batch_keys) {
+        keys.push_back(entry.first);
+      }
+      int rc = prefetch_rows(txn, keys);
+      if (rc != 0) {
+        batch_keys.clear();
+        return rc;
+      }
 
-  // Get table cache of transaction
-  Transaction *txn = static_cast<Transaction *>(
-      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
-  std::stringstream full_table_name;
-  full_table_name << "./";
-  full_table_name << table->s->db.str;
-  full_table_name << "/";
-  full_table_name << table->s->table_name.str;
+      batch_seq = *seq;
+      batch_seq_it = seq_it;
+      batch_mode = mode;
+      batch_read_active = true;
+      return 0;
+    }
+    batch_keys.clear();
+  }
 
-  auto table_cache = txn->table_cache.at(full_table_name.str());
-  auto result_it = table_cache.find(key_bytes);
+  return handler::multi_range_read_init(seq, seq_init_param, n_ranges, mode,
+                                        buf);
+}
 
-  // if an element was found, then value result is non empty and further
-  // processing is necessary
-  if (result_it != table_cache.end()) {
-    // copy the value into the buffer
-    memcpy(buf + initial_null_bytes, result_it->second.value,
-           result_it->second.size);
+int ha_blockchain::multi_range_read_next(char **range_info) {
+  if (!batch_read_active) {
+    return handler::multi_range_read_next(range_info);
   }
 
-  // free the memory that was used for storing the adjusted key pointer => MySQL
-  // library for allocating memory used
-  my_free(key_adj);
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  const std::string &full_table_name = share->full_table_name;
+
+  // rows are returned in the order of the ranges
+  while (batch_pos < batch_keys.size()) {
+    const auto &entry = batch_keys[batch_pos++];
+    if (!(batch_mode & HA_MRR_NO_ASSOCIATION) &&
+        batch_seq.skip_record != nullptr &&
+        batch_seq.skip_record(batch_seq_it, entry.second, nullptr)) {
+      continue;
+    }
 
-  return 0;
+    ROW_REF value;
+    int rc = lookup_row(txn, full_table_name, entry.first, &value);
+    if (rc == HA_ERR_KEY_NOT_FOUND) {
+      continue;
+    }
+    if (rc != 0) {
+      return rc;
+    }
+    if (!row_filter.empty() && !row_filter.matches(value)) {
+      continue;
+    }
+
+    read_row(value, table->record[0]);
+    memset(current_key, 0, ref_length);
+    memcpy(current_key, entry.first.value,
+           std::min<size_t>(entry.first.size, ref_length));
+    if (!(batch_mode & HA_MRR_NO_ASSOCIATION)) {
+      *range_info = entry.second;
+    }
+    return 0;
+  }
+  return HA_ERR_END_OF_FILE;
 }
 
 ///////// Tablescan operations ////////////////////
@@ -1180,24 +1812,28 @@ int ha_blockchain::rnd_init(bool) {
   //  DBUG_TRACE;
   //  DBUG_PRINT(LOG_TAG, ("RND_INIT:"));
 
-  // Position in result vector
-  current_position = -1;
-
   // Get table cache of transaction
   Transaction *txn = static_cast<Transaction *>(
       ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
-  std::stringstream full_table_name;
-  full_table_name << "./";
-  full_table_name << table->s->db.str;
-  full_table_name << "/";
-  full_table_name << table->s->table_name.str;
+  const std::string &full_table_name = share->full_table_name;
 
-  auto table_cache = txn->table_cache.at(full_table_name.str());
-  for (auto entry : table_cache) {
-    auto tuple = std::make_tuple(entry.first, entry.second);
-    all_items.push_back(tuple);
+  // A scan needs the complete table
+  int rc = ensure_table_loaded(txn, full_table_name);
+  if (rc != 0) {
+    return rc;
   }
 
+  // Position the cursor at the first row of the cached table; rows are read
+  // from the shared snapshot and the changes of the transaction directly and
+  // are not copied
+  const auto &table_cache = *table_handle.cache;
+  scan_it = table_cache.begin();
+  scan_end = table_cache.end();
+  scan_written_keys.clear();
+  scan_batch.clear();
+  scan_batch_pos = 0;
+  scan_active = true;
+
   return 0;
 }
 
@@ -1206,8 +1842,11 @@ int ha_blockchain::rnd_end() {
   //  DBUG_TRACE;
   //  DBUG_PRINT(LOG_TAG, ("RND_END:"));
 
-  // Clear read cache
-  all_items.clear();
+  // Close cursor
+  scan_active = false;
+  scan_written_keys.clear();
+  scan_batch.clear();
+  scan_batch_pos = 0;
 
   return 0;
 }
@@ -1231,11 +1870,6 @@ int ha_blockchain::rnd_next(uchar *buf) {
   // DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: rnd_next"));
   //  DBUG_TRACE;
 
-  current_position++;  // necessary to do before fetching row so that
-                       // position() still works
-
-  // DBUG_PRINT(LOG_TAG, ("RND_NEXT: position=%llu", current_position));
-
   return find_current_row(buf);
 }
 
@@ -1263,8 +1897,8 @@ int ha_blockchain::rnd_next(uchar *buf) {
 void ha_blockchain::position(const uchar *) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: position"));
   // DBUG_TRACE;
-  // DBUG_PRINT(LOG_TAG, ("POSITION: %llu", current_position));
-  my_store_ptr(ref, ref_length, current_position);
+  // The position of a row is its key
+  memcpy(ref, current_key, ref_length);
 }
 
 /**
@@ -1285,11 +1919,15 @@ int ha_blockchain::rnd_pos(uchar *buf, uchar *pos) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: rnd_pos"));
   // DBUG_TRACE;
 
-  auto position = my_get_ptr(pos, ref_length);
-
-  // DBUG_PRINT(LOG_TAG, ("RND_POS: pos=%llu", position));
+  // Get table cache of transaction
+  const auto &table_cache = *table_handle.cache;
+  std::optional<ROW_REF> value = table_cache.find(ROW_REF{pos, ref_length});
+  if (!value.has_value()) {
+    return HA_ERR_KEY_NOT_FOUND;
+  }
+  memcpy(current_key, pos, ref_length);
 
-  return find_row(position, buf);
+  return read_row(*value, buf);
 }
 
 /**
@@ -1330,13 +1968,168 @@ int ha_blockchain::rnd_pos(uchar *buf, uchar *pos) {
   sql_select.cc, sql_select.cc, sql_show.cc, sql_show.cc, sql_show.cc,
   sql_show.cc, sql_table.cc, sql_union.cc and sql_update.cc
 */
-int ha_blockchain::info(uint) {
+const Item *ha_blockchain::cond_push(const Item *cond, bool) {
+  DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: cond_push"));
+  row_filter.clear();
+  // a filtered scan evaluates rows ahead of the cursor, which is only safe
+  // while the statement does not change the table
+  if (thd_sql_command(ha_thd()) != SQLCOM_SELECT) {
+    return cond;
+  }
+
+  bool pushed_all = true;
+  if (cond->type() == Item::COND_ITEM &&
+      down_cast<const Item_cond *>(cond)->functype() ==
+          Item_func::COND_AND_FUNC) {
+    List_iterator<Item> it(
+        *const_cast<Item_cond *>(down_cast<const Item_cond *>(cond))
+             ->argument_list());
+    while (const Item *item = it++) {
+      pushed_all = push_predicate(item) && pushed_all;
+    }
+  } else {
+    pushed_all = push_predicate(cond);
+  }
+  return pushed_all ? nullptr : cond;
+}
+
+int ha_blockchain::reset() {
+  // the pushed condition only applies to the statement
+  row_filter.clear();
+  duplicates_handled = false;
+  scan_batch.clear();
+  scan_batch_pos = 0;
+  return 0;
+}
+
+int ha_blockchain::info(uint flag) {
   // DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: info"));
   //  DBUG_TRACE;
-  stats.records = 10;
+  const std::string &full_table_name = share->full_table_name;
+  auto statistics = StatisticsCache::instance().get(full_table_name);
+
+  if (flag & HA_STATUS_VARIABLE) {
+    // Count the rows of the transaction or of the shared snapshot, use the
+    // statistics of ANALYZE TABLE if the table is not cached
+    Transaction *txn = static_cast<Transaction *>(
+        ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+    std::shared_ptr<const TABLE_SNAPSHOT> snapshot;
+    bool counted = true;
+    if (txn != nullptr &&
+        txn->partial_tables.count(full_table_name) == 0 &&
+        txn->table_cache.count(full_table_name) != 0) {
+      stats.records = txn->table_cache.at(full_table_name).size();
+    } else if ((snapshot = SnapshotCache::instance().peek(
+                    full_table_name)) != nullptr) {
+      stats.records = snapshot->size;
+    } else {
+      counted = false;
+    }
+
+    if (counted) {
+      // all values have the size of a record without null bytes
+      stats.data_file_length =
+          stats.records *
+          (table->s->reclength - table->s->null_bytes + MAX_BC_KEY_SIZE);
+    } else if (statistics != nullptr) {
+      stats.records = statistics->records;
+      stats.data_file_length = statistics->data_length;
+    } else {
+      // unknown size, the table was neither read nor analyzed
+      stats.records = 10;
+      stats.data_file_length = 0;
+    }
+    stats.mean_rec_length =
+        stats.records == 0 ? 0 : stats.data_file_length / stats.records;
+  }
+
+  if ((flag & HA_STATUS_CONST) && statistics != nullptr) {
+    for (uint i = 0; i < table->s->keys; i++) {
+      auto index_it = statistics->indexes.find(i);
+      if (index_it == statistics->indexes.end()) {
+        continue;
+      }
+      KEY &key_info = table->key_info[i];
+      const auto &rec_per_key = index_it->second.rec_per_key;
+      for (uint j = 0;
+           j < key_info.user_defined_key_parts && j < rec_per_key.size(); j++) {
+        key_info.rec_per_key[j] =
+            std::max<ulong>(1, static_cast<ulong>(rec_per_key[j]));
+        if (key_info.supports_records_per_key()) {
+          key_info.set_records_per_key(
+              j, static_cast<rec_per_key_t>(rec_per_key[j]));
+        }
+      }
+    }
+  }
   return 0;
 }
 
+/**
+  @brief
+  analyze() reads the complete table and computes the number of rows per key
+  prefix and a histogram of every index.
+*/
+int ha_blockchain::analyze(THD *, HA_CHECK_OPT *) {
+  DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: analyze"));
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  const std::string &full_table_name = share->full_table_name;
+
+  if (txn == nullptr ||
+      txn->table_cache.count(full_table_name) == 0 ||
+      ensure_table_loaded(txn, full_table_name) != 0) {
+    return HA_ADMIN_FAILED;
+  }
+  const auto &rows = txn->table_cache.at(full_table_name);
+
+  auto statistics = std::make_shared<TABLE_STATISTICS>();
+  statistics->records = rows.size();
+  statistics->data_length =
+      statistics->records *
+      (table->s->reclength - table->s->null_bytes + MAX_BC_KEY_SIZE);
+
+  index_record.resize(table->s->reclength);
+  for (uint i = 0; i < table->s->keys; i++) {
+    uint key_parts = table->key_info[i].user_defined_key_parts;
+    std::vector<std::string> entries;
+    entries.reserve(rows.size());
+    for (auto row = rows.begin(); row != rows.end(); ++row) {
+      find_row(row.value(), index_record.data());
+      entries.push_back(
+          make_index_entry(i, index_record.data(), key_parts));
+    }
+    std::sort(entries.begin(), entries.end());
+
+    INDEX_STATISTICS &index_statistics = statistics->indexes[i];
+    // Entries have a fixed size, so each key prefix has a fixed length
+    for (uint j = 0; j < key_parts; j++) {
+      size_t prefix_length =
+          make_index_entry(i, index_record.data(), j + 1).size();
+      size_t distinct = entries.empty() ? 0 : 1;
+      for (size_t k = 1; k < entries.size(); k++) {
+        if (entries[k].compare(0, prefix_length, entries[k - 1], 0,
+                               prefix_length) != 0) {
+          distinct++;
+        }
+      }
+      index_statistics.rec_per_key.push_back(
+          distinct == 0 ? 1.0
+                        : static_cast<double>(entries.size()) / distinct);
+    }
+    // Equi-depth histogram
+    size_t buckets = std::min(INDEX_HISTOGRAM_SIZE, entries.size());
+    for (size_t b = 0; b < buckets; b++) {
+      index_statistics.histogram.push_back(
+          entries[b * entries.size() / buckets]);
+    }
+  }
+
+  StatisticsCache::instance().put(full_table_name, statistics);
+  info(HA_STATUS_CONST | HA_STATUS_VARIABLE);
+  return HA_ADMIN_OK;
+}
+
 /**
   @brief
   extra() is called whenever the server wishes to send a hint to
@@ -1346,12 +2139,50 @@ int ha_blockchain::info(uint) {
     @see
   ha_innodb.cc
 */
-int ha_blockchain::extra(enum ha_extra_function) {
+int ha_blockchain::extra(enum ha_extra_function operation) {
   // DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: extra"));
   //  DBUG_TRACE;
+  switch (operation) {
+    case HA_EXTRA_WRITE_CACHE:
+      mark_bulk_insert(0);
+      break;
+    case HA_EXTRA_IGNORE_DUP_KEY:
+    case HA_EXTRA_WRITE_CAN_REPLACE:
+    case HA_EXTRA_INSERT_WITH_UPDATE:
+      duplicates_handled = true;
+      break;
+    case HA_EXTRA_NO_IGNORE_DUP_KEY:
+    case HA_EXTRA_WRITE_CANNOT_REPLACE:
+      duplicates_handled = false;
+      break;
+    default:
+      break;
+  }
   return 0;
 }
 
+void ha_blockchain::start_bulk_insert(ha_rows rows) {
+  DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: start_bulk_insert"));
+  // single-row inserts are sent as before
+  if (rows != 1) {
+    mark_bulk_insert(rows);
+    bulk_insert_active = true;
+  }
+}
+
+int ha_blockchain::end_bulk_insert() {
+  DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: end_bulk_insert"));
+  // the rows are sent when the transaction is committed, only the keys of
+  // the last pending rows are checked now
+  bulk_insert_active = false;
+  int rc = flush_pending_inserts();
+  if (rc != 0) {
+    // the server reports the error of end_bulk_insert from my_errno
+    set_my_errno(rc);
+  }
+  return rc;
+}
+
 /**
   @brief
   Used to delete all rows in a table, including cases of truncate and cases
@@ -1414,46 +2245,59 @@ int ha_blockchain::external_lock(THD *thd, int lock_type) {
 
     // Count locks
     txn->lock_count++;
+    // rows are only decoded partially for statements that do not write them
+    read_locked = lock_type == F_RDLCK;
 
     // Fill table cache with open table
-    std::stringstream full_table_name;
-    full_table_name << "./";
-    full_table_name << table->s->db.str;
-    full_table_name << "/";
-    full_table_name << table->s->table_name.str;
+    const std::string &full_table_name = share->full_table_name;
     DBUG_PRINT(LOG_TAG, ("external_lock: full_table_name = %s",
-                         full_table_name.str().c_str()));
+                         full_table_name.c_str()));
 
-    // Convert vector of tuples to map
-    std::map<BYTES, BYTES> table_map_final;
+    // Shared snapshot of the table, the transaction reads it without copying
+    std::shared_ptr<const TABLE_SNAPSHOT> snapshot;
 
     // for tables on data_chain
-    if (txn->table_cache.find(full_table_name.str()) !=
-        txn->table_cache.end()) {
-          return 0;
+    if (txn->table_cache.count(full_table_name) != 0) {
+      table_handle = txn->tableHandle(full_table_name);
+      return 0;
     }
 
-    // define bc_adapter_map_key for full table name
-    std::string bc_adapter_map_key = full_table_name.str();
-    auto it = bc_adapter_map.find(bc_adapter_map_key);
+    BcAdapter *bc_adapter = share->bc_adapter.get();
 
-    if (it != bc_adapter_map.end()) {
-      // Tablescan
-      std::map<const BYTES, BYTES> table_map;
-      if ( (it->second->get_all(table_map)) == -1 ) {
+    // Tables are loaded lazily if point lookups are cheaper than reading the
+    // complete table from the blockchain
+    bool load_lazy = config_table_load_mode == BC_LOAD_LAZY;
+    // Inserts do not need the table if the keys are checked when committing
+    if (config_insert_mode == BC_INSERT_BLIND &&
+        (thd_sql_command(thd) == SQLCOM_INSERT ||
+         thd_sql_command(thd) == SQLCOM_LOAD)) {
+      load_lazy = true;
+    }
+    if (bc_adapter != nullptr && !load_lazy) {
+      // In adaptive mode the complete table is only used if a recent snapshot
+      // is cached already
+      snapshot = get_table_snapshot(
+          bc_adapter, full_table_name,
+          config_table_load_mode == BC_LOAD_ADAPTIVE, share->endpoint);
+      if (snapshot == nullptr &&
+          config_table_load_mode == BC_LOAD_ADAPTIVE) {
+        load_lazy = true;
+      } else if (snapshot == nullptr) {
         // blockchain network is NOT available
         DBUG_PRINT(LOG_TAG,("external_lock: blockchain network is NOT available"));
         return 1;
       }
-
-      for (auto entry : table_map) {
-        BYTES value_bytes = BYTES(entry.second.value, entry.second.size);
-        table_map_final.emplace(entry.first, value_bytes);
-      }
     }
 
-    // Add map to table cache of transaction
-    txn->addTable(full_table_name.str(), table_map_final);
+    // Add table to table cache of transaction
+    if (bc_adapter != nullptr && load_lazy) {
+      DBUG_PRINT(LOG_TAG, ("external_lock: load table %s lazily",
+                           full_table_name.c_str()));
+      txn->addPartialTable(full_table_name);
+    } else {
+      txn->addTable(full_table_name, std::move(snapshot));
+    }
+    table_handle = txn->tableHandle(full_table_name);
 
     // register statement transaction
     trans_register_ha(thd, false, blockchain_hton, nullptr);
@@ -1465,6 +2309,7 @@ int ha_blockchain::external_lock(THD *thd, int lock_type) {
 
   } else {
     // lock-type = unlock
+    table_handle = TABLE_HANDLE();
   }
 
   return 0;
@@ -1542,10 +2387,12 @@ int ha_blockchain::delete_table(const char *name, const dd::Table *) {
 
   // First step
   // Only delete the table from local database, don't changed the metadata.
-  // So ha_blockchain does nothing and return 0.
+  // So ha_blockchain does nothing except dropping its cached snapshot and
+  // statistics.
   // Without stub info
-  (void)name;  // this variable is not yet used, since deletion of table is not
-               // yet implemented
+  SnapshotCache::instance().invalidate(name);
+  StatisticsCache::instance().invalidate(name);
+  AdapterRegistry::instance().remove(name);
   return 0;
 }
 
@@ -1583,16 +2430,113 @@ int ha_blockchain::rename_table(const char *, const char *, const dd::Table *,
   @see
   check_quick_keys() in opt_range.cc
 */
-ha_rows ha_blockchain::records_in_range(uint, key_range *, key_range *) {
+ha_rows ha_blockchain::records_in_range(uint inx, key_range *min_key,
+                                        key_range *max_key) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: records_in_range"));
   // DBUG_TRACE;
-  return 1000;  // high number to avoid index usage
+  const std::string &full_table_name = share->full_table_name;
+
+  uint min_parts = 0;
+  uint max_parts = 0;
+  std::string min_prefix;
+  std::string max_prefix;
+  if (min_key != nullptr) {
+    min_prefix = make_search_prefix(inx, min_key->key, min_key->length,
+                                    &min_parts);
+  }
+  if (max_key != nullptr) {
+    max_prefix = make_search_prefix(inx, max_key->key, max_key->length,
+                                    &max_parts);
+  }
+  // The optimizer takes 0 as proof that the range is empty
+  ha_rows records = std::max<ha_rows>(stats.records, 1);
+
+  // Count the entries if the transaction built the index already
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  if (txn != nullptr) {
+    auto indexes_it = txn->table_indexes.find(full_table_name);
+    if (indexes_it != txn->table_indexes.end() &&
+        indexes_it->second.count(inx) != 0) {
+      return std::max<ha_rows>(
+          count_index_range(indexes_it->second.at(inx), min_key, min_prefix,
+                            max_key, max_prefix),
+          1);
+    }
+  }
+
+  bool equality = min_key != nullptr && max_key != nullptr &&
+                  min_prefix == max_prefix &&
+                  min_key->flag == HA_READ_KEY_EXACT &&
+                  max_key->flag == HA_READ_AFTER_KEY;
+
+  // Estimate with the statistics of ANALYZE TABLE
+  auto statistics = StatisticsCache::instance().get(full_table_name);
+  if (statistics != nullptr && statistics->indexes.count(inx) != 0) {
+    const INDEX_STATISTICS &index_statistics = statistics->indexes.at(inx);
+    if (equality && min_parts > 0 &&
+        min_parts <= index_statistics.rec_per_key.size()) {
+      return std::max<ha_rows>(
+          static_cast<ha_rows>(index_statistics.rec_per_key[min_parts - 1]), 1);
+    }
+    if (!index_statistics.histogram.empty()) {
+      size_t buckets =
+          count_index_range(index_statistics.histogram, min_key, min_prefix,
+                            max_key, max_prefix);
+      // a range within one bucket still contains some rows
+      return std::max<ha_rows>(
+          records * std::max<size_t>(buckets, 1) /
+              index_statistics.histogram.size(),
+          1);
+    }
+  }
+
+  // Without statistics: unique keys match one row, other ranges a third
+  KEY &key_info = table->key_info[inx];
+  if (equality) {
+    if ((key_info.flags & HA_NOSAME) &&
+        min_parts == key_info.user_defined_key_parts) {
+      return 1;
+    }
+    return std::max<ha_rows>(records / 10, 1);
+  }
+  return std::max<ha_rows>(records / 3, 1);
+}
+
+double ha_blockchain::scan_time() {
+  // rows are read from the table cache of the transaction
+  double cost = (double)(stats.records + stats.deleted) / 20.0 + 10;
+  return cost + table_load_ms() * config_latency_cost_per_ms;
+}
+
+double ha_blockchain::read_time(uint index, uint ranges, ha_rows rows) {
+  double cost = (double)rows / 20.0 + 1;
+  double load_ms = table_load_ms();
+  if (load_ms == 0) {
+    return cost;
+  }
+  // Primary key lookups read single rows as long as this is faster than
+  // reading the complete table, all other indexes need the complete table
+  if (index == table->s->primary_key) {
+    ENDPOINT_LATENCY latency = LatencyModel::instance().get(share->endpoint);
+    double lookup_ms =
+        (double)std::max<ha_rows>(rows, ranges) * latency.get_ms;
+    load_ms = std::min(load_ms, lookup_ms);
+  }
+  return cost + load_ms * config_latency_cost_per_ms;
 }
 
 int ha_blockchain::start_stmt(THD *thd, thr_lock_type) {
   DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: start_stmt"));
-  (void)thd;
   DBUG_PRINT(LOG_TAG, ("BCStorageEngine: Start_stmt"));
+  // the transaction of the previous statement may have been committed
+  table_handle = TABLE_HANDLE();
+  auto *txn =
+      static_cast<Transaction *>(thd->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  if (txn != nullptr &&
+      txn->table_cache.count(share->full_table_name) != 0) {
+    table_handle = txn->tableHandle(share->full_table_name);
+  }
   return 0;
 }
 
@@ -1600,29 +2544,744 @@ int ha_blockchain::start_stmt(THD *thd, thr_lock_type) {
  * Helper methods *
  ******************/
 
+double ha_blockchain::table_load_ms() {
+  const std::string &full_table_name = share->full_table_name;
+
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  if (txn != nullptr &&
+      txn->table_cache.count(full_table_name) != 0 &&
+      txn->partial_tables.count(full_table_name) == 0) {
+    return 0;
+  }
+
+  // a cached snapshot that is recent enough costs the round trip to check the
+  // head of the chain, otherwise the table has to be scanned. The snapshot is
+  // checked like get_table_snapshot does, against the head that the adapter
+  // tracks without a request; if it tracks none, the snapshot is assumed to be
+  // recent enough.
+  ENDPOINT_LATENCY latency = LatencyModel::instance().get(share->endpoint);
+  uint64_t head_block_number = 0;
+  std::shared_ptr<const TABLE_SNAPSHOT> snapshot;
+  if (share->bc_adapter != nullptr &&
+      share->bc_adapter->get_live_block_number(head_block_number)) {
+    snapshot = SnapshotCache::instance().get(
+        full_table_name, head_block_number, config_snapshot_max_staleness);
+  } else {
+    snapshot = SnapshotCache::instance().peek(full_table_name);
+  }
+  if (snapshot != nullptr) {
+    return latency.call_ms;
+  }
+  return latency.call_ms + latency.scan_ms_per_byte * stats.data_file_length;
+}
+
+int ha_blockchain::ensure_table_loaded(Transaction *txn,
+                                       const std::string &full_table_name) {
+  if (txn->partial_tables.find(full_table_name) == txn->partial_tables.end()) {
+    return 0;
+  }
+  DBUG_PRINT(LOG_TAG, ("ensure_table_loaded: load complete table %s",
+                       full_table_name.c_str()));
+
+  if (share->bc_adapter == nullptr) {
+    return HA_ERR_NO_CONNECTION;
+  }
+  auto snapshot = get_table_snapshot(share->bc_adapter.get(), full_table_name,
+                                     false, share->endpoint);
+  if (snapshot == nullptr) {
+    return HA_ERR_NO_CONNECTION;
+  }
+  txn->completeTable(full_table_name, std::move(snapshot));
+  return 0;
+}
+
+void ha_blockchain::mark_bulk_insert(ha_rows rows) {
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  if (txn == nullptr) {
+    return;
+  }
+  const std::string &full_table_name = share->full_table_name;
+
+  txn->bulk_tables.insert(full_table_name);
+  if (rows != 0) {
+    txn->statements.reserve(txn->statements.size() + rows);
+  }
+}
+
+int ha_blockchain::lookup_row(Transaction *txn,
+                              const std::string &full_table_name,
+                              const BYTES &key, ROW_REF *value) {
+  // rows read or written by the transaction
+  const auto &table_cache = *table_handle.cache;
+  std::optional<ROW_REF> row = table_cache.find(key);
+  if (row.has_value()) {
+    *value = *row;
+    return 0;
+  }
+
+  // the cache of a complete table contains all rows
+  PARTIAL_TABLE *partial_table = txn->partialTable(table_handle);
+  if (partial_table == nullptr ||
+      partial_table->missing_keys.count(key) != 0) {
+    return HA_ERR_KEY_NOT_FOUND;
+  }
+
+  // Switch to the complete table if a query reads many rows by key
+  if (config_table_load_mode == BC_LOAD_ADAPTIVE &&
+      partial_table->lookups >= config_lazy_lookup_limit) {
+    int rc = ensure_table_loaded(txn, full_table_name);
+    if (rc != 0) {
+      return rc;
+    }
+    return lookup_row(txn, full_table_name, key, value);
+  }
+
+  // Read the row from the blockchain
+  if (share->bc_adapter == nullptr) {
+    return HA_ERR_NO_CONNECTION;
+  }
+  partial_table->lookups++;
+  // get reports a missing key like a failed request, get_batch tells them
+  // apart. Only keys that are known to not exist may be cached as missing,
+  // otherwise a failed request would let a duplicate key through.
+  std::map<const BYTES, BYTES> results;
+  auto start = std::chrono::steady_clock::now();
+  int get_rc = share->bc_adapter->get_batch({key}, results);
+  LatencyModel::instance().record_get(share->endpoint, elapsed_ms(start));
+  if (get_rc != 0) {
+    return HA_ERR_NO_CONNECTION;
+  }
+  auto result_it = results.find(key);
+  if (result_it == results.end()) {
+    partial_table->missing_keys.insert(key);
+    return HA_ERR_KEY_NOT_FOUND;
+  }
+  txn->addReadRow(table_handle, key, result_it->second);
+  *value = *table_cache.find(key);
+  return 0;
+}
+
+auto ha_blockchain::make_row_key(const uchar *key) -> BYTES {
+  // allocate memory for the new pointer => MySQL library for allocating memory
+  // used
+  uchar *key_adj = (uchar *)my_malloc(
+      0, (sizeof(key) * table->key_info[table->s->primary_key].key_length),
+      MYF(0));
+
+  // copy the values of the key to the location where key_adj is pointing to
+  memcpy(key_adj, key, table->key_info[table->s->primary_key].key_length);
+
+  // determine the size of the key
+  ulong key_size = 0;
+  Field *key_field;
+  uint16 initial_pos = 0;
+  if (table->key_info != nullptr) {
+    for (uint i = 0;
+         i < table->key_info[table->s->primary_key].user_defined_key_parts;
+         i++) {
+      key_field = table->key_info[table->s->primary_key].key_part[i].field;
+      key_size = key_field->pack_length();
+      // If the key_part is of type varchar and has less than 255 characters,
+      // then the key needs to be adjusted If the key has <= 255 chars, the
+      // key_size in Byte is: number_of_chars * 4 Byte + 1 Byte (the additional
+      // Byte indicates the number of chars that are used) If the key has > 255
+      // chars, the key_size in Byte is: number_of_chars * 4 Byte + 2 Byte (the
+      // additional 2 Byte indicate the number of chars that are used) and won't
+      // need adjustment. Hence, key_size % 4 will give us either 1 or 2 and
+      // therefore we know in which range the key size falls. The reason for "%
+      // 4" is that MySQL uses 4 Byte for representing one char.
+      if (key_field->type() == MYSQL_TYPE_VARCHAR && key_size % 4 == 1) {
+        // delete the second entry in the char array by shifting the following
+        // elements to the front by 1
+        memcpy(key_adj + initial_pos + 1, key_adj + initial_pos + 2,
+               table->key_info[table->s->primary_key].key_length - initial_pos -
+                   2);
+      }
+      initial_pos += key_size;
+    }
+    key_size = initial_pos;
+  }
+
+  // transform the key that is to be found from byte representation to hex
+  // representation
+  unsigned char key_hash[HASH_SIZE];
+  unsigned int hash_size;
+  hash_sha256(key_adj, key_size, key_hash, &hash_size);
+
+  // free the memory that was used for storing the adjusted key pointer => MySQL
+  // library for allocating memory used
+  my_free(key_adj);
+
+  return BYTES(key_hash, hash_size);
+
+}
+
+int ha_blockchain::prefetch_rows(Transaction *txn,
+                                 const std::vector<BYTES> &keys) {
+  // the cache of a complete table contains all rows
+  PARTIAL_TABLE *partial_table = txn->partialTable(table_handle);
+  if (partial_table == nullptr) {
+    return 0;
+  }
+
+  const auto &table_cache = *table_handle.cache;
+  std::vector<BYTES> unknown_keys;
+  std::set<BYTES> requested;
+  for (const auto &key : keys) {
+    if (!table_cache.find(key).has_value() &&
+        partial_table->missing_keys.count(key) == 0 &&
+        requested.insert(key).second) {
+      unknown_keys.push_back(key);
+    }
+  }
+  if (unknown_keys.empty()) {
+    return 0;
+  }
+
+  if (share->bc_adapter == nullptr) {
+    return HA_ERR_NO_CONNECTION;
+  }
+  partial_table->lookups++;
+  // a getBatch call of too many keys exceeds the limits of the node
+  std::map<const BYTES, BYTES> results;
+  for (size_t first = 0; first < unknown_keys.size();
+       first += DUPLICATE_CHECK_KEYS) {
+    std::vector<BYTES> chunk(
+        unknown_keys.begin() + first,
+        unknown_keys.begin() +
+            std::min(unknown_keys.size(), first + DUPLICATE_CHECK_KEYS));
+    auto start = std::chrono::steady_clock::now();
+    int get_rc = share->bc_adapter->get_batch(chunk, results);
+    LatencyModel::instance().record_get(share->endpoint, elapsed_ms(start));
+    if (get_rc != 0) {
+      return HA_ERR_NO_CONNECTION;
+    }
+  }
+
+  for (const auto &key : unknown_keys) {
+    auto result_it = results.find(key);
+    if (result_it == results.end()) {
+      partial_table->missing_keys.insert(key);
+    } else {
+      txn->addReadRow(table_handle, key, result_it->second);
+    }
+  }
+  DBUG_PRINT(LOG_TAG, ("prefetch_rows: %zu of %zu rows found", results.size(),
+                       unknown_keys.size()));
+  return 0;
+}
+
 int ha_blockchain::find_current_row(uchar *buf) {
   // DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: find_current_row"));
-  return find_row(current_position, buf);
+  if (!row_filter.empty()) {
+    // only rows that match the pushed condition are decoded
+    while (scan_batch_pos == scan_batch.size()) {
+      if (scan_it == scan_end) {
+        return HA_ERR_END_OF_FILE;
+      }
+      fill_scan_batch();
+    }
+    auto row_it = scan_batch[scan_batch_pos++];
+    memset(current_key, 0, ref_length);
+    memcpy(current_key, row_it.key().value,
+           std::min<size_t>(row_it.key().size, ref_length));
+    return read_row(row_it.value(), buf);
+  }
+
+  // skip rows that were written by this scan, e.g. by an update of the key
+  while (scan_it != scan_end && !scan_written_keys.empty() &&
+         scan_written_keys.count(scan_it.key()) != 0) {
+    ++scan_it;
+  }
+  if (scan_it == scan_end) {
+    return HA_ERR_END_OF_FILE;
+  }
+
+  // Remember the key for position(). The cursor is moved before the row is
+  // returned, so that deleting the current row does not invalidate it.
+  ROW_REF key = scan_it.key();
+  memset(current_key, 0, ref_length);
+  memcpy(current_key, key.value, std::min<size_t>(key.size, ref_length));
+  ROW_REF value = scan_it.value();
+  ++scan_it;
+
+  return read_row(value, buf);
 }
 
-int ha_blockchain::find_row(my_off_t index, uchar *buf) {
+int ha_blockchain::find_row(const ROW_REF &value, uchar *buf) {
   // DBUG_PRINT(LOG_TAG, ("ha_blockchain_method_call: find_row"));
-  //  set required zero
   uint initial_null_bytes = table->s->null_bytes;
-  memset(buf, 0, table->s->reclength);
+  size_t row_size = table->s->reclength - initial_null_bytes;
+  size_t value_size = std::min(value.size, row_size);
+
+  // Decode value of the row into the record buffer, set the rest to zero
+  memset(buf, 0, initial_null_bytes);
+  memcpy(buf + initial_null_bytes, value.value, value_size);
+  if (value_size < row_size) {
+    memset(buf + initial_null_bytes + value_size, 0, row_size - value_size);
+  }
 
-  try {
-    // Get value from result vector at index
-    memcpy(buf + initial_null_bytes, std::get<1>(all_items.at(index)).value,
-           std::get<1>(all_items.at(index)).size);
+  return 0;
+}
 
-  } catch (const std::out_of_range &) {
-    return HA_ERR_END_OF_FILE;
+// The pushed condition is evaluated in batches by RowFilter::evaluate. Its
+// loops are left to the auto-vectorizer of the compiler; the engine has no
+// hand-written SIMD code, since it has no architecture-specific code at all.
+void ha_blockchain::fill_scan_batch() {
+  TableCache::const_iterator rows[RowFilter::kBatchSize];
+  ROW_REF values[RowFilter::kBatchSize];
+  uint8_t matches[RowFilter::kBatchSize];
+  size_t count = 0;
+  for (; scan_it != scan_end && count < RowFilter::kBatchSize; ++scan_it) {
+    if (scan_written_keys.empty() ||
+        scan_written_keys.count(scan_it.key()) == 0) {
+      rows[count] = scan_it;
+      values[count] = scan_it.value();
+      count++;
+    }
+  }
+  row_filter.evaluate(values, count, matches);
+
+  scan_batch.clear();
+  scan_batch_pos = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (matches[i] != 0) {
+      scan_batch.push_back(rows[i]);
+    }
+  }
+}
+
+bool ha_blockchain::push_predicate(const Item *item) {
+  if (item->type() != Item::FUNC_ITEM) {
+    return false;
+  }
+  const auto *func = down_cast<const Item_func *>(item);
+  FILTER_OP op;
+  switch (func->functype()) {
+    case Item_func::EQ_FUNC:
+      op = FILTER_OP::EQ;
+      break;
+    case Item_func::NE_FUNC:
+      op = FILTER_OP::NE;
+      break;
+    case Item_func::LT_FUNC:
+      op = FILTER_OP::LT;
+      break;
+    case Item_func::LE_FUNC:
+      op = FILTER_OP::LE;
+      break;
+    case Item_func::GT_FUNC:
+      op = FILTER_OP::GT;
+      break;
+    case Item_func::GE_FUNC:
+      op = FILTER_OP::GE;
+      break;
+    case Item_func::IN_FUNC:
+      if (down_cast<const Item_func_in *>(func)->negated) {
+        return false;
+      }
+      op = FILTER_OP::IN;
+      break;
+    default:
+      return false;
+  }
+  if (func->argument_count() < 2 ||
+      (op != FILTER_OP::IN && func->argument_count() != 2)) {
+    return false;
+  }
+
+  // the column may be on either side of a comparison, e.g. 5 < a
+  Item **args = func->arguments();
+  uint field_arg = 0;
+  if (op != FILTER_OP::IN && args[0]->type() != Item::FIELD_ITEM) {
+    field_arg = 1;
+    switch (op) {
+      case FILTER_OP::LT:
+        op = FILTER_OP::GT;
+        break;
+      case FILTER_OP::LE:
+        op = FILTER_OP::GE;
+        break;
+      case FILTER_OP::GT:
+        op = FILTER_OP::LT;
+        break;
+      case FILTER_OP::GE:
+        op = FILTER_OP::LE;
+        break;
+      default:
+        break;
+    }
+  }
+  if (args[field_arg]->type() != Item::FIELD_ITEM) {
+    return false;
+  }
+
+  // only integer columns of this table, which are stored little-endian
+  Field *field = down_cast<const Item_field *>(args[field_arg])->field;
+  if (field == nullptr || field->table != table) {
+    return false;
+  }
+  switch (field->type()) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+      break;
+    default:
+      return false;
+  }
+  COLUMN_PREDICATE predicate{
+      field->offset(table->record[0]) - table->s->null_bytes,
+      field->pack_length(), field->is_unsigned(), op, {}};
+
+  for (uint i = 0; i < func->argument_count(); i++) {
+    if (i == field_arg) {
+      continue;
+    }
+    Item *value = args[i];
+    if (!value->basic_const_item() || value->result_type() != INT_RESULT) {
+      return false;
+    }
+    longlong constant = value->val_int();
+    if (value->null_value) {
+      return false;
+    }
+    // the constant has to be in the range of the column, e.g. no negative
+    // constants for unsigned columns
+    if (value->unsigned_flag != predicate.is_unsigned && constant < 0) {
+      return false;
+    }
+    predicate.values.push_back(constant);
+  }
+
+  row_filter.add(std::move(predicate));
+  return true;
+}
+
+auto ha_blockchain::next_matching_entry(IndexView::const_iterator it,
+                                        bool forward)
+    -> IndexView::const_iterator {
+  if (row_filter.empty()) {
+    return it;
+  }
+  while (it != index_set->end()) {
+    // the key of the row is stored at the end of the entry
+    std::optional<ROW_REF> value = index_table->find(ROW_REF{
+        reinterpret_cast<const unsigned char *>(it->data()) + it->size() -
+            HASH_SIZE,
+        HASH_SIZE});
+    if (!value.has_value() || row_filter.matches(*value)) {
+      return it;
+    }
+    if (forward) {
+      ++it;
+    } else if (it == index_set->begin()) {
+      return index_set->end();
+    } else {
+      --it;
+    }
+  }
+  return it;
+}
+
+int ha_blockchain::read_row(const ROW_REF &value, uchar *buf) {
+  if (!read_locked || bitmap_is_set_all(table->read_set)) {
+    return find_row(value, buf);
+  }
+
+  // the read set may change between scans, e.g. for filesort
+  const my_bitmap_map *bits = table->read_set->bitmap;
+  size_t words =
+      bitmap_buffer_size(table->read_set->n_bits) / sizeof(my_bitmap_map);
+  if (projection_bits.size() != words ||
+      !std::equal(projection_bits.begin(), projection_bits.end(), bits)) {
+    init_projection();
+  }
+
+  // Decode only the columns of the read set, the other columns of the record
+  // buffer are not used by the server
+  uint initial_null_bytes = table->s->null_bytes;
+  memset(buf, 0, initial_null_bytes);
+  for (const auto &range : projection) {
+    size_t offset = range.first;
+    size_t length = range.second;
+    size_t available =
+        offset < value.size ? std::min(length, value.size - offset) : 0;
+    memcpy(buf + initial_null_bytes + offset, value.value + offset, available);
+    if (available < length) {
+      memset(buf + initial_null_bytes + offset + available, 0,
+             length - available);
+    }
+  }
+
+  return 0;
+}
+
+void ha_blockchain::init_projection() {
+  const my_bitmap_map *bits = table->read_set->bitmap;
+  projection_bits.assign(
+      bits, bits + bitmap_buffer_size(table->read_set->n_bits) /
+                       sizeof(my_bitmap_map));
+
+  // byte ranges of the read columns in the stored value, adjacent columns
+  // are merged
+  projection.clear();
+  for (Field **field = table->field; *field != nullptr; field++) {
+    if (!bitmap_is_set(table->read_set, (*field)->field_index())) {
+      continue;
+    }
+    size_t offset = (*field)->offset(table->record[0]) - table->s->null_bytes;
+    size_t length = (*field)->pack_length();
+    projection.emplace_back(offset, length);
+  }
+  std::sort(projection.begin(), projection.end());
+  std::vector<std::pair<size_t, size_t>> merged;
+  for (const auto &range : projection) {
+    if (!merged.empty() &&
+        merged.back().first + merged.back().second >= range.first) {
+      merged.back().second =
+          std::max(merged.back().first + merged.back().second,
+                   range.first + range.second) -
+          merged.back().first;
+    } else {
+      merged.push_back(range);
+    }
+  }
+  projection = std::move(merged);
+}
+
+auto ha_blockchain::make_index_entry(uint index, const uchar *record,
+                                     uint key_parts) -> std::string {
+  const KEY &key_info = table->key_info[index];
+  ptrdiff_t record_offset = record - table->record[0];
+  std::string entry;
+
+  for (uint i = 0; i < key_parts && i < key_info.user_defined_key_parts; i++) {
+    Field *field = key_info.key_part[i].field;
+    size_t sort_length = field->sort_length();
+
+    field->move_field_offset(record_offset);
+    bool is_null = field->is_null();
+    // NULL is ordered before all values
+    if (field->is_nullable()) {
+      entry.push_back(is_null ? 0 : 1);
+    }
+    size_t pos = entry.size();
+    entry.resize(pos + sort_length, 0);
+    if (!is_null) {
+      field->make_sort_key(reinterpret_cast<uchar *>(&entry[pos]), sort_length);
+    }
+    field->move_field_offset(-record_offset);
+  }
+  return entry;
+}
+
+auto ha_blockchain::make_search_prefix(uint index, const uchar *key,
+                                       uint key_len, uint *key_parts)
+    -> std::string {
+  // Number of key parts in the search key
+  const KEY &key_info = table->key_info[index];
+  uint parts = 0;
+  uint parts_length = 0;
+  while (parts < key_info.user_defined_key_parts && parts_length < key_len) {
+    parts_length += key_info.key_part[parts++].store_length;
+  }
+  if (key_parts != nullptr) {
+    *key_parts = parts;
+  }
+
+  // Convert the search key to the format of the index entries
+  index_record.resize(table->s->reclength);
+  key_restore(index_record.data(), key, &key_info, key_len);
+  return make_index_entry(index, index_record.data(), parts);
+}
+
+int ha_blockchain::init_index_cursor() {
+  Transaction *txn = static_cast<Transaction *>(
+      ha_thd()->get_ha_data(blockchain_hton->slot)->ha_ptr);
+  const std::string &full_table_name = share->full_table_name;
+
+  int rc = ensure_table_loaded(txn, full_table_name);
+  if (rc != 0) {
+    return rc;
+  }
+  const auto &table_cache = *table_handle.cache;
+  auto &indexes = txn->table_indexes[full_table_name];
+
+  auto index_it = indexes.find(active_index);
+  if (index_it == indexes.end()) {
+    uint key_parts = table->key_info[active_index].user_defined_key_parts;
+    auto make_entry = [&](const ROW_REF &key, const ROW_REF &value) {
+      find_row(value, index_record.data());
+      return make_index_entry(active_index, index_record.data(), key_parts)
+          .append(reinterpret_cast<const char *>(key.value), key.size);
+    };
+    index_record.resize(table->s->reclength);
+
+    // The index of the shared snapshot is built once per snapshot version,
+    // only the rows of the transaction are merged into it here
+    std::shared_ptr<const ORDERED_INDEX> snapshot_index = table_cache.index(
+        active_index, [&](const TABLE_SNAPSHOT &snapshot) {
+          DBUG_PRINT(LOG_TAG, ("init_index_cursor: build index %u of %s",
+                               active_index, full_table_name.c_str()));
+          ORDERED_INDEX index;
+          for (auto row = snapshot.begin(); row != snapshot.end(); ++row) {
+            index.insert(make_entry(row.key(), row.value()));
+          }
+          return index;
+        });
+    IndexView index(std::move(snapshot_index));
+    for (const auto &change : table_cache.changes()) {
+      std::optional<ROW_REF> old_value = table_cache.base().find(change.first);
+      if (old_value.has_value()) {
+        index.erase(make_entry(change.first, *old_value));
+      }
+      if (change.second.has_value()) {
+        index.insert(make_entry(change.first, *change.second));
+      }
+    }
+    index_it = indexes.emplace(active_index, std::move(index)).first;
   }
 
+  index_set = &index_it->second;
+  index_table = &table_cache;
+  index_current.clear();
   return 0;
 }
 
+int ha_blockchain::read_index_entry(IndexView::const_iterator it,
+                                    uchar *buf) {
+  if (it == index_set->end()) {
+    return HA_ERR_END_OF_FILE;
+  }
+  index_current = *it;
+
+  // the key of the row is stored at the end of the entry
+  ROW_REF row_key{reinterpret_cast<const unsigned char *>(
+                      index_current.data() + index_current.size() - HASH_SIZE),
+                  HASH_SIZE};
+  std::optional<ROW_REF> value = index_table->find(row_key);
+  if (!value.has_value()) {
+    return HA_ERR_KEY_NOT_FOUND;
+  }
+  memset(current_key, 0, ref_length);
+  memcpy(current_key, row_key.value,
+         std::min<size_t>(row_key.size, ref_length));
+  return read_row(*value, buf);
+}
+
+int ha_blockchain::index_read_ordered(uchar *buf, const uchar *key,
+                                      uint key_len,
+                                      enum ha_rkey_function find_flag) {
+  int rc = init_index_cursor();
+  if (rc != 0) {
+    return rc;
+  }
+
+  std::string prefix = make_search_prefix(active_index, key, key_len, nullptr);
+
+  // First entry that does not start with the search key
+  auto prefix_end = [&]() {
+    return index_prefix_end(*index_set, prefix);
+  };
+  auto starts_with_prefix = [&](IndexView::const_iterator it) {
+    return it != index_set->end() &&
+           it->compare(0, prefix.size(), prefix) == 0;
+  };
+
+  IndexView::const_iterator it;
+  switch (find_flag) {
+    case HA_READ_KEY_EXACT:
+    case HA_READ_PREFIX:
+      it = index_set->lower_bound(prefix);
+      if (!starts_with_prefix(it)) {
+        return HA_ERR_KEY_NOT_FOUND;
+      }
+      break;
+    case HA_READ_KEY_OR_NEXT:
+      it = index_set->lower_bound(prefix);
+      break;
+    case HA_READ_AFTER_KEY:
+      it = prefix_end();
+      break;
+    case HA_READ_BEFORE_KEY:
+      it = index_set->lower_bound(prefix);
+      if (it == index_set->begin()) {
+        return HA_ERR_KEY_NOT_FOUND;
+      }
+      --it;
+      break;
+    case HA_READ_KEY_OR_PREV:
+    case HA_READ_PREFIX_LAST:
+    case HA_READ_PREFIX_LAST_OR_PREV:
+      it = prefix_end();
+      if (it == index_set->begin()) {
+        return HA_ERR_KEY_NOT_FOUND;
+      }
+      --it;
+      if (find_flag == HA_READ_PREFIX_LAST && !starts_with_prefix(it)) {
+        return HA_ERR_KEY_NOT_FOUND;
+      }
+      break;
+    default:
+      return HA_ERR_WRONG_COMMAND;
+  }
+
+  // skip rows that do not match the pushed condition, in the direction in
+  // which the server continues reading
+  bool forward = find_flag == HA_READ_KEY_EXACT ||
+                 find_flag == HA_READ_PREFIX ||
+                 find_flag == HA_READ_KEY_OR_NEXT ||
+                 find_flag == HA_READ_AFTER_KEY;
+  it = next_matching_entry(it, forward);
+  if (it == index_set->end()) {
+    return HA_ERR_KEY_NOT_FOUND;
+  }
+  if ((find_flag == HA_READ_KEY_EXACT || find_flag == HA_READ_PREFIX ||
+       find_flag == HA_READ_PREFIX_LAST) &&
+      !starts_with_prefix(it)) {
+    return HA_ERR_KEY_NOT_FOUND;
+  }
+  return read_index_entry(it, buf);
+}
+
+void ha_blockchain::update_indexes(Transaction *txn,
+                                   const std::string &full_table_name,
+                                   const BYTES &row_key,
+                                   const std::optional<ROW_REF> &old_value,
+                                   const std::optional<ROW_REF> &new_value) {
+  // most transactions use no ordered index, their rows skip the lookup
+  if (txn->table_indexes.empty()) {
+    return;
+  }
+  auto indexes_it = txn->table_indexes.find(full_table_name);
+  if (indexes_it == txn->table_indexes.end()) {
+    return;
+  }
+  // Entries are built from the stored values, like when an index is built
+  std::string row_key_str(reinterpret_cast<const char *>(row_key.value),
+                          row_key.size);
+  index_record.resize(table->s->reclength);
+  for (auto &index : indexes_it->second) {
+    uint key_parts = table->key_info[index.first].user_defined_key_parts;
+    if (old_value.has_value()) {
+      find_row(*old_value, index_record.data());
+      index.second.erase(
+          make_index_entry(index.first, index_record.data(), key_parts) +
+          row_key_str);
+    }
+    if (new_value.has_value()) {
+      find_row(*new_value, index_record.data());
+      index.second.insert(
+          make_index_entry(index.first, index_record.data(), key_parts) +
+          row_key_str);
+    }
+  }
+}
+
 // Plugin parameter
 struct st_mysql_storage_engine blockchain_storage_engine = {
     MYSQL_HANDLERTON_INTERFACE_VERSION};
@@ -1637,9 +3296,149 @@ struct st_mysql_storage_engine blockchain_storage_engine = {
     "Path to BlockchainManager and BlockchainAdapter configuration folder",
     nullptr, nullptr, nullptr);
 
+  static MYSQL_SYSVAR_ULONG(
+    bc_snapshot_max_staleness, config_snapshot_max_staleness,
+    PLUGIN_VAR_RQCMDARG,
+    "Number of blocks a cached bc-table snapshot may lag behind the head of "
+    "the blockchain before the table is read again (0 = only reuse it while "
+    "no new block was mined)",
+    nullptr, nullptr, 0, 0, ULONG_MAX, 0);
+
+  static const char *bc_table_load_mode_names[] = {"SNAPSHOT", "LAZY",
+                                                   "ADAPTIVE", NullS};
+
+  static TYPELIB bc_table_load_mode_typelib = {
+      array_elements(bc_table_load_mode_names) - 1,
+      "bc_table_load_mode_typelib", bc_table_load_mode_names, nullptr};
+
+  static MYSQL_SYSVAR_ENUM(
+    bc_table_load_mode, config_table_load_mode, PLUGIN_VAR_RQCMDARG,
+    "How a transaction loads a bc-table. SNAPSHOT (the default) reads the "
+    "complete table when it is locked, LAZY reads rows by key and the "
+    "complete table only for scans, ADAPTIVE uses a cached snapshot if there "
+    "is a recent one and reads the complete table after "
+    "blockchain_bc_lazy_lookup_limit lookups",
+    nullptr, nullptr, BC_LOAD_SNAPSHOT, &bc_table_load_mode_typelib);
+
+  static MYSQL_SYSVAR_ULONG(
+    bc_lazy_lookup_limit, config_lazy_lookup_limit, PLUGIN_VAR_RQCMDARG,
+    "Number of rows a transaction reads by key from a lazily loaded bc-table "
+    "before it reads the complete table (only used in ADAPTIVE load mode)",
+    nullptr, nullptr, 32, 0, ULONG_MAX, 0);
+
+  static const char *bc_insert_mode_names[] = {"CHECKED", "BLIND", NullS};
+
+  static TYPELIB bc_insert_mode_typelib = {
+      array_elements(bc_insert_mode_names) - 1, "bc_insert_mode_typelib",
+      bc_insert_mode_names, nullptr};
+
+  static MYSQL_SYSVAR_ENUM(
+    bc_insert_mode, config_insert_mode, PLUGIN_VAR_RQCMDARG,
+    "How INSERT checks for duplicate keys. CHECKED reads the key (or the "
+    "complete table) before the row is written, BLIND lets the blockchain "
+    "skip existing keys when committing and reports them as duplicates; "
+    "INSERT and LOAD DATA do not read the table then",
+    nullptr, nullptr, BC_INSERT_CHECKED, &bc_insert_mode_typelib);
+
+  static MYSQL_SYSVAR_DOUBLE(
+    bc_latency_cost_per_ms, config_latency_cost_per_ms, PLUGIN_VAR_RQCMDARG,
+    "Optimizer cost of one millisecond of measured blockchain latency, "
+    "relative to the cost of reading a block from disk (1.0)",
+    nullptr, nullptr, 1.0, 0, 1000, 0);
+
+  static const char *bc_commit_mode_names[] = {"SYNC", "ASYNC", NullS};
+
+  static TYPELIB bc_commit_mode_typelib = {
+      array_elements(bc_commit_mode_names) - 1, "bc_commit_mode_typelib",
+      bc_commit_mode_names, nullptr};
+
+  static MYSQL_SYSVAR_ENUM(
+    bc_commit_mode, config_commit_mode, PLUGIN_VAR_RQCMDARG,
+    "Whether COMMIT waits until the blockchain transactions are mined. ASYNC "
+    "returns when the node accepted them; they are confirmed in the "
+    "background, failures are written to the error log and shown in "
+    "INFORMATION_SCHEMA.BLOCKCHAIN_COMMITS. Inserts in BLIND mode always wait",
+    nullptr, nullptr, BC_COMMIT_SYNC, &bc_commit_mode_typelib);
+
+  static MYSQL_SYSVAR_ULONG(
+    bc_group_commit_window, config_group_commit_window, PLUGIN_VAR_RQCMDARG,
+    "Milliseconds the first of concurrent SYNC commits to a bc-table waits "
+    "for other commits, whose writes are then sent with the same blockchain "
+    "transaction (0 sends every commit on its own)",
+    nullptr, nullptr, 20, 0, 10000, 0);
+
+  static MYSQL_SYSVAR_ULONG(
+    bc_group_commit_max_rows, config_group_commit_max_rows, PLUGIN_VAR_RQCMDARG,
+    "Number of rows after which a group of commits is sent without waiting "
+    "for further commits",
+    nullptr, nullptr, 500, 1, ULONG_MAX, 0);
+
   static SYS_VAR *blockchain_system_variables[] = {
-      MYSQL_SYSVAR(bc_configuration_path),
-      nullptr};  // config path for configurations
+      MYSQL_SYSVAR(bc_configuration_path),  // config path for configurations
+      MYSQL_SYSVAR(bc_snapshot_max_staleness),
+      MYSQL_SYSVAR(bc_table_load_mode),
+      MYSQL_SYSVAR(bc_lazy_lookup_limit),
+      MYSQL_SYSVAR(bc_insert_mode),
+      MYSQL_SYSVAR(bc_latency_cost_per_ms),
+      MYSQL_SYSVAR(bc_commit_mode),
+      MYSQL_SYSVAR(bc_group_commit_window),
+      MYSQL_SYSVAR(bc_group_commit_max_rows),
+      nullptr};
+
+/**********************************************
+ * INFORMATION_SCHEMA.BLOCKCHAIN_COMMITS
+ *********************************************/
+
+static struct st_mysql_information_schema blockchain_commits_info = {
+    MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION};
+
+static ST_FIELD_INFO blockchain_commits_fields[] = {
+    {"TABLE_NAME", FN_REFLEN, MYSQL_TYPE_STRING, 0, 0, "", 0},
+    {"TRANSACTION_ID", 66, MYSQL_TYPE_STRING, 0, 0, "", 0},
+    {"STATUS", 10, MYSQL_TYPE_STRING, 0, 0, "", 0},
+    {"SUBMITTED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+     MY_I_S_UNSIGNED, "", 0},
+    {"FINISHED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+     MY_I_S_UNSIGNED | MY_I_S_MAYBE_NULL, "", 0},
+    {nullptr, 0, MYSQL_TYPE_NULL, 0, 0, nullptr, 0}};
+
+// Lists the blockchain transactions of asynchronous commits, times are in
+// seconds since the epoch
+static int blockchain_commits_fill_table(THD *thd, Table_ref *tables, Item *) {
+  TABLE *table = tables->table;
+  for (const auto &record : CommitConfirmer::instance().list()) {
+    const char *status =
+        record.status == COMMIT_STATUS::PENDING
+            ? "PENDING"
+            : record.status == COMMIT_STATUS::CONFIRMED ? "CONFIRMED"
+                                                        : "FAILED";
+    table->field[0]->store(record.tablename.c_str(), record.tablename.size(),
+                           system_charset_info);
+    table->field[1]->store(record.transaction_id.c_str(),
+                           record.transaction_id.size(), system_charset_info);
+    table->field[2]->store(status, strlen(status), system_charset_info);
+    table->field[3]->store(std::chrono::system_clock::to_time_t(record.submitted),
+                           true);
+    if (record.status == COMMIT_STATUS::PENDING) {
+      table->field[4]->set_null();
+    } else {
+      table->field[4]->set_notnull();
+      table->field[4]->store(
+          std::chrono::system_clock::to_time_t(record.finished), true);
+    }
+    if (schema_table_store_record(thd, table)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int blockchain_commits_init(void *p) {
+  auto *schema = static_cast<ST_SCHEMA_TABLE *>(p);
+  schema->fields_info = blockchain_commits_fields;
+  schema->fill_table = blockchain_commits_fill_table;
+  return 0;
+}
 
 // Plugin descriptor
 mysql_declare_plugin(blockchain){
@@ -1649,12 +3448,28 @@ mysql_declare_plugin(blockchain){
     "TU Darmstadt DM Group",
     "Blockchain storage engine",
     PLUGIN_LICENSE_GPL,
-    blockchain_init_func, /* Plugin Init */
-    nullptr,              /* Plugin check uninstall */
-    nullptr,              /* Plugin Deinit */
+    blockchain_init_func,   /* Plugin Init */
+    nullptr,                /* Plugin check uninstall */
+    blockchain_deinit_func, /* Plugin Deinit */
     0x0001 /* 0.1 version*/,
     0,                           /* status variables */
     blockchain_system_variables, /* system variables */
     nullptr,                     /* config options */
     0,                           /* flags */
+},
+{
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &blockchain_commits_info,
+    "BLOCKCHAIN_COMMITS",
+    "TU Darmstadt DM Group",
+    "Blockchain transactions of asynchronous commits",
+    PLUGIN_LICENSE_GPL,
+    blockchain_commits_init, /* Plugin Init */
+    nullptr,                 /* Plugin check uninstall */
+    nullptr,                 /* Plugin Deinit */
+    0x0001 /* 0.1 version*/,
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
 } mysql_declare_plugin_end;
@@ -0,0 +1,46 @@
+#include "storage/blockchainDB/engine/include/latency_model.h"
+
+using namespace blockchain_db;
+
+auto LatencyModel::instance() -> LatencyModel &{
+    static LatencyModel model;
+    return model;
+}
+
+auto LatencyModel::get(const std::string &endpoint) -> ENDPOINT_LATENCY{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = latencies_.find(endpoint);
+    if(it == latencies_.end())
+        return ENDPOINT_LATENCY();
+    return it->second;
+}
+
+void LatencyModel::record_call(const std::string &endpoint, double ms){
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &latency = latencies_[endpoint];
+    add_sample(latency.call_ms, latency.call_samples, ms);
+}
+
+void LatencyModel::record_get(const std::string &endpoint, double ms){
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &latency = latencies_[endpoint];
+    add_sample(latency.get_ms, latency.get_samples, ms);
+}
+
+void LatencyModel::record_scan(const std::string &endpoint, double ms, uint64_t bytes){
+    if(bytes == 0)
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &latency = latencies_[endpoint];
+    // the round trip is paid once per scan, the rest depends on the size
+    double transfer_ms = ms > latency.call_ms ? ms - latency.call_ms : 0;
+    add_sample(latency.scan_ms_per_byte, latency.scan_samples, transfer_ms / bytes);
+}
+
+void LatencyModel::add_sample(double &average, uint64_t &samples, double value){
+    if(samples == 0)
+        average = value;
+    else
+        average = (1 - kWeight) * average + kWeight * value;
+    samples++;
+}
@@ -0,0 +1,108 @@
+#include "storage/blockchainDB/engine/include/row_filter.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace blockchain_db;
+
+/**
+ * @brief Decodes a little-endian integer column of a stored value. Columns
+ * beyond the end of the value are 0, like in the decoded record.
+ */
+static auto load_column(const ROW_REF &value, size_t offset, size_t length,
+                        bool is_unsigned) -> int64_t{
+    unsigned char bytes[8] = {0};
+    if(offset < value.size)
+        memcpy(bytes, value.value + offset, std::min(length, value.size - offset));
+    uint64_t result = 0;
+    for(size_t i = length; i > 0; i--)
+        result = (result << 8) | bytes[i - 1];
+    // sign-extend narrow signed columns
+    if(!is_unsigned && length < 8 && (result >> (length * 8 - 1)) != 0)
+        result |= ~uint64_t(0) << (length * 8);
+    return static_cast<int64_t>(result);
+}
+
+/**
+ * @brief Compares a gathered column with a constant and clears the results of
+ * the rows that do not satisfy the comparison
+ */
+template <typename T>
+static void compare_column(const T *column, size_t count, FILTER_OP op, T constant,
+                           uint8_t *result){
+    switch(op){
+        case FILTER_OP::EQ:
+            for(size_t i = 0; i < count; i++) result[i] &= column[i] == constant;
+            break;
+        case FILTER_OP::NE:
+            for(size_t i = 0; i < count; i++) result[i] &= column[i] != constant;
+            break;
+        case FILTER_OP::LT:
+            for(size_t i = 0; i < count; i++) result[i] &= column[i] < constant;
+            break;
+        case FILTER_OP::LE:
+            for(size_t i = 0; i < count; i++) result[i] &= column[i] <= constant;
+            break;
+        case FILTER_OP::GT:
+            for(size_t i = 0; i < count; i++) result[i] &= column[i] > constant;
+            break;
+        case FILTER_OP::GE:
+            for(size_t i = 0; i < count; i++) result[i] &= column[i] >= constant;
+            break;
+        case FILTER_OP::IN:
+            break;
+    }
+}
+
+/**
+ * @brief Clears the results of the rows whose column is not in a list of
+ * constants
+ */
+static void compare_in_list(const int64_t *column, size_t count,
+                            const std::vector<int64_t> &values, uint8_t *result){
+    uint8_t found[RowFilter::kBatchSize] = {0};
+    for(int64_t constant : values)
+        for(size_t i = 0; i < count; i++) found[i] |= column[i] == constant;
+    for(size_t i = 0; i < count; i++) result[i] &= found[i];
+}
+
+void RowFilter::add(COLUMN_PREDICATE predicate){
+    predicates_.push_back(std::move(predicate));
+}
+
+void RowFilter::clear(){
+    predicates_.clear();
+}
+
+auto RowFilter::empty() const -> bool{
+    return predicates_.empty();
+}
+
+auto RowFilter::matches(const ROW_REF &value) const -> bool{
+    const ROW_REF values[1] = {value};
+    uint8_t result[1];
+    evaluate(values, 1, result);
+    return result[0] != 0;
+}
+
+void RowFilter::evaluate(const ROW_REF *values, size_t count,
+                         uint8_t *result) const{
+    memset(result, 1, count);
+    int64_t column[kBatchSize];
+    for(const auto &predicate : predicates_){
+        for(size_t i = 0; i < count; i++)
+            column[i] = load_column(values[i], predicate.offset, predicate.length,
+                                    predicate.is_unsigned);
+        if(predicate.op == FILTER_OP::IN){
+            // equality does not depend on the signedness
+            compare_in_list(column, count, predicate.values, result);
+        } else if(predicate.is_unsigned){
+            compare_column(reinterpret_cast<const uint64_t *>(column), count,
+                           predicate.op, static_cast<uint64_t>(predicate.values[0]),
+                           result);
+        } else {
+            compare_column<int64_t>(column, count, predicate.op, predicate.values[0],
+                                    result);
+        }
+    }
+}
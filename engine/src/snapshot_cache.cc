@@ -0,0 +1,78 @@
+#include "storage/blockchainDB/engine/include/snapshot_cache.h"
+
+using namespace blockchain_db;
+
+auto SnapshotCache::instance() -> SnapshotCache &{
+    static SnapshotCache cache;
+    return cache;
+}
+
+auto SnapshotCache::get(const std::string &tablename, uint64_t head_block_number,
+                        uint64_t max_staleness) -> std::shared_ptr<const TABLE_SNAPSHOT>{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(tablename);
+    if(it == snapshots_.end())
+        return nullptr;
+    // a snapshot is never newer than the head it was read at
+    if(head_block_number > it->second->block_number + max_staleness)
+        return nullptr;
+    return it->second;
+}
+
+auto SnapshotCache::peek(const std::string &tablename)
+    -> std::shared_ptr<const TABLE_SNAPSHOT>{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(tablename);
+    if(it == snapshots_.end())
+        return nullptr;
+    return it->second;
+}
+
+void SnapshotCache::put(const std::string &tablename,
+                        std::shared_ptr<TABLE_SNAPSHOT> snapshot){
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(tablename);
+    // keep the more recent snapshot if two transactions read the table concurrently
+    if(it != snapshots_.end() && it->second->block_number > snapshot->block_number)
+        return;
+    snapshots_[tablename] = std::move(snapshot);
+}
+
+void SnapshotCache::apply(const std::string &tablename,
+                          const Transaction &transaction,
+                          uint64_t sent_block_number,
+                          uint64_t mined_block_number){
+    uint32_t table;
+    if(!transaction.findTableId(tablename, table))
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(tablename);
+    if(it == snapshots_.end())
+        return;
+    // Copy on write: transactions that hold the snapshot must not see the change.
+    // The new version shares the rows and only copies the changes since they were read.
+    if(it->second.use_count() > 1)
+        it->second = std::make_shared<TABLE_SNAPSHOT>(*it->second);
+    // the blocks mined since the commit was sent contain the commit, so a
+    // snapshot that was current then does not lag behind them
+    if(it->second->block_number >= sent_block_number &&
+       it->second->block_number < mined_block_number)
+        it->second->block_number = mined_block_number;
+    auto &snapshot = *it->second;
+    // the indexes of the new version are built when they are used
+    snapshot.indexes = std::make_shared<SNAPSHOT_INDEXES>();
+    for(const auto &statement : transaction.statements){
+        if(statement.table != table)
+            continue;
+        if(statement.type == STATEMENT_TYPE::REMOVE)
+            snapshot.erase(statement.key.bytes());
+        else
+            snapshot.put(statement.key.bytes(), statement.value.bytes());
+    }
+    snapshot.fold();
+}
+
+void SnapshotCache::invalidate(const std::string &tablename){
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshots_.erase(tablename);
+}
@@ -0,0 +1,344 @@
+#include "storage/blockchainDB/engine/include/table_cache.h"
+
+using namespace blockchain_db;
+
+TABLE_SNAPSHOT::const_iterator::const_iterator(const TABLE_SNAPSHOT *snapshot,
+                                               SNAPSHOT_ROWS::const_iterator row,
+                                               SNAPSHOT_CHANGES::const_iterator change)
+    : snapshot_(snapshot), row_(row), change_(change){
+    settle();
+}
+
+auto TABLE_SNAPSHOT::const_iterator::key() const -> ROW_REF{
+    return in_changes_ ? ROW_LESS::ref(change_->first) : ROW_LESS::ref(row_->first);
+}
+
+auto TABLE_SNAPSHOT::const_iterator::value() const -> ROW_REF{
+    return in_changes_ ? ROW_LESS::ref(*change_->second) : ROW_LESS::ref(row_->second);
+}
+
+auto TABLE_SNAPSHOT::const_iterator::operator++() -> const_iterator &{
+    if(in_changes_)
+        ++change_;
+    else
+        ++row_;
+    settle();
+    return *this;
+}
+
+auto TABLE_SNAPSHOT::const_iterator::operator==(const const_iterator &other) const -> bool{
+    return row_ == other.row_ && change_ == other.change_;
+}
+
+auto TABLE_SNAPSHOT::const_iterator::operator!=(const const_iterator &other) const -> bool{
+    return !(*this == other);
+}
+
+void TABLE_SNAPSHOT::const_iterator::settle(){
+    const auto rows_end = snapshot_->rows->end();
+    while(change_ != snapshot_->changes.end()){
+        if(row_ != rows_end && ROW_LESS()(row_->first, change_->first)){
+            in_changes_ = false;
+            return;
+        }
+        // the change replaces the row with the same key
+        if(row_ != rows_end && !ROW_LESS()(change_->first, row_->first))
+            ++row_;
+        if(change_->second.has_value()){
+            in_changes_ = true;
+            return;
+        }
+        ++change_;
+    }
+    in_changes_ = false;
+}
+
+auto TABLE_SNAPSHOT::find(const ROW_REF &key) const -> std::optional<ROW_REF>{
+    auto change_it = changes.find(key);
+    if(change_it != changes.end()){
+        if(!change_it->second.has_value())
+            return std::nullopt;
+        return ROW_LESS::ref(*change_it->second);
+    }
+    auto row_it = rows->find(key);
+    if(row_it == rows->end())
+        return std::nullopt;
+    return ROW_LESS::ref(row_it->second);
+}
+
+void TABLE_SNAPSHOT::put(const BYTES &key, const BYTES &value){
+    if(!find(ROW_LESS::ref(key)).has_value())
+        size++;
+    changes.insert_or_assign(key, value);
+}
+
+void TABLE_SNAPSHOT::erase(const BYTES &key){
+    if(!find(ROW_LESS::ref(key)).has_value())
+        return;
+    size--;
+    changes.insert_or_assign(key, std::nullopt);
+}
+
+void TABLE_SNAPSHOT::fold(){
+    if(changes.empty())
+        return;
+    // rows that no other version uses are changed in place, shared rows are only copied when the
+    // changes cost as much to copy with every version
+    if(rows.use_count() > 1){
+        if(changes.size() * changes.size() <= rows->size())
+            return;
+        rows = std::make_shared<SNAPSHOT_ROWS>(*rows);
+    }
+    for(auto &change : changes){
+        if(change.second.has_value())
+            rows->insert_or_assign(change.first, *change.second);
+        else
+            rows->erase(change.first);
+    }
+    changes.clear();
+}
+
+auto TABLE_SNAPSHOT::index(unsigned int number,
+                           const std::function<ORDERED_INDEX(const TABLE_SNAPSHOT &)> &build) const
+    -> std::shared_ptr<const ORDERED_INDEX>{
+    // transactions that need the index at the same time wait for the first one to build it
+    std::lock_guard<std::mutex> lock(indexes->mutex);
+    auto &index = indexes->indexes[number];
+    if(index == nullptr)
+        index = std::make_shared<const ORDERED_INDEX>(build(*this));
+    return index;
+}
+
+auto TABLE_SNAPSHOT::begin() const -> const_iterator{
+    return const_iterator(this, rows->begin(), changes.begin());
+}
+
+auto TABLE_SNAPSHOT::end() const -> const_iterator{
+    return const_iterator(this, rows->end(), changes.end());
+}
+
+TableCache::const_iterator::const_iterator(const TableCache *cache, BaseIterator base, DeltaIterator delta)
+    : cache_(cache), base_(base), delta_(delta), version_(cache->version_){
+    settle();
+}
+
+auto TableCache::const_iterator::key() const -> ROW_REF{
+    return in_delta_ ? delta_->first : base_.key();
+}
+
+auto TableCache::const_iterator::value() const -> ROW_REF{
+    return in_delta_ ? *delta_->second : base_.value();
+}
+
+auto TableCache::const_iterator::operator++() -> const_iterator &{
+    const ROW_REF current = key();
+    // a row of the transaction replaces the row of the snapshot with the same key
+    if(base_ != cache_->base().end() && !ROW_LESS()(current, base_.key()))
+        ++base_;
+    if(version_ != cache_->version_){
+        // keys were added to the transaction since the iterator moved
+        delta_ = cache_->delta_.upper_bound(current);
+        version_ = cache_->version_;
+    } else if(in_delta_){
+        ++delta_;
+    }
+    settle();
+    return *this;
+}
+
+auto TableCache::const_iterator::operator==(const const_iterator &other) const -> bool{
+    return base_ == other.base_ && delta_ == other.delta_;
+}
+
+auto TableCache::const_iterator::operator!=(const const_iterator &other) const -> bool{
+    return !(*this == other);
+}
+
+void TableCache::const_iterator::settle(){
+    const auto base_end = cache_->base().end();
+    while(delta_ != cache_->delta_.end()){
+        if(base_ != base_end && ROW_LESS()(base_.key(), delta_->first)){
+            in_delta_ = false;
+            return;
+        }
+        if(delta_->second.has_value()){
+            in_delta_ = true;
+            return;
+        }
+        // skip the removed row
+        if(base_ != base_end && !ROW_LESS()(delta_->first, base_.key()))
+            ++base_;
+        ++delta_;
+    }
+    in_delta_ = false;
+}
+
+TableCache::TableCache(std::shared_ptr<const TABLE_SNAPSHOT> snapshot){
+    reset(std::move(snapshot));
+}
+
+auto TableCache::empty_snapshot() -> const TABLE_SNAPSHOT &{
+    static const TABLE_SNAPSHOT snapshot;
+    return snapshot;
+}
+
+auto TableCache::base() const -> const TABLE_SNAPSHOT &{
+    return snapshot_ != nullptr ? *snapshot_ : empty_snapshot();
+}
+
+auto TableCache::index(unsigned int number,
+                       const std::function<ORDERED_INDEX(const TABLE_SNAPSHOT &)> &build) const
+    -> std::shared_ptr<const ORDERED_INDEX>{
+    if(snapshot_ == nullptr)
+        return std::make_shared<const ORDERED_INDEX>(build(empty_snapshot()));
+    return snapshot_->index(number, build);
+}
+
+auto TableCache::changes() const -> const std::map<ROW_REF, std::optional<ROW_REF>, ROW_LESS> &{
+    return delta_;
+}
+
+auto TableCache::find(const BYTES &key) const -> std::optional<ROW_REF>{
+    return find(ROW_LESS::ref(key));
+}
+
+auto TableCache::find(const ROW_REF &key) const -> std::optional<ROW_REF>{
+    auto delta_it = delta_.find(key);
+    if(delta_it != delta_.end())
+        return delta_it->second;
+    return base().find(key);
+}
+
+void TableCache::put(const ROW_REF &key, const ROW_REF &value){
+    if(!find(key).has_value())
+        size_++;
+    auto inserted = delta_.insert_or_assign(key, value);
+    if(inserted.second)
+        version_++;
+}
+
+void TableCache::erase(const ROW_REF &key){
+    if(!find(key).has_value())
+        return;
+    size_--;
+    auto inserted = delta_.insert_or_assign(key, std::nullopt);
+    if(inserted.second)
+        version_++;
+}
+
+void TableCache::reset(std::shared_ptr<const TABLE_SNAPSHOT> snapshot){
+    snapshot_ = std::move(snapshot);
+    delta_.clear();
+    version_++;
+    size_ = base().size;
+}
+
+auto TableCache::size() const -> size_t{
+    return size_;
+}
+
+auto TableCache::begin() const -> const_iterator{
+    return const_iterator(this, base().begin(), delta_.begin());
+}
+
+auto TableCache::end() const -> const_iterator{
+    return const_iterator(this, base().end(), delta_.end());
+}
+
+IndexView::const_iterator::const_iterator(const IndexView *view, ORDERED_INDEX::const_iterator base,
+                                          ORDERED_INDEX::const_iterator added)
+    : view_(view), base_(base), added_(added){
+    skip_removed();
+}
+
+auto IndexView::const_iterator::operator*() const -> const std::string &{
+    return in_base() ? *base_ : *added_;
+}
+
+auto IndexView::const_iterator::operator->() const -> const std::string *{
+    return &**this;
+}
+
+auto IndexView::const_iterator::operator++() -> const_iterator &{
+    if(in_base()){
+        ++base_;
+        skip_removed();
+    } else {
+        ++added_;
+    }
+    return *this;
+}
+
+auto IndexView::const_iterator::operator--() -> const_iterator &{
+    // the previous entry is the larger one of the previous entries of both sets
+    auto base_prev = base_;
+    bool has_base = false;
+    while(base_prev != view_->base_->begin()){
+        --base_prev;
+        if(view_->removed_.count(*base_prev) == 0){
+            has_base = true;
+            break;
+        }
+    }
+    bool has_added = added_ != view_->added_.begin();
+    auto added_prev = has_added ? std::prev(added_) : added_;
+    if(has_base && (!has_added || *added_prev < *base_prev))
+        base_ = base_prev;
+    else
+        added_ = added_prev;
+    return *this;
+}
+
+auto IndexView::const_iterator::operator==(const const_iterator &other) const -> bool{
+    return base_ == other.base_ && added_ == other.added_;
+}
+
+auto IndexView::const_iterator::operator!=(const const_iterator &other) const -> bool{
+    return !(*this == other);
+}
+
+auto IndexView::const_iterator::in_base() const -> bool{
+    // the added entries are never in the shared index
+    return base_ != view_->base_->end() && (added_ == view_->added_.end() || *base_ < *added_);
+}
+
+void IndexView::const_iterator::skip_removed(){
+    while(base_ != view_->base_->end() && view_->removed_.count(*base_) != 0)
+        ++base_;
+}
+
+IndexView::IndexView(std::shared_ptr<const ORDERED_INDEX> base) : base_(std::move(base)){}
+
+void IndexView::insert(const std::string &entry){
+    if(base_->count(entry) != 0)
+        removed_.erase(entry);
+    else
+        added_.insert(entry);
+}
+
+void IndexView::erase(const std::string &entry){
+    if(base_->count(entry) != 0)
+        removed_.insert(entry);
+    else
+        added_.erase(entry);
+}
+
+auto IndexView::empty() const -> bool{
+    return added_.empty() && base_->size() == removed_.size();
+}
+
+auto IndexView::begin() const -> const_iterator{
+    return const_iterator(this, base_->begin(), added_.begin());
+}
+
+auto IndexView::end() const -> const_iterator{
+    return const_iterator(this, base_->end(), added_.end());
+}
+
+auto IndexView::lower_bound(const std::string &entry) const -> const_iterator{
+    return const_iterator(this, base_->lower_bound(entry), added_.lower_bound(entry));
+}
+
+auto IndexView::upper_bound(const std::string &entry) const -> const_iterator{
+    return const_iterator(this, base_->upper_bound(entry), added_.upper_bound(entry));
+}
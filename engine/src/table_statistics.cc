@@ -0,0 +1,127 @@
+#include "storage/blockchainDB/engine/include/table_statistics.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "storage/blockchainDB/adapter/utils/include/adapter_utils/encoding_helpers.h"
+#include "storage/blockchainDB/adapter/utils/src/json.hpp"
+
+using namespace blockchain_db;
+
+/**
+ * @brief Converts the statistics of a table to JSON, the histogram entries are
+ * binary sort keys and are stored as hex
+ */
+static auto to_json(const TABLE_STATISTICS &statistics) -> nlohmann::json{
+    nlohmann::json indexes = nlohmann::json::object();
+    for(const auto &index : statistics.indexes){
+        nlohmann::json histogram = nlohmann::json::array();
+        for(const auto &entry : index.second.histogram)
+            histogram.push_back(byte_array_to_hex(
+                reinterpret_cast<const unsigned char *>(entry.data()), entry.size()));
+        indexes[std::to_string(index.first)] = {
+            {"rec_per_key", index.second.rec_per_key}, {"histogram", histogram}};
+    }
+    return {{"records", statistics.records},
+            {"data_length", statistics.data_length},
+            {"indexes", indexes}};
+}
+
+static auto from_json(const nlohmann::json &json) -> TABLE_STATISTICS{
+    TABLE_STATISTICS statistics;
+    statistics.records = json.at("records");
+    statistics.data_length = json.at("data_length");
+    for(const auto &index : json.at("indexes").items()){
+        INDEX_STATISTICS &index_statistics =
+            statistics.indexes[std::stoul(index.key())];
+        index_statistics.rec_per_key =
+            index.value().at("rec_per_key").get<std::vector<double>>();
+        for(const auto &entry : index.value().at("histogram")){
+            const std::string hex = entry;
+            std::string bytes(hex.size() / 2, '\0');
+            hex_to_byte_array(hex, reinterpret_cast<unsigned char *>(&bytes[0]));
+            index_statistics.histogram.push_back(std::move(bytes));
+        }
+    }
+    return statistics;
+}
+
+auto StatisticsCache::instance() -> StatisticsCache &{
+    static StatisticsCache cache;
+    return cache;
+}
+
+auto StatisticsCache::open(const std::string &path) -> bool{
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    std::ifstream file(path_);
+    if(!file.is_open())
+        return true;
+    std::stringstream content;
+    content << file.rdbuf();
+    auto json = nlohmann::json::parse(content.str(), nullptr, false);
+    if(!json.is_object())
+        return false;
+    bool ok = true;
+    for(const auto &table : json.items()){
+        try{
+            statistics_[table.key()] =
+                std::make_shared<const TABLE_STATISTICS>(from_json(table.value()));
+        } catch(std::exception &){
+            // the table is analyzed again
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+auto StatisticsCache::get(const std::string &tablename)
+    -> std::shared_ptr<const TABLE_STATISTICS>{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = statistics_.find(tablename);
+    if(it == statistics_.end())
+        return nullptr;
+    return it->second;
+}
+
+void StatisticsCache::put(const std::string &tablename,
+                          std::shared_ptr<const TABLE_STATISTICS> statistics){
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics_[tablename] = std::move(statistics);
+    save();
+}
+
+void StatisticsCache::invalidate(const std::string &tablename){
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(statistics_.erase(tablename) > 0)
+        save();
+}
+
+auto StatisticsCache::save() -> bool{
+    if(path_.empty())
+        return true;
+    nlohmann::json json = nlohmann::json::object();
+    for(const auto &statistics : statistics_)
+        json[statistics.first] = to_json(*statistics.second);
+    const std::string content = json.dump();
+
+    // the new file replaces the old one only when it is complete
+    std::string tmp_path = path_ + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if(fd < 0)
+        return false;
+    size_t written = 0;
+    while(written < content.size()){
+        ssize_t rc = ::write(fd, content.data() + written, content.size() - written);
+        if(rc < 0)
+            break;
+        written += rc;
+    }
+    bool ok = written == content.size() && fdatasync(fd) == 0;
+    ::close(fd);
+    return ok && std::rename(tmp_path.c_str(), path_.c_str()) == 0;
+}
@@ -2,24 +2,188 @@
 
 using namespace blockchain_db;
 
+auto RowArena::copy(const unsigned char *data, size_t size) -> ROW_REF{
+    if(size > free_size_){
+        if(size > kBlockSize / 4){
+            // large rows get a block of their own, the free bytes of the last block are kept
+            blocks_.emplace_back(new unsigned char[size]);
+            memcpy(blocks_.back().get(), data, size);
+            return ROW_REF{blocks_.back().get(), size};
+        }
+        blocks_.emplace_back(new unsigned char[kBlockSize]);
+        free_ = blocks_.back().get();
+        free_size_ = kBlockSize;
+    }
+    unsigned char *copy = free_;
+    if(size > 0)
+        memcpy(copy, data, size);
+    free_ += size;
+    free_size_ -= size;
+    return ROW_REF{copy, size};
+}
+
 auto Transaction::init() -> int{
     return 0;
 }
-auto Transaction::addTable(const std::string &tablename, std::map<BYTES, BYTES> &table_map) -> int{
-    auto [it, result] = table_cache.emplace(tablename, std::move(table_map));
+auto Transaction::addTable(const std::string &tablename, std::shared_ptr<const TABLE_SNAPSHOT> snapshot) -> int{
+    auto [it, result] = table_cache.emplace(tablename, TableCache(std::move(snapshot)));
     return result ? 0 : 1;
 }
 auto Transaction::addWrite(const std::string &tablename, BYTES &key, BYTES &value) -> int{
-    if(tablename.empty() || key.size==0)
+    if(tablename.empty())
         return 1;
-    STATEMENT statement = {STATEMENT_TYPE::WRITE, tablename, key, value};
-    statements.push_back(statement);
-    return 0;
+    return addWrite(tableHandle(tablename), key, value);
 }
 auto Transaction::addRemove(const std::string &tablename,const BYTES &key) -> int{
-    if(tablename.empty() || key.size==0)
+    if(tablename.empty())
+        return 1;
+    return addRemove(tableHandle(tablename), key);
+}
+auto Transaction::addInsert(const std::string &tablename, BYTES &key, BYTES &value) -> int{
+    if(tablename.empty())
+        return 1;
+    return addInsert(tableHandle(tablename), key, value);
+}
+auto Transaction::addWrite(const TABLE_HANDLE &table, const BYTES &key, const BYTES &value) -> int{
+    if(key.size==0)
+        return 1;
+    addStatement(STATEMENT_TYPE::WRITE, table.id, table.cache, key, &value);
+    return 0;
+}
+auto Transaction::addRemove(const TABLE_HANDLE &table, const BYTES &key) -> int{
+    if(key.size==0)
+        return 1;
+    addStatement(STATEMENT_TYPE::REMOVE, table.id, table.cache, key, nullptr);
+    return 0;
+}
+auto Transaction::addInsert(const TABLE_HANDLE &table, const BYTES &key, const BYTES &value) -> int{
+    if(key.size==0)
+        return 1;
+    addStatement(STATEMENT_TYPE::INSERT, table.id, table.cache, key, &value);
+    return 0;
+}
+auto Transaction::tableHandle(const std::string &tablename) -> TABLE_HANDLE{
+    TABLE_HANDLE handle;
+    handle.id = tableId(tablename);
+    auto cache_it = table_cache.find(tablename);
+    if(cache_it != table_cache.end())
+        handle.cache = &cache_it->second;
+    auto partial_it = partial_tables.find(tablename);
+    if(partial_it != partial_tables.end())
+        handle.partial = &partial_it->second;
+    handle.completed = completed_tables;
+    return handle;
+}
+auto Transaction::partialTable(TABLE_HANDLE &table) -> PARTIAL_TABLE *{
+    if(table.completed != completed_tables){
+        auto partial_it = partial_tables.find(table_names[table.id]);
+        table.partial = partial_it != partial_tables.end() ? &partial_it->second : nullptr;
+        table.completed = completed_tables;
+    }
+    return table.partial;
+}
+auto Transaction::tableId(const std::string &tablename) -> uint32_t{
+    auto [it, added] = table_ids.emplace(tablename, table_names.size());
+    if(added){
+        table_names.push_back(tablename);
+        statement_index.emplace_back();
+    }
+    return it->second;
+}
+auto Transaction::findTableId(const std::string &tablename, uint32_t &id) const -> bool{
+    auto it = table_ids.find(tablename);
+    if(it == table_ids.end())
+        return false;
+    id = it->second;
+    return true;
+}
+auto Transaction::tableName(uint32_t id) const -> const std::string &{
+    return table_names[id];
+}
+void Transaction::addStatement(STATEMENT_TYPE type, uint32_t table, TableCache *cache, const BYTES &key,
+                               const BYTES *value){
+    ROW_REF value_ref = value != nullptr ? arena.copy(value->value, value->size) : ROW_REF{nullptr, 0};
+    auto &index = statement_index[table];
+    auto it = index.find(ROW_REF{key.value, key.size});
+    ROW_REF key_ref;
+    if(it == index.end()){
+        key_ref = arena.copy(key.value, key.size);
+        index.emplace(key_ref, statements.size());
+        statements.push_back({type, table, key_ref, value_ref});
+    } else {
+        // the key already has a statement, which is replaced by the final state
+        STATEMENT &existing = statements[it->second];
+        key_ref = existing.key;
+        if(type == STATEMENT_TYPE::REMOVE && existing.type == STATEMENT_TYPE::INSERT){
+            // the row never existed for other writers, removing the key could delete a row of one of them
+            dropStatement(it->second);
+            index.erase(it);
+        } else {
+            if(type == STATEMENT_TYPE::WRITE && existing.type == STATEMENT_TYPE::INSERT){
+                // an inserted row that is updated is still inserted
+                type = STATEMENT_TYPE::INSERT;
+            } else if(type == STATEMENT_TYPE::INSERT && existing.type == STATEMENT_TYPE::REMOVE){
+                // the key is removed first, so the insert can not find it on the blockchain
+                type = STATEMENT_TYPE::WRITE;
+            }
+            existing.type = type;
+            existing.value = value_ref;
+        }
+    }
+    // the table cache references the bytes of the statement instead of copying them
+    if(cache != nullptr){
+        if(value != nullptr)
+            cache->put(key_ref, value_ref);
+        else
+            cache->erase(key_ref);
+    }
+}
+void Transaction::dropStatement(size_t position){
+    if(position + 1 != statements.size()){
+        // the last statement takes the place of the dropped one
+        STATEMENT &last = statements.back();
+        statement_index[last.table][last.key] = position;
+        statements[position] = last;
+    }
+    statements.pop_back();
+}
+auto Transaction::addReadRow(const std::string &tablename, const BYTES &key, const BYTES &value) -> int{
+    auto cache_it = table_cache.find(tablename);
+    if(cache_it == table_cache.end())
+        return 1;
+    cache_it->second.put(arena.copy(key.value, key.size), arena.copy(value.value, value.size));
+    return 0;
+}
+void Transaction::addReadRow(const TABLE_HANDLE &table, const BYTES &key, const BYTES &value){
+    table.cache->put(arena.copy(key.value, key.size), arena.copy(value.value, value.size));
+}
+auto Transaction::addPartialTable(const std::string &tablename) -> int{
+    auto [it, result] = table_cache.emplace(tablename, TableCache());
+    if(!result)
+        return 1;
+    partial_tables.emplace(tablename, PARTIAL_TABLE());
+    return 0;
+}
+auto Transaction::completeTable(const std::string &tablename, std::shared_ptr<const TABLE_SNAPSHOT> snapshot) -> int{
+    auto it = partial_tables.find(tablename);
+    if(it == partial_tables.end())
         return 1;
-    STATEMENT statement = {STATEMENT_TYPE::REMOVE, tablename, key, BYTES(nullptr,0)};
-    statements.push_back(statement);
+    TableCache &cache = table_cache[tablename];
+    cache.reset(std::move(snapshot));
+    // replay the statements of this table on top of the complete table
+    uint32_t table;
+    if(findTableId(tablename, table)){
+        for(const auto &statement : statements){
+            if(statement.table != table)
+                continue;
+            if(statement.type == STATEMENT_TYPE::REMOVE)
+                cache.erase(statement.key);
+            else
+                cache.put(statement.key, statement.value);
+        }
+    }
+    partial_tables.erase(it);
+    // the handles of the table resolve its state again
+    completed_tables++;
     return 0;
 }
@@ -0,0 +1,102 @@
+/* See http://code.google.com/p/googletest/wiki/Primer */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include "fake_adapter.h"
+#include "storage/blockchainDB/engine/include/adapter_registry.h"
+
+using namespace blockchain_db;
+
+// Test-Fixture for sharing the adapters of the tables
+
+class Adapter_Registry_Test : public testing::Test {
+ protected:
+  void TearDown() override { registry.clear(); }
+
+  // Counts the created adapters
+  auto factory() -> AdapterRegistry::Factory {
+    return [this]() -> std::shared_ptr<BcAdapter> {
+      created++;
+      return std::make_shared<FakeAdapter>();
+    };
+  }
+
+  AdapterRegistry registry;
+  std::atomic<int> created{0};
+  std::string tablename = "./db/t1";
+  std::string connection_string = "connection";
+};
+
+TEST_F(Adapter_Registry_Test, ConcurrentAcquireCreatesOneAdapter) {
+  // the factory is slow, so the other threads find the table while it runs
+  AdapterRegistry::Factory slow_factory = [this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return factory()();
+  };
+  std::vector<std::future<std::shared_ptr<BcAdapter>>> results;
+  for (int i = 0; i < 8; i++) {
+    results.push_back(std::async(std::launch::async, [&] {
+      return registry.acquire(tablename, connection_string, slow_factory);
+    }));
+  }
+  std::vector<std::shared_ptr<BcAdapter>> adapters;
+  for (auto &result : results) adapters.push_back(result.get());
+
+  EXPECT_EQ(created, 1);
+  for (const auto &adapter : adapters) {
+    ASSERT_NE(adapter, nullptr);
+    EXPECT_EQ(adapter, adapters[0]);
+  }
+  EXPECT_EQ(registry.find(tablename), adapters[0]);
+}
+
+TEST_F(Adapter_Registry_Test, LastReleaseRemovesTheAdapter) {
+  std::shared_ptr<BcAdapter> adapter =
+      registry.acquire(tablename, connection_string, factory());
+  ASSERT_NE(adapter, nullptr);
+  EXPECT_EQ(registry.acquire(tablename, connection_string, factory()), adapter);
+
+  registry.release(tablename, adapter);
+  EXPECT_EQ(registry.find(tablename), adapter);
+  registry.release(tablename, adapter);
+  EXPECT_EQ(registry.find(tablename), nullptr);
+  // the holder keeps the adapter until it lets go of it
+  EXPECT_EQ(adapter.use_count(), 1);
+
+  // the next open creates a new adapter
+  EXPECT_NE(registry.acquire(tablename, connection_string, factory()), nullptr);
+  EXPECT_EQ(created, 2);
+}
+
+TEST_F(Adapter_Registry_Test, OtherConnectionStringReplacesTheAdapter) {
+  std::shared_ptr<BcAdapter> old_adapter =
+      registry.acquire(tablename, connection_string, factory());
+  std::shared_ptr<BcAdapter> new_adapter =
+      registry.acquire(tablename, "other connection", factory());
+  ASSERT_NE(new_adapter, nullptr);
+  EXPECT_NE(new_adapter, old_adapter);
+
+  // releasing the old adapter does not count against the new one
+  registry.release(tablename, old_adapter);
+  EXPECT_EQ(registry.find(tablename), new_adapter);
+  registry.release(tablename, new_adapter);
+  EXPECT_EQ(registry.find(tablename), nullptr);
+}
+
+TEST_F(Adapter_Registry_Test, FailedFactoryIsRetried) {
+  AdapterRegistry::Factory failing_factory = [] {
+    return std::shared_ptr<BcAdapter>();
+  };
+  EXPECT_EQ(registry.acquire(tablename, connection_string, failing_factory),
+            nullptr);
+  EXPECT_EQ(registry.find(tablename), nullptr);
+  EXPECT_NE(registry.acquire(tablename, connection_string, factory()), nullptr);
+  EXPECT_EQ(created, 1);
+}
@@ -0,0 +1,201 @@
+/* See http://code.google.com/p/googletest/wiki/Primer */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "storage/blockchainDB/adapter/utils/include/adapter_utils/encoding_helpers.h"
+#include "storage/blockchainDB/adapter/utils/src/json.hpp"
+#include "storage/blockchainDB/engine/include/commit_journal.h"
+
+using namespace blockchain_db;
+
+// Test-Fixture for replaying and compacting the commit journal. Opening a
+// journal rewrites it with the unfinished entries, so the entries are checked
+// by reading the file after it was opened.
+
+class Commit_Journal_Test : public testing::Test {
+ protected:
+  void SetUp() override {
+    path = testing::TempDir() + "commit_journal_test.log";
+    std::remove(path.c_str());
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  // Writes records to the journal file
+  void write(const std::vector<std::string> &records) {
+    std::ofstream file(path);
+    for (const auto &record : records) file << record << "\n";
+  }
+
+  // Reads the records of the journal file
+  auto records() -> std::vector<nlohmann::json> {
+    std::vector<nlohmann::json> result;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) result.push_back(nlohmann::json::parse(line));
+    return result;
+  }
+
+  // Opens the journal again, which compacts it, and reads its records
+  auto reopen() -> std::vector<nlohmann::json> {
+    CommitJournal journal;
+    EXPECT_TRUE(journal.open(path));
+    journal.close();
+    return records();
+  }
+
+  // Gets the hex encoded keys of a begin record
+  static auto keys(const nlohmann::json &record) -> std::vector<std::string> {
+    std::vector<std::string> result;
+    for (const auto &change : record["changes"]) result.push_back(change[1]);
+    return result;
+  }
+
+  static auto hex(const BYTES &bytes) -> std::string {
+    return byte_array_to_hex(bytes.value, bytes.size);
+  }
+
+  static auto begin(uint64_t id, const std::string &key) -> std::string {
+    return R"({"op":"begin","id":)" + std::to_string(id) +
+           R"(,"table":"t1","changes":[["w",")" + key + R"(","00"]]})";
+  }
+
+  std::string path;
+  std::string tablename = "t1";
+  BYTES key1 = BYTES(std::string("key1"));
+  BYTES key2 = BYTES(std::string("key2"));
+  BYTES value1 = BYTES(std::string("value1"));
+};
+
+TEST_F(Commit_Journal_Test, ReplayKeepsUnfinishedEntries) {
+  write({begin(1, "01"), begin(2, "02"), R"({"op":"done","id":2})",
+         begin(3, "03"), R"({"op":"abort","id":3})", begin(4, "04"),
+         R"({"op":"sent","id":4,"transactions":[["0xa",7]]})",
+         R"({"op":"confirm","transaction":"0xa","ok":true})", begin(5, "05"),
+         R"({"op":"sent","id":5,"transactions":[["0xb",8]]})",
+         // a record that was not written completely ends the journal
+         R"({"op":"done","id)", R"({"op":"done","id":1})"});
+
+  std::vector<nlohmann::json> result = reopen();
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_EQ(result[0]["op"], "begin");
+  EXPECT_EQ(result[0]["id"], 1);
+  EXPECT_EQ(keys(result[0]), std::vector<std::string>{"01"});
+  // the entry waits for its transaction
+  EXPECT_EQ(result[1]["id"], 5);
+  EXPECT_EQ(result[2]["op"], "sent");
+  EXPECT_EQ(result[2]["transactions"][0][0], "0xb");
+  EXPECT_FALSE(result[2].contains("failed"));
+}
+
+TEST_F(Commit_Journal_Test, FailedTransactionIsKeptAcrossCompaction) {
+  write({begin(1, "01"), R"({"op":"sent","id":1,"transactions":[["0xa",7]]})",
+         R"({"op":"confirm","transaction":"0xa","ok":false})"});
+
+  // only a recovery finishes the entry, also after the journal was compacted
+  for (int i = 0; i < 2; i++) {
+    std::vector<nlohmann::json> result = reopen();
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0]["id"], 1);
+    EXPECT_EQ(result[1]["op"], "sent");
+    EXPECT_TRUE(result[1].value("failed", false));
+  }
+}
+
+TEST_F(Commit_Journal_Test, CompactionDropsFinishedEntries) {
+  Transaction txn;
+  EXPECT_EQ(txn.addWrite(tablename, key1, value1), 0);
+  Transaction other_txn;
+  EXPECT_EQ(other_txn.addWrite("t2", key2, value1), 0);
+  {
+    CommitJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    uint64_t first = journal.begin(tablename, txn);
+    uint64_t second = journal.begin("t2", other_txn);
+    EXPECT_NE(first, 0);
+    EXPECT_NE(second, first);
+    journal.sent(second, {{"0xa", 1}});
+    journal.finish(first);
+    EXPECT_TRUE(journal.sync());
+    EXPECT_EQ(records().size(), 4);
+  }
+
+  std::vector<nlohmann::json> result = reopen();
+  ASSERT_EQ(result.size(), 2);
+  EXPECT_EQ(result[0]["table"], "t2");
+  EXPECT_EQ(keys(result[0]), std::vector<std::string>{hex(key2)});
+  EXPECT_EQ(result[1]["op"], "sent");
+
+  // the entry is finished once its transaction is confirmed
+  {
+    CommitJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    journal.transaction_finished("0xa", true);
+  }
+  EXPECT_TRUE(reopen().empty());
+}
+
+TEST_F(Commit_Journal_Test, LaterEntryShadowsKeys) {
+  Transaction first_txn;
+  EXPECT_EQ(first_txn.addWrite(tablename, key1, value1), 0);
+  EXPECT_EQ(first_txn.addWrite(tablename, key2, value1), 0);
+  Transaction second_txn;
+  EXPECT_EQ(second_txn.addRemove(tablename, key1), 0);
+  Transaction other_table_txn;
+  EXPECT_EQ(other_table_txn.addWrite("t2", key2, value1), 0);
+  {
+    CommitJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    journal.begin(tablename, first_txn);
+    journal.begin(tablename, second_txn);
+    // the same key of another table is not shadowed
+    journal.begin("t2", other_table_txn);
+  }
+
+  std::vector<nlohmann::json> result = reopen();
+  ASSERT_EQ(result.size(), 3);
+  // the later commit decides the state of key1
+  EXPECT_EQ(keys(result[0]), std::vector<std::string>{hex(key2)});
+  EXPECT_EQ(keys(result[1]), std::vector<std::string>{hex(key1)});
+  EXPECT_EQ(result[1]["changes"][0][0], "r");
+  EXPECT_EQ(result[2]["table"], "t2");
+
+  // an entry without keys is dropped
+  Transaction third_txn;
+  EXPECT_EQ(third_txn.addWrite(tablename, key2, value1), 0);
+  {
+    CommitJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    journal.begin(tablename, third_txn);
+  }
+  result = reopen();
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_EQ(keys(result[0]), std::vector<std::string>{hex(key1)});
+  EXPECT_EQ(result[1]["table"], "t2");
+  EXPECT_EQ(keys(result[2]), std::vector<std::string>{hex(key2)});
+}
+
+TEST_F(Commit_Journal_Test, DiscardDropsBufferedRecords) {
+  Transaction txn;
+  EXPECT_EQ(txn.addWrite(tablename, key1, value1), 0);
+  Transaction other_txn;
+  EXPECT_EQ(other_txn.addWrite("t2", key2, value1), 0);
+  {
+    CommitJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    uint64_t id = journal.begin(tablename, txn);
+    journal.begin("t2", other_txn);
+    journal.discard({id});
+  }
+
+  // the records of other commits are kept
+  std::vector<nlohmann::json> result = records();
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0]["table"], "t2");
+}
@@ -0,0 +1,126 @@
+#ifndef BLOCKCHAIN_DB_FAKE_ADAPTER
+#define BLOCKCHAIN_DB_FAKE_ADAPTER
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "adapter_factory/adapter_factory.h"
+
+/**
+ * @brief Adapter without a blockchain for unit tests of the engine. It records
+ * the rows of every put and put_batch call, and fails to write the keys of
+ * failing_keys. The other methods succeed without doing anything.
+ *
+ */
+class FakeAdapter : public BcAdapter {
+ public:
+  auto init(const std::string & /*config_path*/) -> bool override {
+    return true;
+  }
+  auto init(const std::string & /*config_path*/,
+            const std::string & /*connection_string*/) -> bool override {
+    return true;
+  }
+  auto check_connection() -> bool override { return true; }
+  auto shutdown() -> bool override { return true; }
+
+  auto put(std::map<const BYTES, const BYTES> &batch,
+           WRITE_CONTEXT * /*context*/ = nullptr) -> int override {
+    return write(batch);
+  }
+  auto put_batch(std::map<const BYTES, const BYTES> &batch,
+                 WRITE_CONTEXT * /*context*/ = nullptr) -> int override {
+    return write(batch);
+  }
+  auto put_if_absent(std::map<const BYTES, const BYTES> & /*batch*/,
+                     std::vector<BYTES> & /*existing_keys*/) -> int override {
+    return 0;
+  }
+  auto get(const BYTES & /*key*/, BYTES & /*result*/) -> int override {
+    return 1;
+  }
+  auto get_batch(const std::vector<BYTES> & /*keys*/,
+                 std::map<const BYTES, BYTES> & /*results*/) -> int override {
+    return 0;
+  }
+  auto get_all(std::map<const BYTES, BYTES> & /*results*/) -> int override {
+    return 0;
+  }
+  auto remove(const BYTES & /*key*/, WRITE_CONTEXT * /*context*/ = nullptr)
+      -> int override {
+    return 0;
+  }
+  auto remove_batch(const std::vector<BYTES> & /*keys*/,
+                    WRITE_CONTEXT * /*context*/ = nullptr) -> int override {
+    return 0;
+  }
+  auto apply_batch(const std::vector<BATCH_OPERATION> & /*operations*/,
+                   WRITE_CONTEXT * /*context*/ = nullptr) -> int override {
+    return 0;
+  }
+  auto get_block_number(uint64_t &block_number) -> int override {
+    block_number = 0;
+    return 0;
+  }
+  auto get_transaction_status(const std::string & /*transaction_id*/)
+      -> int override {
+    return 0;
+  }
+  void watch_transactions(
+      const std::vector<std::string> &transaction_ids,
+      std::chrono::milliseconds /*timeout*/,
+      const std::function<void(const std::string &, int)> &finished)
+      override {
+    for (const auto &transaction_id : transaction_ids) {
+      finished(transaction_id, 0);
+    }
+  }
+  auto create_table(const std::string & /*name*/,
+                    std::string & /*tableAddress*/) -> int override {
+    return 0;
+  }
+  auto load_table(const std::string & /*name*/,
+                  const std::string & /*tableAddress*/) -> int override {
+    return 0;
+  }
+  auto drop_table() -> int override { return 0; }
+
+  // Gets the rows of the write calls, as key and value strings
+  auto writes() -> std::vector<std::map<std::string, std::string>> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writes_;
+  }
+
+  // keys that are not written
+  std::set<std::string> failing_keys;
+
+ private:
+  static auto str(const BYTES &bytes) -> std::string {
+    return std::string(reinterpret_cast<const char *>(bytes.value),
+                       bytes.size);
+  }
+
+  // Records the rows and removes the written ones from the batch
+  auto write(std::map<const BYTES, const BYTES> &batch) -> int {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, std::string> rows;
+    for (auto row = batch.begin(); row != batch.end();) {
+      rows[str(row->first)] = str(row->second);
+      if (failing_keys.count(str(row->first)) == 0) {
+        row = batch.erase(row);
+      } else {
+        row++;
+      }
+    }
+    writes_.push_back(std::move(rows));
+    return batch.empty() ? 0 : 1;
+  }
+
+  std::mutex mutex_;
+  std::vector<std::map<std::string, std::string>> writes_;
+};
+
+#endif  // BLOCKCHAIN_DB_FAKE_ADAPTER
@@ -0,0 +1,103 @@
+/* See http://code.google.com/p/googletest/wiki/Primer */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <thread>
+
+#include "fake_adapter.h"
+#include "storage/blockchainDB/engine/include/group_commit.h"
+
+using namespace blockchain_db;
+
+// Test-Fixture for merging the writes of concurrent commits
+
+class Group_Commit_Test : public testing::Test {
+ protected:
+  // Writes a row with the group commit from another thread
+  auto put_async(const std::string &key, const std::string &value,
+                 std::chrono::milliseconds window, size_t max_rows = 100)
+      -> std::future<int> {
+    return std::async(std::launch::async, [=] {
+      std::map<const BYTES, const BYTES> batch;
+      batch.emplace(BYTES(key), BYTES(value));
+      return group_commit.put(tablename, &adapter, batch, window, max_rows);
+    });
+  }
+
+  GroupCommit group_commit;
+  FakeAdapter adapter;
+  std::string tablename = "test-table";
+  std::chrono::milliseconds window = std::chrono::milliseconds(500);
+  // time after which the leader has opened the group
+  std::chrono::milliseconds start = std::chrono::milliseconds(50);
+};
+
+TEST_F(Group_Commit_Test, MembersJoinTheGroupOfTheLeader) {
+  std::future<int> leader = put_async("key1", "value1", window);
+  std::this_thread::sleep_for(start);
+  std::future<int> member1 = put_async("key2", "value2", window);
+  std::future<int> member2 = put_async("key3", "value3", window);
+  EXPECT_EQ(leader.get(), 0);
+  EXPECT_EQ(member1.get(), 0);
+  EXPECT_EQ(member2.get(), 0);
+
+  // the leader sends the rows of all members with one call
+  auto writes = adapter.writes();
+  ASSERT_EQ(writes.size(), 1);
+  EXPECT_EQ(writes[0], (std::map<std::string, std::string>{
+                           {"key1", "value1"},
+                           {"key2", "value2"},
+                           {"key3", "value3"}}));
+}
+
+TEST_F(Group_Commit_Test, MaxRowsClosesTheGroup) {
+  auto begin = std::chrono::steady_clock::now();
+  std::future<int> leader =
+      put_async("key1", "value1", std::chrono::seconds(30), 2);
+  std::this_thread::sleep_for(start);
+  std::future<int> member =
+      put_async("key2", "value2", std::chrono::seconds(30), 2);
+  EXPECT_EQ(leader.get(), 0);
+  EXPECT_EQ(member.get(), 0);
+  // the leader does not wait for the end of the window
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(10));
+  EXPECT_EQ(adapter.writes().size(), 1);
+}
+
+TEST_F(Group_Commit_Test, FailureIsReportedToTheMembersOfTheRows) {
+  adapter.failing_keys.insert("key2");
+  std::future<int> leader = put_async("key1", "value1", window);
+  std::this_thread::sleep_for(start);
+  std::future<int> failing_member = put_async("key2", "value2", window);
+  std::future<int> member = put_async("key3", "value3", window);
+  EXPECT_EQ(leader.get(), 0);
+  EXPECT_NE(failing_member.get(), 0);
+  EXPECT_EQ(member.get(), 0);
+  EXPECT_EQ(adapter.writes().size(), 1);
+
+  // a failing leader is reported as well, the next group is not affected
+  adapter.failing_keys = {"key1"};
+  leader = put_async("key1", "value1", window);
+  std::this_thread::sleep_for(start);
+  member = put_async("key2", "value2", window);
+  EXPECT_NE(leader.get(), 0);
+  EXPECT_EQ(member.get(), 0);
+}
+
+TEST_F(Group_Commit_Test, SameKeyIsWrittenByTheNextGroup) {
+  std::future<int> leader = put_async("key1", "value1", window);
+  std::this_thread::sleep_for(start);
+  std::future<int> member = put_async("key1", "value2", window);
+  EXPECT_EQ(leader.get(), 0);
+  EXPECT_EQ(member.get(), 0);
+
+  // the second write of the key is sent after the first one is done
+  auto writes = adapter.writes();
+  ASSERT_EQ(writes.size(), 2);
+  EXPECT_EQ(writes[0], (std::map<std::string, std::string>{{"key1", "value1"}}));
+  EXPECT_EQ(writes[1], (std::map<std::string, std::string>{{"key1", "value2"}}));
+}
@@ -0,0 +1,229 @@
+/* See http://code.google.com/p/googletest/wiki/Primer */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "storage/blockchainDB/engine/include/snapshot_cache.h"
+#include "storage/blockchainDB/engine/include/transaction.h"
+
+using namespace blockchain_db;
+
+// Test-Fixture for merging the statements of a key in a transaction
+
+class Transaction_Test : public testing::Test {
+ protected:
+  // Gets the statement of a key, nullptr if the key has none
+  auto statement(const std::string &tablename, const std::string &key)
+      -> const STATEMENT * {
+    uint32_t table;
+    if (!txn.findTableId(tablename, table)) return nullptr;
+    BYTES key_bytes(key);
+    for (const auto &statement : txn.statements) {
+      if (statement.table == table && statement.key.bytes() == key_bytes) {
+        return &statement;
+      }
+    }
+    return nullptr;
+  }
+
+  auto value(const STATEMENT *statement) -> std::string {
+    return std::string(reinterpret_cast<const char *>(statement->value.value),
+                       statement->value.size);
+  }
+
+  Transaction txn;
+  std::string tablename = "test-table";
+  BYTES key1 = BYTES(std::string("key1"));
+  BYTES key2 = BYTES(std::string("key2"));
+  BYTES value1 = BYTES(std::string("value1"));
+  BYTES value2 = BYTES(std::string("value2"));
+};
+
+TEST_F(Transaction_Test, WriteAfterWrite) {
+  EXPECT_EQ(txn.addWrite(tablename, key1, value1), 0);
+  EXPECT_EQ(txn.addWrite(tablename, key1, value2), 0);
+  ASSERT_EQ(txn.statements.size(), 1);
+  const STATEMENT *result = statement(tablename, "key1");
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->type, STATEMENT_TYPE::WRITE);
+  EXPECT_EQ(value(result), "value2");
+}
+
+TEST_F(Transaction_Test, RemoveAfterWrite) {
+  EXPECT_EQ(txn.addWrite(tablename, key1, value1), 0);
+  EXPECT_EQ(txn.addRemove(tablename, key1), 0);
+  ASSERT_EQ(txn.statements.size(), 1);
+  const STATEMENT *result = statement(tablename, "key1");
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->type, STATEMENT_TYPE::REMOVE);
+}
+
+TEST_F(Transaction_Test, WriteAfterInsert) {
+  EXPECT_EQ(txn.addInsert(tablename, key1, value1), 0);
+  EXPECT_EQ(txn.addWrite(tablename, key1, value2), 0);
+  ASSERT_EQ(txn.statements.size(), 1);
+  const STATEMENT *result = statement(tablename, "key1");
+  ASSERT_NE(result, nullptr);
+  // the key must still not exist when committing
+  EXPECT_EQ(result->type, STATEMENT_TYPE::INSERT);
+  EXPECT_EQ(value(result), "value2");
+}
+
+TEST_F(Transaction_Test, InsertAfterRemove) {
+  EXPECT_EQ(txn.addRemove(tablename, key1), 0);
+  EXPECT_EQ(txn.addInsert(tablename, key1, value1), 0);
+  ASSERT_EQ(txn.statements.size(), 1);
+  const STATEMENT *result = statement(tablename, "key1");
+  ASSERT_NE(result, nullptr);
+  // the removed row is overwritten
+  EXPECT_EQ(result->type, STATEMENT_TYPE::WRITE);
+  EXPECT_EQ(value(result), "value1");
+}
+
+TEST_F(Transaction_Test, RemoveAfterInsert) {
+  EXPECT_EQ(txn.addInsert(tablename, key1, value1), 0);
+  EXPECT_EQ(txn.addRemove(tablename, key1), 0);
+  // nothing is sent for the key, a row of another writer is kept
+  EXPECT_TRUE(txn.statements.empty());
+  EXPECT_EQ(statement(tablename, "key1"), nullptr);
+}
+
+TEST_F(Transaction_Test, RemoveAfterInsertKeepsOtherStatements) {
+  EXPECT_EQ(txn.addInsert(tablename, key1, value1), 0);
+  EXPECT_EQ(txn.addWrite(tablename, key2, value2), 0);
+  EXPECT_EQ(txn.addRemove(tablename, key1), 0);
+  ASSERT_EQ(txn.statements.size(), 1);
+  EXPECT_EQ(statement(tablename, "key1"), nullptr);
+
+  // the moved statement of key2 is still merged with later statements
+  EXPECT_EQ(txn.addWrite(tablename, key2, value1), 0);
+  ASSERT_EQ(txn.statements.size(), 1);
+  const STATEMENT *result = statement(tablename, "key2");
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->type, STATEMENT_TYPE::WRITE);
+  EXPECT_EQ(value(result), "value1");
+
+  // the key can be inserted again
+  EXPECT_EQ(txn.addInsert(tablename, key1, value2), 0);
+  ASSERT_EQ(txn.statements.size(), 2);
+  result = statement(tablename, "key1");
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->type, STATEMENT_TYPE::INSERT);
+}
+
+TEST_F(Transaction_Test, TableCacheSharesStatementBytes) {
+  EXPECT_EQ(txn.addTable(tablename, std::make_shared<TABLE_SNAPSHOT>()), 0);
+  EXPECT_EQ(txn.addWrite(tablename, key1, value1), 0);
+  const TableCache &cache = txn.table_cache.at(tablename);
+  std::optional<ROW_REF> result = cache.find(key1);
+  ASSERT_TRUE(result.has_value());
+  // the cache references the value of the statement instead of a copy
+  EXPECT_EQ(result->value, statement(tablename, "key1")->value.value);
+
+  // the removed row is not in the cache and nothing is sent for the key
+  EXPECT_EQ(txn.addInsert(tablename, key2, value2), 0);
+  EXPECT_TRUE(cache.find(key2).has_value());
+  EXPECT_EQ(txn.addRemove(tablename, key2), 0);
+  EXPECT_FALSE(cache.find(key2).has_value());
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST_F(Transaction_Test, SnapshotVersionsShareRows) {
+  auto snapshot = std::make_shared<TABLE_SNAPSHOT>();
+  for (int i = 0; i < 10; i++) {
+    snapshot->rows->emplace(BYTES("row" + std::to_string(i)), value1);
+  }
+  snapshot->rows->emplace(key1, value1);
+  snapshot->size = snapshot->rows->size();
+  SnapshotCache::instance().put(tablename, snapshot);
+  std::shared_ptr<const TABLE_SNAPSHOT> old_version =
+      SnapshotCache::instance().peek(tablename);
+  snapshot.reset();
+
+  EXPECT_EQ(txn.addTable(tablename, old_version), 0);
+  EXPECT_EQ(txn.addWrite(tablename, key2, value2), 0);
+  EXPECT_EQ(txn.addRemove(tablename, key1), 0);
+  SnapshotCache::instance().apply(tablename, txn);
+
+  // the old version is unchanged and shares its rows with the new one
+  std::shared_ptr<const TABLE_SNAPSHOT> new_version =
+      SnapshotCache::instance().peek(tablename);
+  ASSERT_NE(new_version, old_version);
+  EXPECT_EQ(new_version->rows, old_version->rows);
+  EXPECT_EQ(old_version->size, 11);
+  EXPECT_TRUE(old_version->find(ROW_LESS::ref(key1)).has_value());
+  EXPECT_FALSE(old_version->find(ROW_LESS::ref(key2)).has_value());
+
+  EXPECT_EQ(new_version->size, 11);
+  EXPECT_FALSE(new_version->find(ROW_LESS::ref(key1)).has_value());
+  std::vector<std::string> keys;
+  for (auto row = new_version->begin(); row != new_version->end(); ++row) {
+    keys.emplace_back(reinterpret_cast<const char *>(row.key().value),
+                      row.key().size);
+  }
+  ASSERT_EQ(keys.size(), 11);
+  EXPECT_EQ(std::count(keys.begin(), keys.end(), "key2"), 1);
+  EXPECT_EQ(std::count(keys.begin(), keys.end(), "key1"), 0);
+
+  // without the old version the changes are folded into the rows
+  old_version.reset();
+  new_version.reset();
+  txn.table_cache.clear();
+  SnapshotCache::instance().apply(tablename, txn);
+  new_version = SnapshotCache::instance().peek(tablename);
+  EXPECT_TRUE(new_version->changes.empty());
+  EXPECT_EQ(new_version->rows->size(), 11);
+  EXPECT_EQ(new_version->rows->count(key1), 0);
+  SnapshotCache::instance().invalidate(tablename);
+}
+
+TEST_F(Transaction_Test, IndexViewMergesSharedIndex) {
+  auto shared_index =
+      std::make_shared<const ORDERED_INDEX>(ORDERED_INDEX{"a", "c", "e"});
+  IndexView index(shared_index);
+  index.insert("b");
+  index.erase("c");
+  index.insert("f");
+  // an entry that is removed and added again stays in the shared index
+  index.erase("e");
+  index.insert("e");
+
+  std::vector<std::string> forward(index.begin(), index.end());
+  EXPECT_EQ(forward, (std::vector<std::string>{"a", "b", "e", "f"}));
+  std::vector<std::string> backward;
+  for (auto it = index.end(); it != index.begin();) {
+    backward.push_back(*--it);
+  }
+  EXPECT_EQ(backward, (std::vector<std::string>{"f", "e", "b", "a"}));
+
+  EXPECT_EQ(*index.lower_bound("c"), "e");
+  EXPECT_EQ(*index.upper_bound("b"), "e");
+  EXPECT_EQ(std::distance(index.lower_bound("b"), index.end()), 3);
+  // the shared index is not changed
+  EXPECT_EQ(shared_index->size(), 3);
+  EXPECT_EQ(shared_index->count("c"), 1);
+}
+
+TEST_F(Transaction_Test, TableHandleFollowsCompletedTable) {
+  EXPECT_EQ(txn.addPartialTable(tablename), 0);
+  TABLE_HANDLE handle = txn.tableHandle(tablename);
+  ASSERT_NE(handle.cache, nullptr);
+  ASSERT_NE(txn.partialTable(handle), nullptr);
+  // statements of the handle are added to the table cache like by name
+  EXPECT_EQ(txn.addInsert(handle, key1, value1), 0);
+  EXPECT_EQ(txn.addWrite(tablename, key2, value2), 0);
+  EXPECT_TRUE(handle.cache->find(key1).has_value());
+  ASSERT_EQ(txn.statements.size(), 2);
+  EXPECT_EQ(statement(tablename, "key2")->table, handle.id);
+
+  // the state of the lazily loaded table is gone once the table is complete
+  EXPECT_EQ(txn.completeTable(tablename, std::make_shared<TABLE_SNAPSHOT>()), 0);
+  EXPECT_EQ(txn.partialTable(handle), nullptr);
+  EXPECT_EQ(txn.addRemove(handle, key2), 0);
+  EXPECT_FALSE(handle.cache->find(key2).has_value());
+  EXPECT_EQ(handle.cache->size(), 1);
+}